@@ -1,51 +1,227 @@
+#include <util/atomic.h>
+
 #include "AnalogKeyboard.h"
-#include "EEPROM.h"
 
-void ScreenSaver::draw(volatile int &passedHoles, double mmPerHole)  {}
+FrameView MenuWindow::view;
+
+void ScreenSaver::prepare(long position, long umPerHole)  {
+    view.clear();
+}
 
 ScreenSaver* ScreenSaver::init(volatile bool &isRenderAllowed) {
     isRenderAllowed = false;
     return this;
 }
 
-void MainMenu::draw(volatile int &passedHoles, double mmPerHole)  {
+void MainMenu::prepare(long position, long umPerHole)  {
+    view.clear();
+}
+
+void MainMenu::draw()  {
     // this->u8g->setFont(u8g_font_helvR10);
     // this->u8g->setPrintPos(128/2 - u8g->getStrWidth("Magenta print")/2, 39);
     // this->u8g->print("Magenta print");
     this->u8g->drawBitmapP(128/2-92/2, 64/2-38/2, 12, 38, this->logo);
 }
 
-void CalibrationWindow::draw(volatile int &passedHoles, double mmPerHole)  {
-    int 
-        initNumberLength = 0,
-        numberFontSize = 6;
+void CalibrationWindow::prepare(long position, long umPerHole)  {
+    view.clear();
+    if (this->getMode() == CALIBRATION_MODE_HOMING) {
+        this->prepareHoming(position);
+        return;
+    }
+    if (this->getMode() == CALIBRATION_MODE_TUNING) {
+        this->prepareTuning(position);
+        return;
+    }
+
+    view.addLine(u8g_font_helvR10, 10, 31);
+    view.print(F("Calibration:"));
+
+    view.addLine(u8g_font_helvR10, 0, 50);
+    view.printMillimetres(position);
+    view.print(F(" mm"));
+    view.centerLine(this->u8g);
+}
+
+void CalibrationWindow::prepareHoming(long position) {
+    uint8_t runs;
+    unsigned long time;
+    long deviation, spread;
+
+    //results are written by control ISR
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        this->renderedHomingState = this->homing->state;
+        runs = this->homing->runs;
+        time = this->homing->lastTime;
+        deviation = this->homing->lastDeviation;
+        spread = this->homing->deviationSpread;
+    }
+
+    view.addLine(u8g_font_helvR08, 10, 15);
+    view.print(F("Homing: "));
+    switch (this->renderedHomingState)
+    {
+    case HOMING_FAST:
+        view.print(F("fast approach"));
+        break;
+
+    case HOMING_BACK_OFF:
+        view.print(F("back off"));
+        break;
+
+    case HOMING_SLOW:
+        view.print(F("slow approach"));
+        break;
+
+    case HOMING_DONE:
+        view.print(F("done"));
+        break;
+
+    case HOMING_FAILED:
+        view.print(F("failed"));
+        break;
+
+    default:
+        view.print(F("SELECT - start"));
+        break;
+    }
+
+    view.addLine(u8g_font_helvR10, 0, 36);
+    view.printMillimetres(position);
+    view.print(F(" mm"));
+    view.centerLine(this->u8g);
 
-    if ((passedHoles * mmPerHole) < 0) {
-        initNumberLength = (8 + abs((int)(passedHoles * mmPerHole) / 10)) * numberFontSize;
+    if (runs == 0) {
+        return;
+    }
+
+    view.addLine(u8g_font_helvR08, 10, 50);
+    view.print(F("Time "));
+    view.print((long)(time / 1000));
+    view.print(".");
+    view.print((long)(time % 1000 / 100));
+    view.print(F(" s, zero "));
+    view.printMillimetres(deviation);
+    view.print(F(" mm"));
+
+    if (runs > 1) {
+        view.addLine(u8g_font_helvR08, 10, 62);
+        view.print(F("Repeatability "));
+        view.printMillimetres(spread);
+        view.print(F(" mm"));
+    }
+}
+
+void CalibrationWindow::prepareTuning(long position) {
+    bool isReturning;
+    uint8_t peakLoad;
+
+    //level and slips are written by control ISR
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        this->renderedTuningState = this->tuner->state;
+        this->renderedTuningSpeed = this->tuner->speed;
+        this->renderedTuningAcceleration = this->tuner->acceleration;
+        this->renderedSlips = this->slipMonitor->slips;
+        isReturning = this->tuner->isReturning;
+        peakLoad = this->slipMonitor->peakLoad;
+    }
+
+    //"SELECT - start" is too wide for indented line
+    view.addLine(u8g_font_helvR08, 0, 15);
+    view.print(F("Autotune: "));
+    switch (this->renderedTuningState)
+    {
+    case TUNING_SPEED:
+    case TUNING_ACCELERATION:
+        view.print(isReturning == true ? F("returning") : F("testing"));
+        break;
+
+    case TUNING_DONE:
+        view.print(F("done"));
+        break;
+
+    case TUNING_FAILED:
+        view.print(F("failed"));
+        break;
+
+    default:
+        view.print(F("SELECT - start"));
+        break;
+    }
+    view.centerLine(this->u8g);
+
+    view.addLine(u8g_font_helvR10, 0, 36);
+    view.printMillimetres(position);
+    view.print(F(" mm"));
+    view.centerLine(this->u8g);
+
+    //level under test, or settings in use
+    view.addLine(u8g_font_helvR08, 10, 50);
+    if (this->tuner->isActive() == true) {
+        view.print(F("Test "));
+        view.print((long)this->renderedTuningSpeed);
+        view.print(F(", accel "));
+        view.print((long)this->renderedTuningAcceleration);
     } else {
-        initNumberLength = (7 + abs((int)(passedHoles * mmPerHole) / 10)) * numberFontSize;
+        view.print(F("Speed "));
+        view.print((long)this->tuner->baseSpeed);
+        view.print(F(", accel "));
+        view.print((long)this->tuner->baseAcceleration);
     }
-    
-    this->u8g->setFont(u8g_font_helvR10);
-    this->u8g->setPrintPos(10, 31);
-    this->u8g->print("Calibration:");
 
-    this->u8g->setPrintPos(64 - initNumberLength / 2, 50);
-    this->u8g->print(passedHoles * mmPerHole);
-    this->u8g->print(" mm");
+    view.addLine(u8g_font_helvR08, 10, 62);
+    view.print(F("Slips "));
+    view.print((long)this->renderedSlips);
+    view.print(F(", load "));
+    view.print((long)peakLoad);
+    view.print(F(" %"));
 }
 
-CalibrationWindow* CalibrationWindow::onSelect(bool &direction, volatile int &passedHoles, volatile bool &isStepperRunning, volatile bool &isStepperStopped, int mode)  {
-    int eepromAddress = 0;
-    if (mode == CLICK) {
+uint8_t CalibrationWindow::onSelect(bool &direction, volatile int &passedHoles, volatile bool &isStepperRunning, volatile bool &isStepperStopped, int mode)  {
+    if (mode != CLICK) {
+        return this->id;
+    }
+
+    if (this->getMode() == CALIBRATION_MODE_HOMING) {
+        if (this->homing->isActive() == true) {
+            isStepperStopped = true;
+        } else if (isStepperRunning == false) {
+            //homing is run by control ISR
+            ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+                this->homing->start();
+            }
+        }
+        this->markDirty();
+        return this->id;
+    }
+
+    if (this->getMode() == CALIBRATION_MODE_TUNING) {
+        if (this->tuner->isActive() == true) {
+            isStepperStopped = true;
+        } else if (isStepperRunning == false && this->homing->isActive() == false) {
+            ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+                this->tuner->start();
+            }
+        }
+        this->markDirty();
+        return this->id;
+    }
+
+    //new zero is saved to EEPROM by position journal from loop()
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
         passedHoles = 0;
-        EEPROM.put(eepromAddress, passedHoles);
     }
 
-    return this;
+    return this->id;
 };
 
-CalibrationWindow* CalibrationWindow::onLeft(bool &direction, volatile bool &isStepperRunning, volatile bool &isStepperStopped, bool& isSpeakerTimerSetAllowed, int mode) {
+uint8_t CalibrationWindow::onLeft(bool &direction, volatile bool &isStepperRunning, volatile bool &isStepperStopped, bool& isSpeakerTimerSetAllowed, int mode) {
+    //platform is moved by homing or tuning only
+    if (this->getMode() != CALIBRATION_MODE_MANUAL) {
+        return this->id;
+    }
+
     direction = DOWN;
     //run stepper on click
     if (mode == CLICK) {
@@ -62,9 +238,13 @@ CalibrationWindow* CalibrationWindow::onLeft(bool &direction, volatile bool &isS
         }
     }
 
-    return this;
+    return this->id;
 };
-CalibrationWindow* CalibrationWindow::onRight(bool &direction, volatile bool &isStepperRunning, volatile bool &isStepperStopped, bool& isSpeakerTimerSetAllowed, int mode) {
+uint8_t CalibrationWindow::onRight(bool &direction, volatile bool &isStepperRunning, volatile bool &isStepperStopped, bool& isSpeakerTimerSetAllowed, int mode) {
+    if (this->getMode() != CALIBRATION_MODE_MANUAL) {
+        return this->id;
+    }
+
     direction = UP;
     //run stepper on release
     if (mode == CLICK) {
@@ -81,7 +261,7 @@ CalibrationWindow* CalibrationWindow::onRight(bool &direction, volatile bool &is
         }
     }
 
-    return this;
+    return this->id;
 };
 
 //Semi - auto engine control
@@ -91,53 +271,95 @@ SemiAutomaticModeWindow* SemiAutomaticModeWindow::init(volatile bool &isRenderAl
     } else {
         *this->targetPassedHoles = *this->passedHoles;
     }
+    //semi-auto targets whole holes
+    *this->targetRemainder = 0;
     return this;
 }
 
-void SemiAutomaticModeWindow::draw(volatile int &passedHoles, double mmPerHole)  {   
-    this->u8g->setFont(u8g_font_helvR10);
-    this->u8g->setPrintPos(10, 29);
-    this->u8g->print("Current: ");
-    this->u8g->print(passedHoles * mmPerHole);
-    this->u8g->print(" mm");
-
-    this->u8g->setPrintPos(15, 47);
-    this->u8g->print("Target: ");
-    this->u8g->print(*this->targetPassedHoles * mmPerHole);
-    this->u8g->print(" mm");
+void SemiAutomaticModeWindow::prepare(long position, long umPerHole)  {   
+    long targetRemainder;
+
+    //16 bit target could be read half old, half new otherwise
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        this->renderedTargetPassedHoles = *this->targetPassedHoles;
+        targetRemainder = *this->targetRemainder;
+    }
+
+    view.clear();
+    view.addLine(u8g_font_helvR10, 10, 29);
+    view.print(F("Current: "));
+    view.printMillimetres(position);
+    view.print(F(" mm"));
+
+    view.addLine(u8g_font_helvR10, 15, 47);
+    view.print(F("Target: "));
+    view.printMillimetres(this->renderedTargetPassedHoles * umPerHole + targetRemainder);
+    view.print(F(" mm"));
+}
+
+bool SemiAutomaticModeWindow::onHoldStep(int8_t direction, long step) {
+    int targetPassedHoles;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        targetPassedHoles = *this->targetPassedHoles;
+    }
+
+    long target = stepSnapped(targetPassedHoles * this->umPerHole, step, direction);
+    int holes = roundDivide(target, this->umPerHole);
+
+    //step shorter than hole still moves target
+    if (holes == targetPassedHoles) {
+        holes += direction;
+    }
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        *this->targetPassedHoles = max(holes, 0);
+    }
+    return true;
 }
 
-SemiAutomaticModeWindow* SemiAutomaticModeWindow::onSelect(bool &direction, volatile int &passedHoles, volatile bool &isStepperRunning, volatile bool &isStepperStopped, int mode)  {
+uint8_t SemiAutomaticModeWindow::onSelect(bool &direction, volatile int &passedHoles, volatile bool &isStepperRunning, volatile bool &isStepperStopped, int mode)  {
     if (mode == CLICK) {
         if (isStepperRunning == true) {
             isStepperRunning = false;
         } else {
-            if (*this->targetPassedHoles > *this->passedHoles) {
+            int targetPassedHoles;
+            int passedHoles;
+
+            ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+                targetPassedHoles = *this->targetPassedHoles;
+                passedHoles = *this->passedHoles;
+            }
+
+            if (targetPassedHoles > passedHoles) {
                 direction = UP;
             }
 
-            if (*this->targetPassedHoles < *this->passedHoles) {
+            if (targetPassedHoles < passedHoles) {
                 direction = DOWN;
             }
 
-            if (*this->targetPassedHoles == *this->passedHoles) {
-                return this;
+            if (targetPassedHoles == passedHoles) {
+                return this->id;
             }
 
+            //set last, control ISR starts the move on it
             isStepperRunning = true;
         }        
     }
 
-    return this;
+    return this->id;
 };
 
-SemiAutomaticModeWindow* SemiAutomaticModeWindow::onLeft(bool &direction, volatile bool &isStepperRunning, volatile bool &isStepperStopped, bool& isSpeakerTimerSetAllowed, int mode) {
+uint8_t SemiAutomaticModeWindow::onLeft(bool &direction, volatile bool &isStepperRunning, volatile bool &isStepperStopped, bool& isSpeakerTimerSetAllowed, int mode) {
     //run stepper on click
     if (mode == CLICK) {
-        if (*this->targetPassedHoles - 1 < 0) {
-            *this->targetPassedHoles = 0;
-        } else {
-            *this->targetPassedHoles -= 1;
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+            if (*this->targetPassedHoles - 1 < 0) {
+                *this->targetPassedHoles = 0;
+            } else {
+                *this->targetPassedHoles -= 1;
+            }
         }
     }
 
@@ -146,12 +368,14 @@ SemiAutomaticModeWindow* SemiAutomaticModeWindow::onLeft(bool &direction, volati
 
     }
 
-    return this;
+    return this->id;
 };
-SemiAutomaticModeWindow* SemiAutomaticModeWindow::onRight(bool &direction, volatile bool &isStepperRunning, volatile bool &isStepperStopped, bool& isSpeakerTimerSetAllowed, int mode) {
+uint8_t SemiAutomaticModeWindow::onRight(bool &direction, volatile bool &isStepperRunning, volatile bool &isStepperStopped, bool& isSpeakerTimerSetAllowed, int mode) {
     //run stepper on release
     if (mode == CLICK) {
-        *this->targetPassedHoles += 1;
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+            *this->targetPassedHoles += 1;
+        }
     }
 
     //stop stepper on release
@@ -159,31 +383,22 @@ SemiAutomaticModeWindow* SemiAutomaticModeWindow::onRight(bool &direction, volat
 
     }
 
-    return this;
+    return this->id;
 };
 
 //Manual engine control
-void ManualModeWindow::draw(volatile int &passedHoles, double mmPerHole) {
-    int 
-        initNumberLength = 0,
-        numberFontSize = 6;
-
-    if ((passedHoles * mmPerHole) < 0) {
-        initNumberLength = (8 + abs((int)(passedHoles * mmPerHole) / 10)) * numberFontSize;
-    } else {
-        initNumberLength = (7 + abs((int)(passedHoles * mmPerHole) / 10)) * numberFontSize;
-    }
-    
-    this->u8g->setFont(u8g_font_helvR10);
-    this->u8g->setPrintPos(10, 31);
-    this->u8g->print("Manual mode:");
-
-    this->u8g->setPrintPos(64 - initNumberLength / 2, 50);
-    this->u8g->print(passedHoles * mmPerHole);
-    this->u8g->print(" mm");
+void ManualModeWindow::prepare(long position, long umPerHole) {
+    view.clear();
+    view.addLine(u8g_font_helvR10, 10, 31);
+    view.print(F("Manual mode:"));
+
+    view.addLine(u8g_font_helvR10, 0, 50);
+    view.printMillimetres(position);
+    view.print(F(" mm"));
+    view.centerLine(this->u8g);
 }
 
-ManualModeWindow* ManualModeWindow::onLeft(bool &direction, volatile bool &isStepperRunning, volatile bool &isStepperStopped, bool& isSpeakerTimerSetAllowed, int mode) {
+uint8_t ManualModeWindow::onLeft(bool &direction, volatile bool &isStepperRunning, volatile bool &isStepperStopped, bool& isSpeakerTimerSetAllowed, int mode) {
     direction = DOWN;
     //run stepper on click
     if (mode == CLICK) {
@@ -200,9 +415,9 @@ ManualModeWindow* ManualModeWindow::onLeft(bool &direction, volatile bool &isSte
         }
     }
 
-    return this;
+    return this->id;
 };
-ManualModeWindow* ManualModeWindow::onRight(bool &direction, volatile bool &isStepperRunning, volatile bool &isStepperStopped, bool& isSpeakerTimerSetAllowed, int mode) {
+uint8_t ManualModeWindow::onRight(bool &direction, volatile bool &isStepperRunning, volatile bool &isStepperStopped, bool& isSpeakerTimerSetAllowed, int mode) {
     direction = UP;
     //run stepper on release
     if (mode == CLICK) {
@@ -219,68 +434,548 @@ ManualModeWindow* ManualModeWindow::onRight(bool &direction, volatile bool &isSt
         }
     }
 
-    return this;
+    return this->id;
 };
 
 //Templates
-void TemplateWindow::draw(volatile int &passedHoles, double mmPerHole) {
-    int 
-        initNumberLength = 0,
-        numberFontSize = 6;
+void TemplateWindow::select(uint8_t index) {
+    this->index = index;
+    this->isEditing = false;
+
+    if (this->isAddPage() == false) {
+        this->table->read(index, this->record);
+        this->targetHoles = this->record.height / this->umPerHole;
+        this->targetHoleRemainder = this->record.height % this->umPerHole;
+    }
+    this->markDirty();
+}
 
-    if ((passedHoles * mmPerHole) < 0) {
-        initNumberLength = (8 + abs((int)(passedHoles * mmPerHole) / 10)) * numberFontSize;
+TemplateWindow* TemplateWindow::init(volatile bool &isRenderAllowed) {
+    //last shown template is kept, table could shrink only by formatting
+    if (this->index >= this->getPagesAmount()) {
+        this->index = 0;
+    }
+    this->select(this->index);
+    MenuWindow::init(isRenderAllowed);
+    return this;
+}
+
+void TemplateWindow::prepare(long position, long umPerHole) {
+    uint8_t pagesAmount = this->getPagesAmount();
+
+    view.clear();
+    if (pagesAmount == 0) {
+        view.addLine(u8g_font_helvR10, 0, 39);
+        view.print(F("No templates"));
+        view.centerLine(this->u8g);
+        return;
+    }
+
+    view.addLine(u8g_font_helvR08, 128/2 - 3*5/2, 15);
+    view.print((long)this->index + 1);
+    view.print("/");
+    view.print((long)pagesAmount);
+
+    if (this->isAddPage() == true && this->isEditing == false) {
+        view.addLine(u8g_font_helvR10, 0, 39);
+        view.print(F("New template"));
+        view.centerLine(this->u8g);
+        return;
+    }
+
+    view.addLine(u8g_font_helvR10, 0, 34);
+    view.print(this->record.name);
+    view.print(F(" ("));
+    view.printMillimetres(this->record.height);
+    view.print(F(" mm)"));
+    view.centerLine(this->u8g);
+
+    if (this->getMode() == TEMPLATE_MODE_EDIT) {
+        view.addLine(u8g_font_helvR08, 0, 57);
+        view.print(this->isEditing == true ? F("< height >  SELECT - save") : F("SELECT - edit"));
     } else {
-        initNumberLength = (7 + abs((int)(passedHoles * mmPerHole) / 10)) * numberFontSize;
+        view.addLine(u8g_font_helvR10, 0, 57);
+        view.printMillimetres(position);
+        view.print(F(" mm"));
     }
+    view.centerLine(this->u8g);
+}
 
-    double amountOfHoles = this->targetPosition/mmPerHole;
-    int roundedAmountOfHoles = (int)(amountOfHoles + 0.5 - (amountOfHoles < 0));
+bool TemplateWindow::onHoldStep(int8_t direction, long step) {
+    //templates are paged one by one
+    if (this->isEditing == false) {
+        return false;
+    }
 
-    this->u8g->setFont(u8g_font_helvR08);
-    this->u8g->setPrintPos(128/2 - 3*5/2, 15);
-    this->u8g->print(this->windowNumber);
-    this->u8g->print("/");
-    this->u8g->print(this->amountOfWindowsOnCurrentLevel);
+    this->record.height = constrain(stepSnapped(this->record.height, step, direction), 0, TEMPLATE_MAX_HEIGHT);
+    this->markDirty();
+    return true;
+}
 
-    this->u8g->setFont(u8g_font_helvR10);
-    this->u8g->setPrintPos(128 / 2 - (this->u8g->getStrWidth(this->title) + 10 * numberFontSize + 3) / 2, 34);
-    this->u8g->print(this->title);
-    this->u8g->print(" (");
-    this->u8g->print(roundedAmountOfHoles * mmPerHole);
-    this->u8g->print(" mm)");
+uint8_t TemplateWindow::onBack(volatile bool &isStepperStopped) {
+    //editing is cancelled, saved record is shown again
+    if (this->isEditing == true) {
+        this->select(this->index);
+        return this->id;
+    }
 
-    this->u8g->setPrintPos(64 - initNumberLength / 2, 57);
-    this->u8g->print(*this->passedHoles * mmPerHole);
-    this->u8g->print(" mm");
+    return MenuWindow::onBack(isStepperStopped);
 }
 
-TemplateWindow* TemplateWindow::onSelect(bool &direction, volatile int &passedHoles, volatile bool &isStepperRunning, volatile bool &isStepperStopped, int mode)  {
-    double amountOfHoles = this->targetPosition/this->mmPerHole;
-    int roundedAmountOfHoles = (int)(amountOfHoles + 0.5 - (amountOfHoles < 0));
+uint8_t TemplateWindow::onSelect(bool &direction, volatile int &passedHoles, volatile bool &isStepperRunning, volatile bool &isStepperStopped, int mode)  {
+    if (mode != CLICK || this->getPagesAmount() == 0) {
+        return this->id;
+    }
 
-    if (mode == CLICK) {
+    if (this->getMode() == TEMPLATE_MODE_EDIT) {
+        if (this->isEditing == true) {
+            //stays in editing if previous template is still being saved
+            if (this->table->save(this->index, this->record) == true) {
+                this->isEditing = false;
+            }
+        } else if (this->isAddPage() == true) {
+            int passedHoles;
 
-        if (isStepperRunning == true) {
-            isStepperRunning = false;
+            ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+                passedHoles = *this->passedHoles;
+            }
+            //new template starts from current height
+            strcpy_P(this->record.name, PSTR("Template "));
+            itoa(this->table->amount + 1, this->record.name + 9, 10);
+            this->record.height = constrain(
+                roundDivide(passedHoles * this->umPerHole, HEIGHT_EDIT_STEP) * HEIGHT_EDIT_STEP,
+                0, TEMPLATE_MAX_HEIGHT);
+            this->isEditing = true;
         } else {
-            *this->targetPassedHoles = roundedAmountOfHoles;
+            this->isEditing = true;
+        }
+        this->markDirty();
+        return this->id;
+    }
 
-            if (*this->targetPassedHoles > *this->passedHoles) {
-                direction = UP;
+    if (isStepperRunning == true) {
+        isStepperRunning = false;
+    } else {
+        int passedHoles;
+
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+            *this->targetPassedHoles = this->targetHoles;
+            *this->targetRemainder = this->targetHoleRemainder;
+            passedHoles = *this->passedHoles;
+        }
+
+        if (this->targetHoles > passedHoles) {
+            direction = UP;
+        }
+
+        if (this->targetHoles < passedHoles) {
+            direction = DOWN;
+        }
+
+        //part of hole is made by position controller
+        if (this->targetHoles == passedHoles && this->targetHoleRemainder == 0) {
+            return this->id;
+        }
+
+        //set last, control ISR starts the move on it
+        isStepperRunning = true;
+    }
+    
+    return this->id;
+};
+
+uint8_t TemplateWindow::onLeft(bool &direction, volatile bool &isStepperRunning, volatile bool &isStepperStopped, bool& isSpeakerTimerSetAllowed, int mode) {
+    if (mode != CLICK) {
+        return this->id;
+    }
+
+    if (this->isEditing == true) {
+        this->record.height = max(this->record.height - HEIGHT_EDIT_STEP, 0L);
+        this->markDirty();
+        return this->id;
+    }
+
+    //template can not be changed during the move to it
+    if (isStepperRunning == false && this->getPagesAmount() > 0) {
+        this->select(this->index == 0 ? this->getPagesAmount() - 1 : this->index - 1);
+    }
+
+    return this->id;
+};
+
+uint8_t TemplateWindow::onRight(bool &direction, volatile bool &isStepperRunning, volatile bool &isStepperStopped, bool& isSpeakerTimerSetAllowed, int mode) {
+    if (mode != CLICK) {
+        return this->id;
+    }
+
+    if (this->isEditing == true) {
+        this->record.height = min(this->record.height + HEIGHT_EDIT_STEP, TEMPLATE_MAX_HEIGHT);
+        this->markDirty();
+        return this->id;
+    }
+
+    if (isStepperRunning == false && this->getPagesAmount() > 0) {
+        this->select(this->index + 1 >= this->getPagesAmount() ? 0 : this->index + 1);
+    }
+
+    return this->id;
+};
+
+//Job
+JobWindow* JobWindow::init(volatile bool &isRenderAllowed) {
+    this->editState = JOB_EDIT_NONE;
+    if (this->index >= this->getPagesAmount()) {
+        this->index = 0;
+    }
+    MenuWindow::init(isRenderAllowed);
+    return this;
+}
+
+void JobWindow::printSegment(uint8_t type, long value) {
+    if (type == JOB_MOVE) {
+        view.print(F("Move "));
+        view.printMillimetres(value);
+        view.print(F(" mm"));
+        return;
+    }
+
+    if (type == JOB_REMOVE) {
+        view.print(F("Remove"));
+        return;
+    }
+
+    if (value == 0) {
+        view.print(F("Wait SELECT"));
+        return;
+    }
+
+    view.print(F("Dwell "));
+    view.print(value / 1000);
+    view.print(".");
+    view.print(value % 1000 / 100);
+    view.print(F(" s"));
+}
+
+void JobWindow::prepare(long position, long umPerHole) {
+    JobRecord &record = this->queue->record;
+
+    view.clear();
+    if (this->getMode() == JOB_MODE_RUN) {
+        uint8_t state;
+        uint8_t segmentIndex;
+        unsigned long remainingTicks;
+
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+            state = this->queue->state;
+            segmentIndex = this->queue->segmentIndex;
+            remainingTicks = this->queue->remainingTicks;
+        }
+
+        view.addLine(u8g_font_helvR10, 10, 29);
+        if (state == JOB_IDLE) {
+            view.print((long)record.amount);
+            view.print(F(" segments"));
+            view.addLine(u8g_font_helvR10, 10, 47);
+            view.print(F("SELECT - start"));
+        } else {
+            view.print((long)segmentIndex + 1);
+            view.print("/");
+            view.print((long)record.amount);
+            view.print(F(": "));
+            //remaining time is rounded up, so it never reads as waiting for SELECT
+            if (state == JOB_DWELLING) {
+                this->printSegment(JOB_DWELL, remainingTicks * 1000 / this->queue->ticksPerSecond + 100);
+            } else {
+                this->printSegment(record.segments[segmentIndex].type, record.segments[segmentIndex].value);
             }
+            view.addLine(u8g_font_helvR10, 10, 47);
+            view.print(state == JOB_PAUSED ? F("SELECT - continue") : F("SELECT - stop"));
+        }
 
-            if (*this->targetPassedHoles < *this->passedHoles) {
-                direction = DOWN;
+        view.addLine(u8g_font_helvR10, 10, 63);
+        view.printMillimetres(position);
+        view.print(F(" mm"));
+        return;
+    }
+
+    view.addLine(u8g_font_helvR08, 10, 15);
+    view.print((long)this->index + 1);
+    view.print("/");
+    view.print((long)this->getPagesAmount());
+
+    view.addLine(u8g_font_helvR10, 10, 34);
+    if (this->editState != JOB_EDIT_NONE) {
+        this->printSegment(this->segment.type, this->segment.value);
+    } else if (this->isAddPage() == true) {
+        view.print(F("New segment"));
+    } else {
+        this->printSegment(record.segments[this->index].type, record.segments[this->index].value);
+    }
+
+    view.addLine(u8g_font_helvR08, 10, 57);
+    switch (this->editState)
+    {
+    case JOB_EDIT_TYPE:
+        view.print(F("< type >  SELECT - next"));
+        break;
+
+    case JOB_EDIT_VALUE:
+        view.print(F("< value >  SELECT - save"));
+        break;
+
+    default:
+        view.print(this->isAddPage() == true ? F("SELECT - add") : F("SELECT - edit"));
+        break;
+    }
+}
+
+uint8_t JobWindow::onBack(volatile bool &isStepperStopped) {
+    if (this->editState != JOB_EDIT_NONE) {
+        this->editState = JOB_EDIT_NONE;
+        this->markDirty();
+        return this->id;
+    }
+
+    //stopped move must not be taken as finished segment
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        this->queue->cancel();
+    }
+    return MenuWindow::onBack(isStepperStopped);
+}
+
+bool JobWindow::save() {
+    JobRecord &record = this->queue->record;
+
+    if (this->store->isBusy() == true) {
+        return false;
+    }
+
+    if (this->segment.type == JOB_REMOVE) {
+        for (uint8_t i = this->index; i + 1 < record.amount; i++) {
+            record.segments[i] = record.segments[i + 1];
+        }
+        record.amount -= 1;
+    } else {
+        record.segments[this->index] = this->segment;
+        if (this->index == record.amount) {
+            record.amount += 1;
+        }
+    }
+
+    this->store->save(record);
+    return true;
+}
+
+uint8_t JobWindow::onSelect(bool &direction, volatile int &passedHoles, volatile bool &isStepperRunning, volatile bool &isStepperStopped, int mode)  {
+    if (mode != CLICK) {
+        return this->id;
+    }
+
+    if (this->getMode() == JOB_MODE_RUN) {
+        //queue is run by control ISR
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+            if (this->queue->isRunning() == false) {
+                this->queue->start();
+            } else if (this->queue->state == JOB_PAUSED) {
+                this->queue->resume();
+            } else {
+                this->queue->cancel();
+                isStepperRunning = false;
             }
+        }
+        this->markDirty();
+        return this->id;
+    }
+
+    //job is edited only at rest, segments are read by control ISR while it runs
+    if (this->queue->isRunning() == true) {
+        return this->id;
+    }
 
-            if (*this->targetPassedHoles == *this->passedHoles) {
-                return this;
+    switch (this->editState)
+    {
+    case JOB_EDIT_NONE:
+        if (this->isAddPage() == true) {
+            int passedHoles;
+
+            ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+                passedHoles = *this->passedHoles;
             }
+            this->segment.type = JOB_MOVE;
+            this->segment.value = constrain(
+                roundDivide(passedHoles * this->umPerHole, HEIGHT_EDIT_STEP) * HEIGHT_EDIT_STEP,
+                0, TEMPLATE_MAX_HEIGHT);
+        } else {
+            this->segment = this->queue->record.segments[this->index];
+        }
+        this->editState = JOB_EDIT_TYPE;
+        break;
 
-            isStepperRunning = true;
-        }        
+    case JOB_EDIT_TYPE:
+        if (this->segment.type != JOB_REMOVE) {
+            this->editState = JOB_EDIT_VALUE;
+            break;
+        }
+        //removing needs no value
+        //next segment takes the page of removed one
+        if (this->save() == true) {
+            this->editState = JOB_EDIT_NONE;
+        }
+        break;
+
+    case JOB_EDIT_VALUE:
+        //stays in editing if previous job is still being saved
+        if (this->save() == true) {
+            this->editState = JOB_EDIT_NONE;
+        }
+        break;
     }
-    
-    return this;
+
+    this->markDirty();
+    return this->id;
+};
+
+void JobWindow::changeValue(int direction) {
+    if (this->editState == JOB_EDIT_TYPE) {
+        //new segment can not be removed
+        uint8_t typesAmount = this->isAddPage() == true ? 2 : 3;
+
+        this->segment.type = (this->segment.type + typesAmount + direction) % typesAmount;
+        this->segment.value = 0;
+        return;
+    }
+
+    if (this->segment.type == JOB_MOVE) {
+        this->segment.value = constrain(this->segment.value + direction * HEIGHT_EDIT_STEP, 0, TEMPLATE_MAX_HEIGHT);
+    } else {
+        this->segment.value = constrain(this->segment.value + direction * DWELL_EDIT_STEP, 0, JOB_MAX_DWELL);
+    }
+}
+
+bool JobWindow::onHoldStep(int8_t direction, long step) {
+    //dwell has its own step, pages and types go one by one
+    if (this->editState != JOB_EDIT_VALUE || this->segment.type != JOB_MOVE) {
+        return false;
+    }
+
+    this->segment.value = constrain(stepSnapped(this->segment.value, step, direction), 0, TEMPLATE_MAX_HEIGHT);
+    this->markDirty();
+    return true;
+}
+
+uint8_t JobWindow::onLeft(bool &direction, volatile bool &isStepperRunning, volatile bool &isStepperStopped, bool& isSpeakerTimerSetAllowed, int mode) {
+    if (mode != CLICK || this->getMode() == JOB_MODE_RUN) {
+        return this->id;
+    }
+
+    if (this->editState != JOB_EDIT_NONE) {
+        this->changeValue(-1);
+    } else {
+        this->index = this->index == 0 ? this->getPagesAmount() - 1 : this->index - 1;
+    }
+    this->markDirty();
+
+    return this->id;
+};
+
+uint8_t JobWindow::onRight(bool &direction, volatile bool &isStepperRunning, volatile bool &isStepperStopped, bool& isSpeakerTimerSetAllowed, int mode) {
+    if (mode != CLICK || this->getMode() == JOB_MODE_RUN) {
+        return this->id;
+    }
+
+    if (this->editState != JOB_EDIT_NONE) {
+        this->changeValue(1);
+    } else {
+        this->index = this->index + 1 >= this->getPagesAmount() ? 0 : this->index + 1;
+    }
+    this->markDirty();
+
+    return this->id;
+};
+
+//Diagnostics
+void DiagnosticsWindow::printCounter(u8g_uint_t y, const __FlashStringHelper* name, ProfileCounter counter) {
+    view.addLine(u8g_font_helvR08, 2, y);
+    view.print(name);
+    view.addLine(u8g_font_helvR08, 40, y);
+    view.print((long)counter.getMinimal());
+    view.print("/");
+    view.print((long)counter.getAverage());
+    view.print("/");
+    view.print((long)counter.getMaximal());
+    if (counter.overruns != 0) {
+        view.print(F(" !"));
+        view.print((long)counter.overruns);
+    }
+}
+
+void DiagnosticsWindow::prepare(long position, long umPerHole) {
+    view.clear();
+
+#if PROFILING_ENABLED
+    view.addLine(u8g_font_helvR08, 40, 10);
+    view.print(F("min/avg/max, us"));
+
+    this->printCounter(22, F("tick"), profiler.read(profiler.controlTick));
+    this->printCounter(34, F("loop"), profiler.read(profiler.loopPass));
+    this->printCounter(46, F("draw"), profiler.read(profiler.draw));
+    this->printCounter(58, F("eeprom"), profiler.read(profiler.eepromWrite));
+#else
+    view.addLine(u8g_font_helvR08, 2, 34);
+    view.print(F("Profiling is off"));
+#endif
+}
+
+uint8_t DiagnosticsWindow::onSelect(bool &direction, volatile int &passedHoles, volatile bool &isStepperRunning, volatile bool &isStepperStopped, int mode)  {
+#if PROFILING_ENABLED
+    if (mode == CLICK) {
+        profiler.reset();
+    }
+#endif
+
+    return this->id;
+};
+
+//Axis selection
+void AxisWindow::prepare(long position, long umPerHole) {
+    view.clear();
+    view.addLine(u8g_font_helvR10, 0, 31);
+    view.print(F("Axis:"));
+    view.centerLine(this->u8g);
+
+    view.addLine(u8g_font_helvR10, 0, 50);
+    if (*this->selectedAxis == AXIS_ALL) {
+        view.print(F("< All >"));
+    } else {
+        view.print(F("< "));
+        view.print((long)*this->selectedAxis + 1);
+        view.print(F(" >"));
+    }
+    view.centerLine(this->u8g);
+}
+
+void AxisWindow::change(int8_t step) {
+    //"All" is the page after the last axis
+    uint8_t pagesAmount = AXES_AMOUNT > 1 ? AXES_AMOUNT + 1 : 1;
+    uint8_t page = *this->selectedAxis == AXIS_ALL ? AXES_AMOUNT : *this->selectedAxis;
+
+    page = (page + pagesAmount + step) % pagesAmount;
+    *this->selectedAxis = page == AXES_AMOUNT ? AXIS_ALL : page;
+    this->markDirty();
+}
+
+uint8_t AxisWindow::onLeft(bool &direction, volatile bool &isStepperRunning, volatile bool &isStepperStopped, bool& isSpeakerTimerSetAllowed, int mode) {
+    if (mode == CLICK && isStepperRunning == false) {
+        this->change(-1);
+    }
+
+    return this->id;
+};
+
+uint8_t AxisWindow::onRight(bool &direction, volatile bool &isStepperRunning, volatile bool &isStepperStopped, bool& isSpeakerTimerSetAllowed, int mode) {
+    if (mode == CLICK && isStepperRunning == false) {
+        this->change(1);
+    }
+
+    return this->id;
 };
@@ -1,70 +1,61 @@
+#include <util/atomic.h>
 #include <U8glib.h>
-#include <AccelStepper.h>
+
+#include "FixedPoint.h"
+#include "FrameView.h"
+#include "MenuGraph.h"
+#include "Profiler.h"
+#include "TemplateTable.h"
+#include "JobQueue.h"
+#include "JobStore.h"
+#include "HomingCycle.h"
+#include "MotionTuner.h"
+#include "SlipMonitor.h"
+#include "Axis.h"
 
 //buttons states
 #define CLICK    0
 #define RELEASE  1
 
-//Step motor
-#define STEP 4
-#define DIR  5
-#define EN   6
+//Templates and job editing
+#define HEIGHT_EDIT_STEP 100 //um
+#define DWELL_EDIT_STEP 500 //ms
+
+// job editor states
+#define JOB_EDIT_NONE 0
+#define JOB_EDIT_TYPE 1
+#define JOB_EDIT_VALUE 2
+// segment type which is offered by editor only, removes segment
+#define JOB_REMOVE 2
 
 // digital reader states
 #define UP 1
 #define DOWN 0
 
 //Entities declaration
+/**
+ * @brief Behaviour of one window kind. Structure of menu (titles,
+ * numbers, neighbours) is read from menuGraph in flash by id of the
+ * window which is currently shown, so one object serves all windows
+ * of its kind
+ */
 class MenuWindow {
   public:
-    char* title;
-    int index;
-    int windowNumber;
-    int amountOfWindowsOnCurrentLevel;
+    uint8_t kind;
+    // id of shown window, set by getWindow()
+    uint8_t id = W_MAIN;
     U8GLIB_SH1106_128X64* u8g;
-    MenuWindow* higherLevelMenu;
-    MenuWindow* lowerLevelMenu;
-    MenuWindow* prevMenu;
-    MenuWindow* nextMenu;
-
-    MenuWindow(
-      char* title, 
-      int index,
-      int windowNumber,
-      int amountOfWindowsOnCurrentLevel,
-      U8GLIB_SH1106_128X64* u8g,
-      MenuWindow* higherLevelMenu = nullptr,
-      MenuWindow* lowerLevelMenu = nullptr,
-      MenuWindow* prevMenu = nullptr,
-      MenuWindow* nextMenu = nullptr) {
-        this->title = title;
-        this->index = index;
-        this->windowNumber = windowNumber;
-        this->amountOfWindowsOnCurrentLevel = amountOfWindowsOnCurrentLevel;
-        this->u8g = u8g;
-        this->higherLevelMenu = higherLevelMenu;
-        this->lowerLevelMenu = lowerLevelMenu;
-        this->prevMenu = prevMenu;
-        this->nextMenu = nextMenu;
-    }
-
-    /**
-     * @brief setting up windows to create menu structure
-     * 
-     * @param higherLevelMenu BACK button
-     * @param lowerLevelMenu SELECT button
-     * @param prevMenu LEFT button
-     * @param nextMenu RIGHT button
-     */
-    void setPullOfWindows(
-      MenuWindow* higherLevelMenu = nullptr,
-      MenuWindow* lowerLevelMenu = nullptr,
-      MenuWindow* prevMenu = nullptr,
-      MenuWindow* nextMenu = nullptr) {
-        this->higherLevelMenu = higherLevelMenu;
-        this->lowerLevelMenu = lowerLevelMenu;
-        this->prevMenu = prevMenu;
-        this->nextMenu = nextMenu;
+    // set when content has to be drawn again, see isDirty()
+    bool dirty = true;
+    // position shown by last rendered frame, um
+    long renderedPosition = 0;
+    // content of the frame being rendered, one for all windows as only
+    // one window is shown
+    static FrameView view;
+
+    MenuWindow(uint8_t kind, U8GLIB_SH1106_128X64* u8g) {
+      this->kind = kind;
+      this->u8g = u8g;
     }
 
     /**
@@ -81,411 +72,520 @@ class MenuWindow {
     }
 
     /**
-     * @brief Draws content on display
+     * @brief id of window opened by button
+     *
+     * @param neighbour neighbour from menuGraph, W_NONE if button does not change window
+     * @return uint8_t
+     */
+    virtual uint8_t getNeighbour(uint8_t neighbour) {
+      if (neighbour == W_NONE) {
+        return this->id;
+      }
+
+      return neighbour;
+    }
+
+    void markDirty() {
+      this->dirty = true;
+    }
+
+    /**
+     * @brief checks if anything shown by window changed since last frame
+     *
+     * @param position current position, um
+     * @return true if window needs to be rendered
+     */
+    virtual bool isDirty(long position) {
+      return this->dirty;
+    }
+
+    /**
+     * @brief remembers inputs of frame which was just rendered
+     *
+     * @param position position used for that frame, um
+     */
+    virtual void markRendered(long position) {
+      this->dirty = false;
+      this->renderedPosition = position;
+    }
+
+    /**
+     * @brief adds "number/amount" of window on its menu level to the view
+     */
+    void printWindowNumber() {
+      view.addLine(u8g_font_helvR08, 128/2 - 3*5/2, 15);
+      view.print((long)MENU_NODE_BYTE(this->id, windowNumber));
+      view.print("/");
+      view.print((long)MENU_NODE_BYTE(this->id, amountOfWindowsOnCurrentLevel));
+    }
+
+    /**
+     * @brief fills view with content of the next frame, called once
+     * before the page loop. Shared (volatile) state is read here only
+     *
+     * @param position position of frame, um
+     * @param umPerHole
+     */
+    virtual void prepare(long position, long umPerHole) {
+      const char* title = MENU_NODE_TITLE(this->id);
+
+      view.clear();
+      this->printWindowNumber();
+
+      view.addLine(u8g_font_helvR10, 0, 39);
+      view.print((const __FlashStringHelper*)title);
+      view.centerLine(this->u8g);
+    }
+
+    /**
+     * @brief Draws prepared content on display, called for every page
      * 
      */
-    virtual void draw(volatile int &passedHoles, double mmPerHole) {
-      this->u8g->setFont(u8g_font_helvR08);
-      this->u8g->setPrintPos(128/2 - 3*5/2, 15);
-      this->u8g->print(this->windowNumber);
-      this->u8g->print("/");
-      this->u8g->print(this->amountOfWindowsOnCurrentLevel);
-
-      this->u8g->setFont(u8g_font_helvR10);
-      this->u8g->setPrintPos(128/2 - u8g->getStrWidth(this->title)/2, 39);
-      this->u8g->print(this->title);
+    virtual void draw() {
+      view.draw(this->u8g);
     }
 
-    virtual MenuWindow* onBack(volatile bool &isStepperStopped) {
+    /**
+     * @brief tells if held LEFT/RIGHT are repeated as clicks (see HoldRepeater)
+     */
+    virtual bool isRepeatable() {
+      return false;
+    }
+
+    /**
+     * @brief coarse step of held LEFT/RIGHT
+     *
+     * @param direction -1 LEFT, 1 RIGHT
+     * @param step um, value is snapped to its multiple
+     * @return false if window has no coarse steps, click is repeated then
+     */
+    virtual bool onHoldStep(int8_t direction, long step) {
+      return false;
+    }
+
+    virtual uint8_t onBack(volatile bool &isStepperStopped) {
       isStepperStopped = true;
 
-      if (this->higherLevelMenu != nullptr) {
-        return this->higherLevelMenu;
-      }
-      
-      return this;
+      return this->getNeighbour(MENU_NODE_BYTE(this->id, higherLevelMenu));
     }
 
-    virtual MenuWindow* onSelect(bool &direction, volatile int &passedHoles, volatile bool &isStepperRunning, volatile bool &isStepperStopped, int mode){
+    virtual uint8_t onSelect(bool &direction, volatile int &passedHoles, volatile bool &isStepperRunning, volatile bool &isStepperStopped, int mode){
       if (mode == CLICK) {
-        if (this->lowerLevelMenu != nullptr) {
-          return this->lowerLevelMenu;
-        }
+        return this->getNeighbour(MENU_NODE_BYTE(this->id, lowerLevelMenu));
       }
 
       if (mode == RELEASE) {
 
       }
 
-      return this;
+      return this->id;
     };
-    virtual MenuWindow* onLeft(bool &direction, volatile bool &isStepperRunning, volatile bool &isStepperStopped, bool& isSpeakerTimerSetAllowed, int mode) {
+    virtual uint8_t onLeft(bool &direction, volatile bool &isStepperRunning, volatile bool &isStepperStopped, bool& isSpeakerTimerSetAllowed, int mode) {
       if (mode == CLICK) {
-        if (this->prevMenu != nullptr) {
-          return this->prevMenu;
-        }
+        return this->getNeighbour(MENU_NODE_BYTE(this->id, prevMenu));
       }
 
       if (mode == RELEASE) {
       
       }
 
-      return this;
+      return this->id;
       
     };
-    virtual MenuWindow* onRight(bool &direction, volatile bool &isStepperRunning, volatile bool &isStepperStopped, bool& isSpeakerTimerSetAllowed, int mode) {
+    virtual uint8_t onRight(bool &direction, volatile bool &isStepperRunning, volatile bool &isStepperStopped, bool& isSpeakerTimerSetAllowed, int mode) {
       if (mode == CLICK) {
-        if (this->nextMenu != nullptr) {
-          return this->nextMenu;
-        }
+        return this->getNeighbour(MENU_NODE_BYTE(this->id, nextMenu));
       }
 
       if (mode == RELEASE) {
 
       }
       
-      return this;
+      return this->id;
     };
 };
 
 class MainMenu : public MenuWindow {
   public:
-    unsigned char* logo;
-
-    MainMenu(
-      char* title,
-      int index,
-      int windowNumber,
-      int amountOfWindowsOnCurrentLevel,
-      unsigned char logo [],
-      U8GLIB_SH1106_128X64* u8g,
-      MenuWindow* higherLevelMenu = nullptr,
-      MenuWindow* lowerLevelMenu = nullptr,
-      MenuWindow* prevMenu = nullptr,
-      MenuWindow* nextMenu = nullptr) 
+    const unsigned char* logo;
+
+    MainMenu(const unsigned char logo [], U8GLIB_SH1106_128X64* u8g) 
     : 
-    MenuWindow(
-      title, index, windowNumber, amountOfWindowsOnCurrentLevel,
-      u8g, higherLevelMenu, lowerLevelMenu,
-      prevMenu, nextMenu) {
+    MenuWindow(WINDOW_MAIN, u8g) {
         this->logo = logo;
       }
 
-    void draw(volatile int &passedHoles, double mmPerHole);
+    void prepare(long position, long umPerHole);
+    void draw();
 };
 
 class ScreenSaver : public MenuWindow {
   public:
-    ScreenSaver(
-      char* title,
-      int index,
-      int windowNumber,
-      int amountOfWindowsOnCurrentLevel,
-      U8GLIB_SH1106_128X64* u8g,
-      MenuWindow* higherLevelMenu = nullptr,
-      MenuWindow* lowerLevelMenu = nullptr,
-      MenuWindow* prevMenu = nullptr,
-      MenuWindow* nextMenu = nullptr) 
-    : 
-    MenuWindow(
-      title, index, windowNumber, amountOfWindowsOnCurrentLevel, 
-      u8g, higherLevelMenu, lowerLevelMenu,
-      prevMenu, nextMenu) {}
-    
-    void draw(volatile int&, double);
-    
-    ScreenSaver* ScreenSaver::init(volatile bool&);
-};
+    // window which was covered by screen saver, any button returns to it
+    uint8_t returnId = W_MAIN;
 
-class EngineControllerMenu : public MenuWindow {
-  public:
-    EngineControllerMenu(
-      char* title,
-      int index,
-      int windowNumber,
-      int amountOfWindowsOnCurrentLevel,
-      U8GLIB_SH1106_128X64* u8g,
-      MenuWindow* higherLevelMenu = nullptr,
-      MenuWindow* lowerLevelMenu = nullptr,
-      MenuWindow* prevMenu = nullptr,
-      MenuWindow* nextMenu = nullptr) 
+    ScreenSaver(U8GLIB_SH1106_128X64* u8g) 
     : 
-    MenuWindow(
-      title, index, windowNumber, amountOfWindowsOnCurrentLevel,
-      u8g, higherLevelMenu, lowerLevelMenu,
-      prevMenu, nextMenu) {}
-};
+    MenuWindow(WINDOW_SCREEN_SAVER, u8g) {}
+    
+    uint8_t getNeighbour(uint8_t neighbour) {
+      return this->returnId;
+    }
 
-class TemplatesMenu : public MenuWindow {
-  public:
-    TemplatesMenu(
-      char* title,
-      int index,
-      int windowNumber,
-      int amountOfWindowsOnCurrentLevel,
-      U8GLIB_SH1106_128X64* u8g,
-      MenuWindow* higherLevelMenu = nullptr,
-      MenuWindow* lowerLevelMenu = nullptr,
-      MenuWindow* prevMenu = nullptr,
-      MenuWindow* nextMenu = nullptr) 
-    : 
-    MenuWindow(
-      title, index, windowNumber, amountOfWindowsOnCurrentLevel,
-      u8g, higherLevelMenu, lowerLevelMenu,
-      prevMenu, nextMenu) {}
+    void prepare(long, long);
+    
+    ScreenSaver* init(volatile bool&);
 };
 
+/**
+ * @brief Pages through templates of TemplateTable, one record is kept
+ * in RAM whatever amount of templates is.
+ * Run mode (TEMPLATE_MODE_RUN): LEFT/RIGHT - previous/next template,
+ * SELECT - move to its height or stop.
+ * Edit mode (TEMPLATE_MODE_EDIT): last page adds new template at current
+ * height, SELECT starts editing of height, LEFT/RIGHT change it by
+ * HEIGHT_EDIT_STEP, SELECT saves, BACK cancels
+ */
 class TemplateWindow : public MenuWindow {
   public:
-    double targetPosition;
+    TemplateTable* table;
+    // shown template and its copy from EEPROM
+    uint8_t index = 0;
+    TemplateRecord record;
+    bool isEditing = false;
+
     volatile int* targetPassedHoles;
+    volatile long* targetRemainder;
     volatile int* passedHoles;
-    double mmPerHole;
+    long umPerHole;
+    // record height split into reader holes and um above them, recalculated on load
+    int targetHoles;
+    long targetHoleRemainder;
 
     TemplateWindow(
-      char* title,
-      int index,
-      int windowNumber,
-      int amountOfWindowsOnCurrentLevel,
-      double targetPosition, //mm
+      U8GLIB_SH1106_128X64* u8g,
+      TemplateTable* table,
       volatile int* passedHoles,
       volatile int* targetPassedHoles,
-      U8GLIB_SH1106_128X64* u8g,
-      MenuWindow* higherLevelMenu = nullptr,
-      MenuWindow* lowerLevelMenu = nullptr,
-      MenuWindow* prevMenu = nullptr,
-      MenuWindow* nextMenu = nullptr) 
+      volatile long* targetRemainder) 
     : 
-    MenuWindow(
-      title, index, windowNumber, amountOfWindowsOnCurrentLevel, 
-      u8g, higherLevelMenu, lowerLevelMenu,
-      prevMenu, nextMenu) {
-        this->targetPosition = targetPosition;
+    MenuWindow(WINDOW_TEMPLATE, u8g) {
+        this->table = table;
         this->targetPassedHoles = targetPassedHoles;
+        this->targetRemainder = targetRemainder;
         this->passedHoles = passedHoles;
       }
     
-    void setMMPerHole(double mmPerHole) {
-      this->mmPerHole = mmPerHole;
+    void setUMPerHole(long umPerHole) {
+      this->umPerHole = umPerHole;
     };
 
-    void draw(volatile int &passedHoles, double mmPerHole);
-    TemplateWindow* onSelect(bool &direction, volatile int &passedHoles, volatile bool &isStepperRunning, volatile bool &isStepperStopped, int mode);
-};
+    bool isDirty(long position) {
+      return this->dirty || position != this->renderedPosition;
+    }
 
-class TShirtTemplate : public TemplateWindow {
-  public:
-    TShirtTemplate(
-      char* title,
-      int index,
-      int windowNumber,
-      int amountOfWindowsOnCurrentLevel,
-      double targetPosition, //amount of holes
-      volatile int* passedHoles,
-      volatile int* targetPassedHoles,
-      U8GLIB_SH1106_128X64* u8g,
-      MenuWindow* higherLevelMenu = nullptr,
-      MenuWindow* lowerLevelMenu = nullptr,
-      MenuWindow* prevMenu = nullptr,
-      MenuWindow* nextMenu = nullptr) 
-    : 
-    TemplateWindow(
-      title, index, windowNumber, amountOfWindowsOnCurrentLevel,
-      targetPosition, passedHoles, 
-      targetPassedHoles, u8g, higherLevelMenu, 
-      lowerLevelMenu, prevMenu, nextMenu) {}
-};
+    bool isRepeatable() {
+      return true;
+    }
 
-class SweaterTemplate : public TemplateWindow {
-  public:
-    SweaterTemplate(
-      char* title,
-      int index,
-      int windowNumber,
-      int amountOfWindowsOnCurrentLevel,
-      double targetPosition, //amount of holes
-      volatile int* passedHoles,
-      volatile int* targetPassedHoles,
-      U8GLIB_SH1106_128X64* u8g,
-      MenuWindow* higherLevelMenu = nullptr,
-      MenuWindow* lowerLevelMenu = nullptr,
-      MenuWindow* prevMenu = nullptr,
-      MenuWindow* nextMenu = nullptr) 
-    : 
-    TemplateWindow(
-      title, index, windowNumber, amountOfWindowsOnCurrentLevel,
-      targetPosition, passedHoles, 
-      targetPassedHoles, u8g, higherLevelMenu, 
-      lowerLevelMenu, prevMenu, nextMenu) {}
-};
+    bool onHoldStep(int8_t direction, long step);
 
-class HoodyTemplate : public TemplateWindow {
-  public:
-    HoodyTemplate(
-      char* title,
-      int index,
-      int windowNumber,
-      int amountOfWindowsOnCurrentLevel,
-      double targetPosition, //amount of holes
-      volatile int* passedHoles,
-      volatile int* targetPassedHoles,
-      U8GLIB_SH1106_128X64* u8g,
-      MenuWindow* higherLevelMenu = nullptr,
-      MenuWindow* lowerLevelMenu = nullptr,
-      MenuWindow* prevMenu = nullptr,
-      MenuWindow* nextMenu = nullptr) 
-    : 
-    TemplateWindow(
-      title, index, windowNumber, amountOfWindowsOnCurrentLevel,
-      targetPosition, passedHoles, 
-      targetPassedHoles, u8g, higherLevelMenu, 
-      lowerLevelMenu, prevMenu, nextMenu) {}
+    /**
+     * @brief shows template, editor's "add" page if index equals amount of templates
+     *
+     * @param index template index
+     */
+    void select(uint8_t index);
+
+    TemplateWindow* init(volatile bool &isRenderAllowed);
+    void prepare(long position, long umPerHole);
+    uint8_t onBack(volatile bool &isStepperStopped);
+    uint8_t onSelect(bool &direction, volatile int &passedHoles, volatile bool &isStepperRunning, volatile bool &isStepperStopped, int mode);
+    uint8_t onLeft(bool &direction, volatile bool &isStepperRunning, volatile bool &isStepperStopped, bool& isSpeakerTimerSetAllowed, int mode);
+    uint8_t onRight(bool &direction, volatile bool &isStepperRunning, volatile bool &isStepperStopped, bool& isSpeakerTimerSetAllowed, int mode);
+
+  private:
+    uint8_t getMode() {
+      return MENU_NODE_BYTE(this->id, parameter);
+    }
+
+    // amount of pages, editor has "add" page after templates
+    uint8_t getPagesAmount() {
+      if (this->getMode() == TEMPLATE_MODE_EDIT && this->table->isFull() == false) {
+        return this->table->amount + 1;
+      }
+
+      return this->table->amount;
+    }
+
+    bool isAddPage() {
+      return this->index >= this->table->amount;
+    }
 };
 
+/**
+ * @brief Zero calibration.
+ * Manual mode (CALIBRATION_MODE_MANUAL): LEFT/RIGHT jog platform while
+ * held, SELECT sets zero.
+ * Homing mode (CALIBRATION_MODE_HOMING): SELECT starts automatic homing
+ * (see HomingCycle) or stops it, results of the last one are shown
+ */
 class CalibrationWindow : public MenuWindow {
   public:
-    CalibrationWindow(
-      char* title,
-      int index, 
-      int windowNumber,
-      int amountOfWindowsOnCurrentLevel,
-      U8GLIB_SH1106_128X64* u8g,
-      MenuWindow* higherLevelMenu = nullptr,
-      MenuWindow* lowerLevelMenu = nullptr,
-      MenuWindow* prevMenu = nullptr,
-      MenuWindow* nextMenu = nullptr) 
+    HomingCycle* homing;
+    MotionTuner* tuner;
+    SlipMonitor* slipMonitor;
+    // homing state shown by last rendered frame
+    uint8_t renderedHomingState = HOMING_IDLE;
+    // tuning state, level and slips shown by last rendered frame
+    uint8_t renderedTuningState = TUNING_IDLE;
+    unsigned int renderedTuningSpeed = 0;
+    unsigned int renderedTuningAcceleration = 0;
+    unsigned int renderedSlips = 0;
+
+    CalibrationWindow(U8GLIB_SH1106_128X64* u8g, HomingCycle* homing, MotionTuner* tuner, SlipMonitor* slipMonitor) 
     : 
-    MenuWindow(
-      title, index, windowNumber, amountOfWindowsOnCurrentLevel,
-      u8g, higherLevelMenu, lowerLevelMenu,
-      prevMenu, nextMenu) {}
+    MenuWindow(WINDOW_CALIBRATION, u8g) {
+        this->homing = homing;
+        this->tuner = tuner;
+        this->slipMonitor = slipMonitor;
+      }
 
-    void draw(volatile int &passedHoles, double mmPerHole);
-    
-    CalibrationWindow* onSelect(bool &direction, volatile int &passedHoles, volatile bool &isStepperRunning, volatile bool &isStepperStopped, int mode);
-    CalibrationWindow* onLeft(bool &direction, volatile bool &isStepperRunning, volatile bool &isStepperStopped, bool& isSpeakerTimerSetAllowed, int mode);
-    CalibrationWindow* onRight(bool &direction, volatile bool &isStepperRunning, volatile bool &isStepperStopped, bool& isSpeakerTimerSetAllowed, int mode);
-};
+    bool isDirty(long position) {
+      if (this->dirty || position != this->renderedPosition) {
+        return true;
+      }
 
-class CalibrationMenu : public MenuWindow {
-  public:
-    CalibrationMenu(
-      char* title,
-      int index, 
-      int windowNumber,
-      int amountOfWindowsOnCurrentLevel,
-      U8GLIB_SH1106_128X64* u8g,
-      MenuWindow* higherLevelMenu = nullptr,
-      CalibrationWindow* lowerLevelMenu = nullptr,
-      MenuWindow* prevMenu = nullptr,
-      MenuWindow* nextMenu = nullptr) 
-    : 
-    MenuWindow(
-      title, index, windowNumber, amountOfWindowsOnCurrentLevel,
-      u8g, higherLevelMenu, lowerLevelMenu,
-      prevMenu, nextMenu) {}
-};
+      switch (this->getMode())
+      {
+      case CALIBRATION_MODE_HOMING:
+        return this->homing->state != this->renderedHomingState;
+
+      case CALIBRATION_MODE_TUNING: {
+        bool isChanged;
+        //level and slips are written by control ISR
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+          isChanged = this->tuner->state != this->renderedTuningState ||
+            this->tuner->speed != this->renderedTuningSpeed ||
+            this->tuner->acceleration != this->renderedTuningAcceleration ||
+            this->slipMonitor->slips != this->renderedSlips;
+        }
+        return isChanged;
+      }
 
+      default:
+        return false;
+      }
+    }
 
-class ManualModeMenu : public MenuWindow {
-  public:
-    ManualModeMenu(
-      char* title,
-      int index, 
-      int windowNumber,
-      int amountOfWindowsOnCurrentLevel,
-      U8GLIB_SH1106_128X64* u8g,
-      MenuWindow* higherLevelMenu = nullptr,
-      MenuWindow* lowerLevelMenu = nullptr,
-      MenuWindow* prevMenu = nullptr,
-      MenuWindow* nextMenu = nullptr) 
-    : 
-    MenuWindow(
-      title, index, windowNumber,
-      amountOfWindowsOnCurrentLevel, u8g, 
-      higherLevelMenu, lowerLevelMenu,
-      prevMenu, nextMenu) {}
+    void prepare(long position, long umPerHole);
+    
+    uint8_t onSelect(bool &direction, volatile int &passedHoles, volatile bool &isStepperRunning, volatile bool &isStepperStopped, int mode);
+    uint8_t onLeft(bool &direction, volatile bool &isStepperRunning, volatile bool &isStepperStopped, bool& isSpeakerTimerSetAllowed, int mode);
+    uint8_t onRight(bool &direction, volatile bool &isStepperRunning, volatile bool &isStepperStopped, bool& isSpeakerTimerSetAllowed, int mode);
+
+  private:
+    uint8_t getMode() {
+      return MENU_NODE_BYTE(this->id, parameter);
+    }
+
+    void prepareHoming(long position);
+    void prepareTuning(long position);
 };
 
 class ManualModeWindow : public MenuWindow {
   public:
-      volatile int* passedHoles;
-      volatile int* targetPassedHoles;
-
-    ManualModeWindow(
-      char* title,
-      int index,
-      int windowNumber, 
-      int amountOfWindowsOnCurrentLevel,
-      U8GLIB_SH1106_128X64* u8g,
-      MenuWindow* higherLevelMenu = nullptr,
-      MenuWindow* lowerLevelMenu = nullptr,
-      MenuWindow* prevMenu = nullptr,
-      MenuWindow* nextMenu = nullptr) 
+    ManualModeWindow(U8GLIB_SH1106_128X64* u8g) 
     : 
-    MenuWindow(
-      title, index, windowNumber, amountOfWindowsOnCurrentLevel,
-      u8g, higherLevelMenu, lowerLevelMenu,
-      prevMenu, nextMenu) {}
+    MenuWindow(WINDOW_MANUAL, u8g) {}
     
-    void draw(volatile int& passedHoles, double mmPerHole);
+    bool isDirty(long position) {
+      return this->dirty || position != this->renderedPosition;
+    }
 
-    ManualModeWindow* onLeft(bool &direction, volatile bool &isStepperRunning, volatile bool &isStepperStopped, bool& isSpeakerTimerSetAllowed, int mode);
-    ManualModeWindow* onRight(bool &direction, volatile bool &isStepperRunning, volatile bool &isStepperStopped, bool& isSpeakerTimerSetAllowed, int mode);
-};
+    void prepare(long position, long umPerHole);
 
-class SemiAutomaticModeMenu : public MenuWindow {
-  public:
-    SemiAutomaticModeMenu(
-      char* title,
-      int index, 
-      int windowNumber,
-      int amountOfWindowsOnCurrentLevel,
-      U8GLIB_SH1106_128X64* u8g,
-      MenuWindow* higherLevelMenu = nullptr,
-      MenuWindow* lowerLevelMenu = nullptr,
-      MenuWindow* prevMenu = nullptr,
-      MenuWindow* nextMenu = nullptr) 
-    : 
-    MenuWindow(
-      title, index, windowNumber, amountOfWindowsOnCurrentLevel, 
-      u8g, higherLevelMenu, lowerLevelMenu,
-      prevMenu, nextMenu) {}
+    uint8_t onLeft(bool &direction, volatile bool &isStepperRunning, volatile bool &isStepperStopped, bool& isSpeakerTimerSetAllowed, int mode);
+    uint8_t onRight(bool &direction, volatile bool &isStepperRunning, volatile bool &isStepperStopped, bool& isSpeakerTimerSetAllowed, int mode);
 };
 
 class SemiAutomaticModeWindow : public MenuWindow {
   public:
       volatile int* passedHoles;
       volatile int* targetPassedHoles;
+      volatile long* targetRemainder;
+      long umPerHole;
+      // target shown by last rendered frame
+      int renderedTargetPassedHoles = 0;
 
     SemiAutomaticModeWindow(
-      char* title,
-      int index,
-      int windowNumber, 
-      int amountOfWindowsOnCurrentLevel,
       U8GLIB_SH1106_128X64* u8g,
       volatile int *passedHoles,
       volatile int *targetPassedHoles,
-      MenuWindow* higherLevelMenu = nullptr,
-      MenuWindow* lowerLevelMenu = nullptr,
-      MenuWindow* prevMenu = nullptr,
-      MenuWindow* nextMenu = nullptr) 
+      volatile long *targetRemainder) 
     : 
-    MenuWindow(
-      title, index, windowNumber, amountOfWindowsOnCurrentLevel,
-      u8g, higherLevelMenu, lowerLevelMenu,
-      prevMenu, nextMenu) {
+    MenuWindow(WINDOW_SEMI_AUTO, u8g) {
         this->passedHoles = passedHoles;
         this->targetPassedHoles = targetPassedHoles;
+        this->targetRemainder = targetRemainder;
       }
 
+    void setUMPerHole(long umPerHole) {
+      this->umPerHole = umPerHole;
+    };
+
     SemiAutomaticModeWindow* init(volatile bool &isRenderAllowed);
+
+    bool isRepeatable() {
+      return true;
+    }
+
+    bool onHoldStep(int8_t direction, long step);
+
+    bool isDirty(long position) {
+      int targetPassedHoles;
+
+      //target is changed by job queue from control ISR
+      ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        targetPassedHoles = *this->targetPassedHoles;
+      }
+
+      return this->dirty || 
+        position != this->renderedPosition ||
+        targetPassedHoles != this->renderedTargetPassedHoles;
+    }
     
-    void draw(volatile int& passedHoles, double mmPerHole);
+    void prepare(long position, long umPerHole);
+
+    uint8_t onSelect(bool &direction, volatile int& passedHoles, volatile bool& isStepperRunning, volatile bool& isStepperStopped, int mode);
+    uint8_t onLeft(bool &direction, volatile bool &isStepperRunning, volatile bool &isStepperStopped, bool& isSpeakerTimerSetAllowed, int mode);
+    uint8_t onRight(bool &direction, volatile bool &isStepperRunning, volatile bool &isStepperStopped, bool& isSpeakerTimerSetAllowed, int mode);
+};
+
+/**
+ * @brief Job (print cycle) window, see JobQueue.
+ * Run mode (JOB_MODE_RUN): SELECT starts job, continues it after dwell
+ * without time and stops it, BACK stops it and leaves the window.
+ * Edit mode (JOB_MODE_EDIT): LEFT/RIGHT page through segments, last page
+ * adds new one. SELECT edits type of segment, then its value, then saves
+ * job to EEPROM. Removing is offered as the last type, BACK cancels editing
+ */
+class JobWindow : public MenuWindow {
+  public:
+    JobQueue* queue;
+    JobStore* store;
+    volatile int* passedHoles;
+    long umPerHole;
+    // segment shown by editor and its copy which is being edited
+    uint8_t index = 0;
+    JobSegment segment;
+    uint8_t editState = JOB_EDIT_NONE;
+
+    JobWindow(
+      U8GLIB_SH1106_128X64* u8g,
+      JobQueue* queue,
+      JobStore* store,
+      volatile int* passedHoles) 
+    : 
+    MenuWindow(WINDOW_JOB, u8g) {
+        this->queue = queue;
+        this->store = store;
+        this->passedHoles = passedHoles;
+      }
+
+    void setUMPerHole(long umPerHole) {
+      this->umPerHole = umPerHole;
+    };
+
+    bool isDirty(long position) {
+      if (this->getMode() == JOB_MODE_EDIT) {
+        return this->dirty;
+      }
+
+      return this->dirty || position != this->renderedPosition || this->queue->isRunning();
+    }
+
+    bool isRepeatable() {
+      return true;
+    }
+
+    bool onHoldStep(int8_t direction, long step);
+
+    JobWindow* init(volatile bool &isRenderAllowed);
+    void prepare(long position, long umPerHole);
+    uint8_t onBack(volatile bool &isStepperStopped);
+    uint8_t onSelect(bool &direction, volatile int &passedHoles, volatile bool &isStepperRunning, volatile bool &isStepperStopped, int mode);
+    uint8_t onLeft(bool &direction, volatile bool &isStepperRunning, volatile bool &isStepperStopped, bool& isSpeakerTimerSetAllowed, int mode);
+    uint8_t onRight(bool &direction, volatile bool &isStepperRunning, volatile bool &isStepperStopped, bool& isSpeakerTimerSetAllowed, int mode);
+
+  private:
+    uint8_t getMode() {
+      return MENU_NODE_BYTE(this->id, parameter);
+    }
+
+    // amount of editor pages, "add" page follows segments
+    uint8_t getPagesAmount() {
+      if (this->queue->record.amount < JOB_MAX_SEGMENTS) {
+        return this->queue->record.amount + 1;
+      }
+
+      return this->queue->record.amount;
+    }
+
+    bool isAddPage() {
+      return this->index >= this->queue->record.amount;
+    }
 
-    SemiAutomaticModeWindow* onSelect(bool &direction, volatile int& passedHoles, volatile bool& isStepperRunning, volatile bool& isStepperStopped, int mode);
-    SemiAutomaticModeWindow* onLeft(bool &direction, volatile bool &isStepperRunning, volatile bool &isStepperStopped, bool& isSpeakerTimerSetAllowed, int mode);
-    SemiAutomaticModeWindow* onRight(bool &direction, volatile bool &isStepperRunning, volatile bool &isStepperStopped, bool& isSpeakerTimerSetAllowed, int mode);
+    void printSegment(uint8_t type, long value);
+    void changeValue(int direction);
+    bool save();
 };
 
+/**
+ * @brief Selects axis (platen) other windows move and show. LEFT/RIGHT
+ * page through axes and "All", templates, semi-auto, manual and job move
+ * every axis together then, calibration works with axis 1. Selection is
+ * not changed while platform moves, it is applied by loop() once
+ * everything is at rest
+ */
+class AxisWindow : public MenuWindow {
+  public:
+    // index of selected axis or AXIS_ALL, read by loop()
+    volatile uint8_t* selectedAxis;
+
+    AxisWindow(U8GLIB_SH1106_128X64* u8g, volatile uint8_t* selectedAxis) 
+    : 
+    MenuWindow(WINDOW_AXIS, u8g) {
+        this->selectedAxis = selectedAxis;
+      }
+
+    void prepare(long position, long umPerHole);
 
+    uint8_t onLeft(bool &direction, volatile bool &isStepperRunning, volatile bool &isStepperStopped, bool& isSpeakerTimerSetAllowed, int mode);
+    uint8_t onRight(bool &direction, volatile bool &isStepperRunning, volatile bool &isStepperStopped, bool& isSpeakerTimerSetAllowed, int mode);
+
+  private:
+    void change(int8_t step);
+};
+
+/**
+ * @brief Hidden window with profiling counters, min/avg/max in us.
+ * Shown live, SELECT resets counters
+ */
+class DiagnosticsWindow : public MenuWindow {
+  public:
+    DiagnosticsWindow(U8GLIB_SH1106_128X64* u8g) 
+    : 
+    MenuWindow(WINDOW_DIAGNOSTICS, u8g) {}
+
+    bool isDirty(long position) {
+      return true;
+    }
+
+    void prepare(long position, long umPerHole);
+
+    uint8_t onSelect(bool &direction, volatile int& passedHoles, volatile bool& isStepperRunning, volatile bool& isStepperStopped, int mode);
+
+  private:
+    void printCounter(u8g_uint_t y, const __FlashStringHelper* name, ProfileCounter counter);
+};
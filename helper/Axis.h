@@ -0,0 +1,45 @@
+#ifndef AXIS_H
+#define AXIS_H
+
+#include <Arduino.h>
+
+#include "Pins.h"
+#include "StepGenerator.h"
+#include "HoleEncoder.h"
+#include "PositionEstimator.h"
+#include "PositionController.h"
+#include "SlipMonitor.h"
+
+// selection of all axes at once, see AxisWindow
+#define AXIS_ALL 0xFF
+
+/**
+ * @brief One platen: its stepper, reader wheel and everything which
+ * keeps position of it. Members point to each other, so axes are
+ * created in place (brace initialisation of array) and never copied.
+ */
+class Axis {
+  public:
+    // value of passed holes by detector
+    volatile int passedHoles = 0;
+    //pul, dir. Pulses come from shared time base
+    StepGenerator stepper;
+    //counts holes from ISR(INT1_vect) or ISR(PCINTx_vect)
+    HoleEncoder encoder;
+    //position between reader holes, interpolated from steps
+    PositionEstimator estimator;
+    //moves to target of semi-auto and template windows
+    PositionController controller;
+    //stops stepper which loses steps
+    SlipMonitor slipMonitor;
+
+    Axis(StepTimeBase* timeBase, uint8_t index)
+    :
+    stepper(timeBase, index),
+    encoder(&passedHoles, &stepper),
+    estimator(&encoder, &passedHoles),
+    controller(&stepper, &estimator),
+    slipMonitor(&stepper, &estimator) {}
+};
+
+#endif
@@ -0,0 +1,74 @@
+#include "AxisGroup.h"
+
+void AxisGroup::moveTo(long target) {
+    if (this->state != GROUP_IDLE && target == this->target) {
+        return;
+    }
+
+    if (this->state == GROUP_FINISH) {
+        this->axes[this->finishingAxis].controller.cancel();
+    } else {
+        this->timeBase->stop();
+    }
+
+    this->target = target;
+    this->isPlanned = false;
+    this->state = GROUP_FAST;
+}
+
+bool AxisGroup::service() {
+    if (this->state == GROUP_IDLE) {
+        return true;
+    }
+
+    if (this->state == GROUP_FAST) {
+        //previous motion ramps down first
+        if (this->timeBase->isRunning() == true) {
+            return false;
+        }
+
+        if (this->isPlanned == false) {
+            long steps[AXES_AMOUNT];
+
+            for (uint8_t i = 0; i < AXES_AMOUNT; i++) {
+                steps[i] = this->axes[i].controller.planFastSteps(this->target);
+            }
+
+            //lead axis goes at fast speed of controllers
+            this->timeBase->setMaxSpeed(this->axes[0].controller.fastSpeed);
+            this->isPlanned = true;
+            if (this->timeBase->moveTogether(steps) == true) {
+                return false;
+            }
+        }
+
+        this->state = GROUP_FINISH;
+        this->finishingAxis = 0;
+        this->axes[0].controller.moveTo(this->target);
+    }
+
+    if (this->axes[this->finishingAxis].controller.service() == false) {
+        return false;
+    }
+
+    this->finishingAxis += 1;
+    if (this->finishingAxis < AXES_AMOUNT) {
+        this->axes[this->finishingAxis].controller.moveTo(this->target);
+        return false;
+    }
+
+    this->state = GROUP_IDLE;
+    return true;
+}
+
+void AxisGroup::cancel() {
+    if (this->state == GROUP_IDLE) {
+        return;
+    }
+
+    if (this->state == GROUP_FINISH) {
+        this->axes[this->finishingAxis].controller.cancel();
+    }
+    this->timeBase->stop();
+    this->state = GROUP_IDLE;
+}
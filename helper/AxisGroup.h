@@ -0,0 +1,66 @@
+#ifndef AXIS_GROUP_H
+#define AXIS_GROUP_H
+
+#include <Arduino.h>
+
+#include "Axis.h"
+
+// group states
+#define GROUP_IDLE 0
+#define GROUP_FAST 1
+#define GROUP_FINISH 2
+
+/**
+ * @brief Moves all axes to the same target, for targets of templates,
+ * semi-auto and job when all axes are selected.
+ * Fast parts of moves of every axis (see PositionController::planFastSteps())
+ * are made at once by StepTimeBase::moveTogether(), approach and fine
+ * part are made by position controllers of axes one after another, as
+ * every one of them stops on its own reader edge.
+ *
+ * Retarget stops the platforms and plans fast part again. All methods
+ * are called from control ISR.
+ */
+class AxisGroup {
+  public:
+    StepTimeBase* timeBase;
+    Axis* axes;
+
+    uint8_t state = GROUP_IDLE;
+    // target, um
+    long target = 0;
+    // fast part was started
+    bool isPlanned = false;
+    // axis whose controller finishes its move
+    uint8_t finishingAxis = 0;
+
+    AxisGroup(StepTimeBase* timeBase, Axis* axes) {
+      this->timeBase = timeBase;
+      this->axes = axes;
+    }
+
+    /**
+     * @brief starts move to target, or retargets move which is in progress
+     *
+     * @param target position, um
+     */
+    void moveTo(long target);
+
+    /**
+     * @brief drives move, needs to be called on every control tick while move is active
+     *
+     * @return true when all axes reached target and are at rest
+     */
+    bool service();
+
+    /**
+     * @brief abandons move, platforms decelerate to rest
+     */
+    void cancel();
+
+    bool isActive() {
+      return this->state != GROUP_IDLE;
+    }
+};
+
+#endif
@@ -0,0 +1,163 @@
+#ifndef AXIS_PINS_H
+#define AXIS_PINS_H
+
+#include <Arduino.h>
+
+#include "Pins.h"
+#include "FastGpio.h"
+
+/**
+ * @brief Pins of axis by its index (0 - axis 1, see Pins.h).
+ * FastPin needs pin at compile time, so index is dispatched by switch,
+ * cases of axes which are not built are left out. Called from step ISR,
+ * so everything is inline.
+ */
+
+inline void axisStepHigh(uint8_t index) {
+  switch (index)
+  {
+  case 0:
+    FastPin<STEP>::high();
+    break;
+#if AXES_AMOUNT > 1
+  case 1:
+    FastPin<STEP_2>::high();
+    break;
+#endif
+#if AXES_AMOUNT > 2
+  case 2:
+    FastPin<STEP_3>::high();
+    break;
+#endif
+#if AXES_AMOUNT > 3
+  case 3:
+    FastPin<STEP_4>::high();
+    break;
+#endif
+  }
+}
+
+/**
+ * @brief ends step pulses of all axes at once
+ */
+inline void axisStepsLow() {
+  FastPin<STEP>::low();
+#if AXES_AMOUNT > 1
+  FastPin<STEP_2>::low();
+#endif
+#if AXES_AMOUNT > 2
+  FastPin<STEP_3>::low();
+#endif
+#if AXES_AMOUNT > 3
+  FastPin<STEP_4>::low();
+#endif
+}
+
+inline void axisWriteDirection(uint8_t index, uint8_t level) {
+  switch (index)
+  {
+  case 0:
+    FastPin<DIR>::write(level);
+    break;
+#if AXES_AMOUNT > 1
+  case 1:
+    FastPin<DIR_2>::write(level);
+    break;
+#endif
+#if AXES_AMOUNT > 2
+  case 2:
+    FastPin<DIR_3>::write(level);
+    break;
+#endif
+#if AXES_AMOUNT > 3
+  case 3:
+    FastPin<DIR_4>::write(level);
+    break;
+#endif
+  }
+}
+
+/**
+ * @brief STEP low and DIR as outputs
+ */
+inline void axisSetupDriver(uint8_t index) {
+  switch (index)
+  {
+  case 0:
+    FastPin<STEP>::low();
+    FastPin<STEP>::setOutput();
+    FastPin<DIR>::setOutput();
+    break;
+#if AXES_AMOUNT > 1
+  case 1:
+    FastPin<STEP_2>::low();
+    FastPin<STEP_2>::setOutput();
+    FastPin<DIR_2>::setOutput();
+    break;
+#endif
+#if AXES_AMOUNT > 2
+  case 2:
+    FastPin<STEP_3>::low();
+    FastPin<STEP_3>::setOutput();
+    FastPin<DIR_3>::setOutput();
+    break;
+#endif
+#if AXES_AMOUNT > 3
+  case 3:
+    FastPin<STEP_4>::low();
+    FastPin<STEP_4>::setOutput();
+    FastPin<DIR_4>::setOutput();
+    break;
+#endif
+  }
+}
+
+inline uint8_t axisReadReader(uint8_t index) {
+  switch (index)
+  {
+#if AXES_AMOUNT > 1
+  case 1:
+    return FastPin<M_DIGITAL_READER_2>::read();
+#endif
+#if AXES_AMOUNT > 2
+  case 2:
+    return FastPin<M_DIGITAL_READER_3>::read();
+#endif
+#if AXES_AMOUNT > 3
+  case 3:
+    return FastPin<M_DIGITAL_READER_4>::read();
+#endif
+  default:
+    return FastPin<M_DIGITAL_READER>::read();
+  }
+}
+
+/**
+ * @brief reader of axes 2-4 as input with pin change interrupt,
+ * reader of axis 1 has external interrupt (see HoleEncoder::begin())
+ */
+inline void axisSetupReader(uint8_t index) {
+  switch (index)
+  {
+#if AXES_AMOUNT > 1
+  case 1:
+    FastPin<M_DIGITAL_READER_2>::setInput();
+    FastPin<M_DIGITAL_READER_2>::enableChangeInterrupt();
+    break;
+#endif
+#if AXES_AMOUNT > 2
+  case 2:
+    FastPin<M_DIGITAL_READER_3>::setInput();
+    FastPin<M_DIGITAL_READER_3>::enableChangeInterrupt();
+    break;
+#endif
+#if AXES_AMOUNT > 3
+  case 3:
+    FastPin<M_DIGITAL_READER_4>::setInput();
+    FastPin<M_DIGITAL_READER_4>::enableChangeInterrupt();
+    break;
+#endif
+  }
+}
+
+#endif
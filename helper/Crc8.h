@@ -0,0 +1,25 @@
+#ifndef CRC8_H
+#define CRC8_H
+
+#include <Arduino.h>
+
+/**
+ * @brief CRC-8 (polynomial 0x07), used to validate records stored in EEPROM
+ *
+ * @param data bytes to check
+ * @param length amount of bytes
+ * @param crc initial value, allows to continue calculation over several blocks
+ * @return uint8_t
+ */
+inline uint8_t crc8(const uint8_t* data, uint8_t length, uint8_t crc = 0) {
+  while (length--) {
+    crc ^= *data++;
+    for (uint8_t i = 0; i < 8; i++) {
+      crc = (crc & 0x80) ? (crc << 1) ^ 0x07 : (crc << 1);
+    }
+  }
+
+  return crc;
+}
+
+#endif
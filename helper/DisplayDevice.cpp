@@ -0,0 +1,91 @@
+#include <util/crc16.h>
+#include <util/atomic.h>
+
+#include "DisplayDevice.h"
+#include "DisplayTransmitter.h"
+
+DisplayDevice displayDevice;
+
+static uint8_t displayDeviceFn(u8g_t *u8g, u8g_dev_t *dev, uint8_t msg, void *arg) {
+    return displayDevice.onDeviceMessage(u8g, dev, msg, arg);
+}
+
+void DisplayDevice::begin(U8GLIB* u8g) {
+    u8g_dev_t *dev = u8g->getU8g()->dev;
+
+    this->originalDeviceFn = dev->dev_fn;
+    dev->dev_fn = displayDeviceFn;
+    this->invalidate();
+
+    displayTransmitter.begin();
+}
+
+bool DisplayDevice::dropFailedPages() {
+    uint8_t failedPages;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        failedPages = displayTransmitter.failedPages;
+        displayTransmitter.failedPages = 0;
+    }
+    this->validPages &= ~failedPages;
+
+    return failedPages != 0;
+}
+
+uint8_t DisplayDevice::onDeviceMessage(u8g_t *u8g, u8g_dev_t *dev, uint8_t msg, void *arg) {
+    if (msg == U8G_DEV_MSG_SET_8PIXEL || msg == U8G_DEV_MSG_SET_PIXEL) {
+        this->frameCost.pixelWrites += 1;
+        return this->originalDeviceFn(u8g, dev, msg, arg);
+    }
+
+    if (msg == U8G_DEV_MSG_PAGE_FIRST) {
+        this->frameCost.pixelWrites = 0;
+        this->frameCost.renderedPages = 0;
+        this->frameCost.sentPages = 0;
+        this->frameCost.sentBytes = 0;
+        return this->originalDeviceFn(u8g, dev, msg, arg);
+    }
+
+    if (msg == U8G_DEV_MSG_PAGE_NEXT) {
+        u8g_pb_t *pb = (u8g_pb_t *)(dev->dev_mem);
+        uint8_t page = pb->p.page;
+        uint8_t *buffer = (uint8_t *)pb->buf;
+        uint16_t checksum = 0xFFFF;
+
+        this->frameCost.renderedPages += 1;
+
+        for (u8g_uint_t i = 0; i < pb->width; i++) {
+            checksum = _crc_ccitt_update(checksum, buffer[i]);
+        }
+
+        if (page < DISPLAY_PAGES) {
+            uint8_t pageBit = 1 << page;
+
+            if ((this->validPages & pageBit) && this->pageChecksums[page] == checksum) {
+                //display already shows this page, only clear buffer and go to next one
+                return u8g_dev_pb8v1_base_fn(u8g, dev, msg, arg);
+            }
+
+            this->pageChecksums[page] = checksum;
+            this->validPages |= pageBit;
+        }
+
+        this->frameCost.sentPages += 1;
+        this->frameCost.sentBytes += DISPLAY_PAGE_TRANSFER_BYTES;
+        displayTransmitter.queuePage(page, buffer);
+        return u8g_dev_pb8v1_base_fn(u8g, dev, msg, arg);
+    }
+
+    //display content is unknown after reinit or sleep
+    if (msg == U8G_DEV_MSG_INIT || msg == U8G_DEV_MSG_SLEEP_ON || msg == U8G_DEV_MSG_SLEEP_OFF) {
+        this->invalidate();
+    }
+
+    //u8glib talks to display directly, queued pages have to be on the wire first
+    if (msg == U8G_DEV_MSG_INIT || msg == U8G_DEV_MSG_SLEEP_ON || 
+        msg == U8G_DEV_MSG_SLEEP_OFF || msg == U8G_DEV_MSG_CONTRAST) {
+        while (displayTransmitter.isIdle() == false) {}
+    }
+
+    return this->originalDeviceFn(u8g, dev, msg, arg);
+}
@@ -0,0 +1,66 @@
+#ifndef DISPLAY_DEVICE_H
+#define DISPLAY_DEVICE_H
+
+#include <U8glib.h>
+
+// SH1106 128x64 in page mode: 8 pages of 128x8 pixels
+#define DISPLAY_PAGES 8
+
+/**
+ * @brief Cost of the last rendered frame, counted from firstPage()
+ */
+struct RenderCost {
+  // pixel writes of u8glib (SET_PIXEL and SET_8PIXEL device messages)
+  uint16_t pixelWrites;
+  uint8_t renderedPages;
+  // pages which changed and were queued to display
+  uint8_t sentPages;
+  uint16_t sentBytes;
+};
+
+/**
+ * @brief Hooks into u8glib device procedure of the display.
+ * Checksum of every rendered page is compared with the one which was
+ * sent last time, and unchanged pages are not transferred over I2C at all.
+ * Checksums of shown pages also serve as fingerprint of the frame, they
+ * are read by host together with the cost of rendering (see RenderCost).
+ * Changed pages are handed to DisplayTransmitter instead of u8glib's
+ * blocking I2C, so rendering of next page goes on while previous is sent.
+ */
+class DisplayDevice {
+  public:
+    u8g_dev_fnptr originalDeviceFn = nullptr;
+    // checksums of pages which are currently on display
+    uint16_t pageChecksums[DISPLAY_PAGES];
+    // bit per page, set when pageChecksums value can be trusted
+    uint8_t validPages = 0;
+    RenderCost frameCost = {0, 0, 0, 0};
+
+    /**
+     * @brief installs hook and starts transmitter, needs to be called once in setup()
+     *
+     * @param u8g display
+     */
+    void begin(U8GLIB* u8g);
+
+    /**
+     * @brief forces every page to be sent with next frame
+     */
+    void invalidate() {
+      this->validPages = 0;
+    }
+
+    /**
+     * @brief forgets checksums of pages which display did not acknowledge,
+     * needs to be called before frame is rendered
+     *
+     * @return true if any page has to be sent again
+     */
+    bool dropFailedPages();
+
+    uint8_t onDeviceMessage(u8g_t *u8g, u8g_dev_t *dev, uint8_t msg, void *arg);
+};
+
+extern DisplayDevice displayDevice;
+
+#endif
@@ -0,0 +1,109 @@
+#include <util/atomic.h>
+
+#include "DisplayTransmitter.h"
+
+// TWI status codes
+#define TWI_START 0x08
+#define TWI_REPEATED_START 0x10
+#define TWI_SLA_ACK 0x18
+#define TWI_DATA_ACK 0x28
+
+#define TWI_CONTINUE (_BV(TWINT) | _BV(TWEN) | _BV(TWIE))
+
+// amount of bytes after SLA in command and data transactions
+#define DISPLAY_COMMAND_LENGTH 4
+#define DISPLAY_DATA_LENGTH (DISPLAY_PAGE_WIDTH + 1)
+
+DisplayTransmitter displayTransmitter;
+
+void DisplayTransmitter::begin() {
+    TWSR = 0;
+    TWBR = DISPLAY_TWI_BIT_RATE;
+    TWCR = _BV(TWEN);
+}
+
+void DisplayTransmitter::queuePage(uint8_t page, const uint8_t* buffer) {
+    //queue is full, previous pages are still on the wire
+    while (this->count == DISPLAY_QUEUE_SIZE) {}
+
+    uint8_t slot = (this->head + this->count) % DISPLAY_QUEUE_SIZE;
+    this->pages[slot] = page;
+    memcpy(this->buffers[slot], buffer, DISPLAY_PAGE_WIDTH);
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        this->count += 1;
+
+        if (this->count == 1) {
+            this->phase = 0;
+            this->byteIndex = 0;
+            TWCR = TWI_CONTINUE | _BV(TWSTA);
+        }
+    }
+}
+
+void DisplayTransmitter::finishPage(bool isFailed) {
+    if (isFailed == true) {
+        this->failedPages |= 1 << this->pages[this->head];
+    }
+
+    this->head = (this->head + 1) % DISPLAY_QUEUE_SIZE;
+    this->count -= 1;
+    this->phase = 0;
+    this->byteIndex = 0;
+
+    if (this->count > 0) {
+        //stop and start of the next page at once
+        TWCR = TWI_CONTINUE | _BV(TWSTO) | _BV(TWSTA);
+    } else {
+        TWCR = _BV(TWEN) | _BV(TWSTO);
+    }
+}
+
+void DisplayTransmitter::onTwiInterrupt() {
+    switch (TWSR & 0xF8)
+    {
+    case TWI_START:
+    case TWI_REPEATED_START:
+        TWDR = DISPLAY_I2C_ADDRESS;
+        TWCR = TWI_CONTINUE;
+        break;
+
+    case TWI_SLA_ACK:
+    case TWI_DATA_ACK:
+        if (this->phase == 0) {
+            if (this->byteIndex < DISPLAY_COMMAND_LENGTH) {
+                switch (this->byteIndex++)
+                {
+                case 0: TWDR = 0x00; break;                              //command mode
+                case 1: TWDR = 0x10; break;                              //column, upper 4 bits
+                case 2: TWDR = 0x02; break;                              //column, lower 4 bits (sh1106 offset)
+                case 3: TWDR = 0xB0 | this->pages[this->head]; break;    //page
+                }
+                TWCR = TWI_CONTINUE;
+            } else {
+                //data mode needs new transaction
+                this->phase = 1;
+                this->byteIndex = 0;
+                TWCR = TWI_CONTINUE | _BV(TWSTA);
+            }
+        } else {
+            if (this->byteIndex == 0) {
+                TWDR = 0x40; //data mode
+                this->byteIndex++;
+                TWCR = TWI_CONTINUE;
+            } else if (this->byteIndex < DISPLAY_DATA_LENGTH) {
+                TWDR = this->buffers[this->head][this->byteIndex - 1];
+                this->byteIndex++;
+                TWCR = TWI_CONTINUE;
+            } else {
+                this->finishPage(false);
+            }
+        }
+        break;
+
+    default:
+        //no acknowledge or arbitration lost, page has to be sent again
+        this->finishPage(true);
+        break;
+    }
+}
@@ -0,0 +1,67 @@
+#ifndef DISPLAY_TRANSMITTER_H
+#define DISPLAY_TRANSMITTER_H
+
+#include <Arduino.h>
+
+// SH1106 I2C address, write mode
+#define DISPLAY_I2C_ADDRESS (0x3C << 1)
+#define DISPLAY_PAGE_WIDTH 128
+// bytes on the wire per page, both transactions with their addresses
+#define DISPLAY_PAGE_TRANSFER_BYTES (5 + 2 + DISPLAY_PAGE_WIDTH)
+// pages which can wait for transfer, each costs DISPLAY_PAGE_WIDTH bytes of RAM
+#define DISPLAY_QUEUE_SIZE 2
+// TWI bit rate register value for 400 kHz: (F_CPU / 400000 - 16) / 2
+#define DISPLAY_TWI_BIT_RATE ((F_CPU / 400000UL - 16) / 2)
+
+/**
+ * @brief Interrupt-driven TWI transmitter for display pages.
+ * Rendered page is copied into the queue and sent from TWI interrupt,
+ * so loop() only waits when the whole queue is still on the wire.
+ *
+ * Each page is sent as two transactions, same as u8glib does:
+ * [SLA, 0x00, column high, column low, page] and [SLA, 0x40, 128 data bytes].
+ */
+class DisplayTransmitter {
+  public:
+    uint8_t pages[DISPLAY_QUEUE_SIZE];
+    uint8_t buffers[DISPLAY_QUEUE_SIZE][DISPLAY_PAGE_WIDTH];
+    // queue head (next to send) and amount of queued pages
+    volatile uint8_t head = 0;
+    volatile uint8_t count = 0;
+
+    // 0 - command transaction, 1 - data transaction
+    volatile uint8_t phase = 0;
+    volatile uint8_t byteIndex = 0;
+    // bit per page which was not acknowledged by display
+    volatile uint8_t failedPages = 0;
+
+    /**
+     * @brief switches TWI to 400 kHz, needs to be called after u8glib has initialized display
+     */
+    void begin();
+
+    /**
+     * @brief copies page into the queue and starts transfer,
+     * waits only if queue is full
+     *
+     * @param page display page number
+     * @param buffer DISPLAY_PAGE_WIDTH bytes
+     */
+    void queuePage(uint8_t page, const uint8_t* buffer);
+
+    bool isIdle() {
+      return this->count == 0;
+    }
+
+    /**
+     * @brief needs to be called from ISR(TWI_vect)
+     */
+    void onTwiInterrupt();
+
+  private:
+    void finishPage(bool isFailed);
+};
+
+extern DisplayTransmitter displayTransmitter;
+
+#endif
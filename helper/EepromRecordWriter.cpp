@@ -0,0 +1,16 @@
+#include <EEPROM.h>
+
+#include "EepromRecordWriter.h"
+#include "Profiler.h"
+
+void EepromRecordWriter::service() {
+    if (this->isBusy() == false || eeprom_is_ready() == false) {
+        return;
+    }
+
+    PROFILE_START(eepromWrite);
+    EEPROM.update(this->address + this->writtenBytes, this->data[this->writtenBytes]);
+    PROFILE_STOP(eepromWrite);
+
+    this->writtenBytes += 1;
+}
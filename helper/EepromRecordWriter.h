@@ -0,0 +1,50 @@
+#ifndef EEPROM_RECORD_WRITER_H
+#define EEPROM_RECORD_WRITER_H
+
+#include <Arduino.h>
+
+/**
+ * @brief Writes one record to EEPROM a byte at a time, from loop() only
+ * when EEPROM is ready, so neither ISR nor loop() ever waits for it.
+ * Bytes go in order and unchanged ones are skipped. Records keep their
+ * crc in the last byte, so record becomes valid only when all its other
+ * bytes are already in place and power loss leaves it invalid, not mixed.
+ *
+ * Bytes are taken from the record itself, it must not change until
+ * isBusy() is false.
+ */
+class EepromRecordWriter {
+  public:
+    int address;
+    const uint8_t* data;
+    uint8_t length = 0;
+    // bytes already written, record is written when it equals length
+    uint8_t writtenBytes = 0;
+
+    /**
+     * @brief schedules record writing, previous one is dropped if it is
+     * not written yet
+     *
+     * @param address EEPROM address of the first byte
+     * @param data record, kept unchanged until writing ends
+     * @param length record size, bytes
+     */
+    void start(int address, const void* data, uint8_t length) {
+      this->address = address;
+      this->data = (const uint8_t*)data;
+      this->length = length;
+      this->writtenBytes = 0;
+    }
+
+    /**
+     * @brief writes next byte if EEPROM is ready, needs to be called on
+     * every loop() pass
+     */
+    void service();
+
+    bool isBusy() {
+      return this->writtenBytes < this->length;
+    }
+};
+
+#endif
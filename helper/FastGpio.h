@@ -0,0 +1,91 @@
+#ifndef FAST_GPIO_H
+#define FAST_GPIO_H
+
+#include <Arduino.h>
+
+/**
+ * @brief Digital pin of ATmega328 (Nano), resolved at compile time.
+ * Register and mask are constants, so every call is a single sbi, cbi
+ * or sbic/sbis instruction instead of pin table lookups of digitalWrite()
+ * and digitalRead(). One bit sbi/cbi can not be torn by interrupt, so
+ * pins can be shared by ISR and loop().
+ *
+ * Pins 0-7 are PORTD, 8-13 PORTB, 14-19 (A0-A5) PORTC.
+ * A6 and A7 are analog only.
+ */
+template<uint8_t PIN>
+class FastPin {
+  public:
+    static_assert(PIN < 20, "FastPin supports digital pins 0-19 only");
+
+    static const uint8_t mask = 1 << (PIN < 8 ? PIN : (PIN < 14 ? PIN - 8 : PIN - 14));
+
+    static volatile uint8_t& port() {
+      return PIN < 8 ? PORTD : (PIN < 14 ? PORTB : PORTC);
+    }
+
+    static volatile uint8_t& input() {
+      return PIN < 8 ? PIND : (PIN < 14 ? PINB : PINC);
+    }
+
+    static volatile uint8_t& mode() {
+      return PIN < 8 ? DDRD : (PIN < 14 ? DDRB : DDRC);
+    }
+
+    static void setOutput() {
+      mode() |= mask;
+    }
+
+    /**
+     * @brief input without pull-up
+     */
+    static void setInput() {
+      mode() &= ~mask;
+      port() &= ~mask;
+    }
+
+    static void setInputPullup() {
+      mode() &= ~mask;
+      port() |= mask;
+    }
+
+    static void high() {
+      port() |= mask;
+    }
+
+    static void low() {
+      port() &= ~mask;
+    }
+
+    static void write(uint8_t level) {
+      if (level == LOW) {
+        low();
+      } else {
+        high();
+      }
+    }
+
+    /**
+     * @brief writing one to PINx bit toggles output
+     */
+    static void toggle() {
+      input() = mask;
+    }
+
+    static uint8_t read() {
+      return (input() & mask) != 0 ? HIGH : LOW;
+    }
+
+    /**
+     * @brief enables pin change interrupt of pin, it comes to PCINT2_vect
+     * for PORTD, PCINT0_vect for PORTB and PCINT1_vect for PORTC
+     */
+    static void enableChangeInterrupt() {
+      volatile uint8_t& changeMask = PIN < 8 ? PCMSK2 : (PIN < 14 ? PCMSK0 : PCMSK1);
+
+      changeMask |= mask;
+      PCICR |= _BV(PIN < 8 ? PCIE2 : (PIN < 14 ? PCIE0 : PCIE1));
+    }
+};
+
+#endif
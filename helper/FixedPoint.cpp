@@ -0,0 +1,28 @@
+#include "FixedPoint.h"
+
+uint8_t formatMillimetres(char* buffer, long micrometres) {
+    char digits[MM_STRING_LENGTH];
+    uint8_t amountOfDigits = 0;
+    uint8_t length = 0;
+    unsigned long hundredths = labs(roundDivide(micrometres, 10));
+
+    if (micrometres < 0 && hundredths != 0) {
+        buffer[length++] = '-';
+    }
+
+    //2 decimals plus at least one integer digit
+    do {
+        digits[amountOfDigits++] = '0' + hundredths % 10;
+        hundredths /= 10;
+    } while (hundredths != 0 || amountOfDigits < 3);
+
+    while (amountOfDigits > 0) {
+        buffer[length++] = digits[--amountOfDigits];
+        if (amountOfDigits == 2) {
+            buffer[length++] = '.';
+        }
+    }
+    buffer[length] = '\0';
+
+    return length;
+}
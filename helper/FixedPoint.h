@@ -0,0 +1,68 @@
+#ifndef FIXED_POINT_H
+#define FIXED_POINT_H
+
+#include <Arduino.h>
+
+// positions are kept in micrometres, long
+#define UM_PER_MM 1000L
+// enough for "-2147483.65"
+#define MM_STRING_LENGTH 12
+
+/**
+ * @brief division rounded to nearest, halves away from zero
+ *
+ * @param value dividend
+ * @param divider positive divider
+ * @return long
+ */
+inline long roundDivide(long value, long divider) {
+  long quotient = value / divider;
+  long remainder = value % divider;
+
+  //half of divider is compared without adding it to value,
+  //so limits of long do not overflow
+  if (remainder >= divider - remainder) {
+    return quotient + 1;
+  }
+  if (-remainder >= divider + remainder) {
+    return quotient - 1;
+  }
+
+  return quotient;
+}
+
+/**
+ * @brief moves value by step and snaps it to multiple of step,
+ * so 12.34 held up by 1 goes 13, 14, 15 and held down 12, 11, 10
+ *
+ * @param value
+ * @param step positive step
+ * @param direction 1 up, -1 down
+ * @return long
+ */
+inline long stepSnapped(long value, long step, int8_t direction) {
+  long floored = value / step * step;
+
+  //division truncates to zero, negative values need floor
+  if (floored > value) {
+    floored -= step;
+  }
+
+  if (direction > 0) {
+    return floored + step;
+  }
+
+  return floored == value ? value - step : floored;
+}
+
+/**
+ * @brief formats micrometres as millimetres with 2 decimals, same as
+ * Print::print(double) did, but without soft-float
+ *
+ * @param buffer at least MM_STRING_LENGTH chars
+ * @param micrometres value to format
+ * @return uint8_t length of string
+ */
+uint8_t formatMillimetres(char* buffer, long micrometres);
+
+#endif
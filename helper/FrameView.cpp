@@ -0,0 +1,83 @@
+#include "FrameView.h"
+
+void FrameView::addLine(const u8g_fntpgm_uint8_t* font, u8g_uint_t x, u8g_uint_t y) {
+    //each line needs at least its terminator
+    if (this->amountOfLines >= VIEW_LINES_AMOUNT || this->textLength >= VIEW_TEXT_LENGTH) {
+        return;
+    }
+
+    ViewLine &line = this->lines[this->amountOfLines++];
+    line.font = font;
+    line.x = x;
+    line.y = y;
+    line.start = this->textLength;
+
+    this->text[this->textLength++] = '\0';
+}
+
+void FrameView::print(const char* string) {
+    if (this->isLineOpen() == false) {
+        return;
+    }
+
+    //terminator of last line is overwritten and put after appended chars
+    uint8_t length = this->textLength - 1;
+    while (*string != '\0' && length < VIEW_TEXT_LENGTH - 1) {
+        this->text[length++] = *string++;
+    }
+    this->text[length++] = '\0';
+    this->textLength = length;
+}
+
+void FrameView::print(const __FlashStringHelper* string) {
+    const char* pointer = (const char*)string;
+    char symbol;
+
+    if (this->isLineOpen() == false) {
+        return;
+    }
+
+    uint8_t length = this->textLength - 1;
+    while (length < VIEW_TEXT_LENGTH - 1 && (symbol = pgm_read_byte(pointer++)) != '\0') {
+        this->text[length++] = symbol;
+    }
+    this->text[length++] = '\0';
+    this->textLength = length;
+}
+
+void FrameView::print(long number) {
+    char buffer[12];
+
+    ltoa(number, buffer, 10);
+    this->print(buffer);
+}
+
+void FrameView::printMillimetres(long micrometres) {
+    char buffer[MM_STRING_LENGTH];
+
+    formatMillimetres(buffer, micrometres);
+    this->print(buffer);
+}
+
+void FrameView::centerLine(U8GLIB* u8g) {
+    if (this->amountOfLines == 0) {
+        return;
+    }
+
+    ViewLine &line = this->lines[this->amountOfLines - 1];
+    u8g->setFont(line.font);
+    u8g_uint_t width = u8g->getStrWidth(this->getLineText(this->amountOfLines - 1));
+    line.x = width < DISPLAY_WIDTH ? (DISPLAY_WIDTH - width) / 2 : 0;
+}
+
+void FrameView::draw(U8GLIB* u8g) {
+    const u8g_fntpgm_uint8_t* font = nullptr;
+
+    for (uint8_t i = 0; i < this->amountOfLines; i++) {
+        if (this->lines[i].font != font) {
+            font = this->lines[i].font;
+            u8g->setFont(font);
+        }
+        u8g->drawStr(this->lines[i].x, this->lines[i].y, this->getLineText(i));
+    }
+}
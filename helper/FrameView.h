@@ -0,0 +1,89 @@
+#ifndef FRAME_VIEW_H
+#define FRAME_VIEW_H
+
+#include <U8glib.h>
+
+#include "FixedPoint.h"
+
+#define DISPLAY_WIDTH 128
+
+// the most crowded window (diagnostics) has 9 text lines
+#define VIEW_LINES_AMOUNT 10
+// chars of all lines of one frame together, terminators included
+#define VIEW_TEXT_LENGTH 112
+
+/**
+ * @brief Text line of frame, text is kept in FrameView::text
+ */
+struct ViewLine {
+  const u8g_fntpgm_uint8_t* font;
+  u8g_uint_t x;
+  u8g_uint_t y;
+  // index of the first char in FrameView::text
+  uint8_t start;
+};
+
+/**
+ * @brief Content of one frame, prepared once before u8glib page loop.
+ * u8glib draws frame page by page, so everything drawn is drawn
+ * DISPLAY_PAGES times. Window fills view once (reads shared state,
+ * formats numbers, measures widths) and every page only blits lines.
+ * Lines which do not fit are cut, never written past the buffers
+ */
+class FrameView {
+  public:
+    ViewLine lines[VIEW_LINES_AMOUNT];
+    char text[VIEW_TEXT_LENGTH];
+    uint8_t amountOfLines = 0;
+    uint8_t textLength = 0;
+
+    void clear() {
+      this->amountOfLines = 0;
+      this->textLength = 0;
+    }
+
+    /**
+     * @brief starts new line, print() appends to it
+     *
+     * @param font u8glib font
+     * @param x left side of text
+     * @param y baseline of text
+     */
+    void addLine(const u8g_fntpgm_uint8_t* font, u8g_uint_t x, u8g_uint_t y);
+
+    void print(const char* string);
+    void print(const __FlashStringHelper* string);
+    void print(long number);
+
+    /**
+     * @brief prints position without float math
+     *
+     * @param micrometres position
+     */
+    void printMillimetres(long micrometres);
+
+    /**
+     * @brief centers last line on display, width is measured once per frame
+     *
+     * @param u8g display, its font is changed
+     */
+    void centerLine(U8GLIB* u8g);
+
+    /**
+     * @brief draws all lines, needs to be called for every page
+     *
+     * @param u8g display
+     */
+    void draw(U8GLIB* u8g);
+
+  private:
+    bool isLineOpen() {
+      return this->amountOfLines > 0 && this->textLength < VIEW_TEXT_LENGTH;
+    }
+
+    char* getLineText(uint8_t line) {
+      return this->text + this->lines[line].start;
+    }
+};
+
+#endif
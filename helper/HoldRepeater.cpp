@@ -0,0 +1,30 @@
+#include "HoldRepeater.h"
+
+static const HoldRepeatStage holdRepeatStages[HOLD_REPEAT_STAGES_AMOUNT] PROGMEM = {
+    //1 s of the smallest steps, then 2 s of millimetres, then 5 mm
+    {10, 100, 0},
+    {25, 80, 1000},
+    {0, 80, 5000},
+};
+
+unsigned int HoldRepeater::getPeriod() {
+    return pgm_read_word(&holdRepeatStages[this->stage].period);
+}
+
+long HoldRepeater::getStep() {
+    return pgm_read_dword(&holdRepeatStages[this->stage].step);
+}
+
+void HoldRepeater::advance() {
+    uint8_t stageRepeats = pgm_read_byte(&holdRepeatStages[this->stage].repeats);
+
+    if (stageRepeats == 0) {
+        return;
+    }
+
+    this->repeats += 1;
+    if (this->repeats >= stageRepeats) {
+        this->stage += 1;
+        this->repeats = 0;
+    }
+}
@@ -0,0 +1,59 @@
+#ifndef HOLD_REPEATER_H
+#define HOLD_REPEATER_H
+
+#include <Arduino.h>
+
+// stages of holding, see holdRepeatStages
+#define HOLD_REPEAT_STAGES_AMOUNT 3
+
+/**
+ * @brief Stage of held button repeating
+ */
+struct HoldRepeatStage {
+  // repeats made before the next stage, 0 - last stage
+  uint8_t repeats;
+  // time between repeats, ms
+  uint16_t period;
+  // change of value by one repeat, um. 0 - the smallest step of window (same as click)
+  long step;
+};
+
+/**
+ * @brief Repeat engine of held LEFT/RIGHT.
+ * The longer button is held, the faster and the coarser value goes:
+ * first repeats make the smallest step of window, then whole millimetres,
+ * then 5 mm. Coarse steps are snapped to multiples of step, so value
+ * which was set by small steps continues from round numbers.
+ * Window decides how a step is applied (see MenuWindow::onHoldStep).
+ */
+class HoldRepeater {
+  public:
+    uint8_t stage = 0;
+    // repeats made on current stage
+    uint8_t repeats = 0;
+
+    /**
+     * @brief starts from the first stage, needs to be called on hold event
+     */
+    void start() {
+      this->stage = 0;
+      this->repeats = 0;
+    }
+
+    /**
+     * @return unsigned int time until the next repeat, ms
+     */
+    unsigned int getPeriod();
+
+    /**
+     * @return long step of the next repeat, um. 0 - the smallest step of window
+     */
+    long getStep();
+
+    /**
+     * @brief counts made repeat, goes to the next stage when it is time
+     */
+    void advance();
+};
+
+#endif
@@ -0,0 +1,97 @@
+#include <util/atomic.h>
+
+#include "HoleEncoder.h"
+#include "FastGpio.h"
+
+void HoleEncoder::begin() {
+    this->lastEdgeAt = micros();
+
+    if (this->stepper->index != 0) {
+        axisSetupReader(this->stepper->index);
+        this->readerLevel = axisReadReader(this->stepper->index);
+        return;
+    }
+
+    FastPin<M_DIGITAL_READER>::setInput();
+#if M_DIGITAL_READER_B != ENCODER_NO_PIN
+    FastPin<M_DIGITAL_READER_B>::setInput();
+#endif
+
+    //any edge of INT0 (pin 2) or INT1 (pin 3)
+    if (digitalPinToInterrupt(M_DIGITAL_READER) == 0) {
+        EICRA = (EICRA & ~(_BV(ISC01) | _BV(ISC00))) | _BV(ISC00);
+        EIFR = _BV(INTF0);
+        EIMSK |= _BV(INT0);
+    } else {
+        EICRA = (EICRA & ~(_BV(ISC11) | _BV(ISC10))) | _BV(ISC10);
+        EIFR = _BV(INTF1);
+        EIMSK |= _BV(INT1);
+    }
+}
+
+void HoleEncoder::onEdge() {
+    this->countEdge(FastPin<M_DIGITAL_READER>::read());
+}
+
+void HoleEncoder::countEdge(uint8_t level) {
+    //UP is driven by LOW level of DIR
+    bool isUp = this->stepper->direction == LOW;
+#if M_DIGITAL_READER_B != ENCODER_NO_PIN
+    //channel B is wired for axis 1 only, its level on falling edge of
+    //channel A is opposite to the one on rising edge
+    if (this->stepper->index == 0) {
+        isUp = FastPin<M_DIGITAL_READER_B>::read() != level;
+    }
+#endif
+
+    //the other side of hole, it is counted where platform going up enters it
+    if ((level == HIGH) != isUp) {
+        return;
+    }
+
+    unsigned long now = micros();
+
+    if (now - this->lastEdgeAt < ENCODER_MIN_EDGE_INTERVAL) {
+        return;
+    }
+
+    if (isUp == true) {
+        *this->passedHoles += 1;
+        this->edgeDirection = 1;
+    } else {
+        *this->passedHoles -= 1;
+        this->edgeDirection = -1;
+    }
+    this->edgeStepPosition = this->stepper->position;
+
+    this->edgePeriod = now - this->lastEdgeAt;
+    this->lastEdgeAt = now;
+}
+
+void HoleEncoder::onPinChange() {
+    uint8_t level = axisReadReader(this->stepper->index);
+
+    if (level == this->readerLevel) {
+        return;
+    }
+
+    this->readerLevel = level;
+    this->countEdge(level);
+}
+
+unsigned long HoleEncoder::getEdgePeriod() {
+    unsigned long lastEdgeAt, edgePeriod;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        lastEdgeAt = this->lastEdgeAt;
+        edgePeriod = this->edgePeriod;
+    }
+
+    //no edge for much longer than last period, wheel is slowing down or stopped
+    unsigned long sinceLastEdge = micros() - lastEdgeAt;
+    if (sinceLastEdge > ENCODER_STALE_TIME || sinceLastEdge > 2 * edgePeriod) {
+        return 0;
+    }
+
+    return edgePeriod;
+}
@@ -0,0 +1,83 @@
+#ifndef HOLE_ENCODER_H
+#define HOLE_ENCODER_H
+
+#include <Arduino.h>
+
+#include "Pins.h"
+#include "StepGenerator.h"
+
+// edges closer than this are treated as sensor noise, us
+#define ENCODER_MIN_EDGE_INTERVAL 200
+// wheel is treated as stopped if no edge came for this time, us
+#define ENCODER_STALE_TIME 500000UL
+
+/**
+ * @brief Reader wheel driven by external interrupt on both edges of
+ * channel A (M_DIGITAL_READER, see Pins.h).
+ * Hole is counted on the same side of it in both directions: on rising
+ * edge going UP, where platform enters it, and on falling edge going
+ * DOWN, where platform leaves it through that side. So turning back
+ * inside a hole does not change the count.
+ * With channel B (M_DIGITAL_READER_B) connected direction is taken from its level
+ * on A edge, so wheel itself tells where it turns. Without it direction is
+ * taken from DIR level the step generator is actually driving, which is
+ * still correct while stepper ramps down after reversal.
+ *
+ * Every edge is timestamped, two last timestamps give current speed,
+ * and step position of stepper is stored with it for interpolation
+ * between edges (see PositionEstimator).
+ *
+ * Axis is the one of its stepper. Readers of axes 2-4 (M_DIGITAL_READER_2..4)
+ * have pin change interrupts, which come on both edges and are shared by
+ * pins of one port, so every encoder checks level of its own pin.
+ */
+class HoleEncoder {
+  public:
+    volatile int* passedHoles;
+    StepGenerator* stepper;
+
+    // micros() of last accepted edge and time passed since the one before it
+    volatile unsigned long lastEdgeAt = 0;
+    volatile unsigned long edgePeriod = 0;
+    // stepper position at last accepted edge and its direction, 1 UP, -1 DOWN
+    volatile long edgeStepPosition = 0;
+    volatile int8_t edgeDirection = 1;
+    // reader level seen by the last pin change interrupt, axes 2-4 only
+    uint8_t readerLevel = LOW;
+
+    HoleEncoder(volatile int* passedHoles, StepGenerator* stepper) {
+      this->passedHoles = passedHoles;
+      this->stepper = stepper;
+    }
+
+    /**
+     * @brief configures pins and enables external interrupt of channel A,
+     * or pin change interrupt of reader for axes 2-4
+     */
+    void begin();
+
+    /**
+     * @brief needs to be called from ISR(INT0_vect) or ISR(INT1_vect), depends on channel A pin
+     */
+    void onEdge();
+
+    /**
+     * @brief needs to be called from ISR(PCINTx_vect) of reader port, axes 2-4 only
+     */
+    void onPinChange();
+
+    /**
+     * @brief time between two last edges
+     *
+     * @return unsigned long us, 0 when wheel is stopped
+     */
+    unsigned long getEdgePeriod();
+
+  private:
+    /**
+     * @param level reader level after the edge
+     */
+    void countEdge(uint8_t level);
+};
+
+#endif
@@ -0,0 +1,122 @@
+#include "HomingCycle.h"
+#include "FastGpio.h"
+
+void HomingCycle::begin() {
+#if ENDSTOP != ENDSTOP_NO_PIN
+    FastPin<ENDSTOP>::setInputPullup();
+#endif
+}
+
+bool HomingCycle::start() {
+    if (this->isActive() == true) {
+        return false;
+    }
+
+    this->elapsedTicks = 0;
+    this->approach(this->fastSpeed, HOMING_FAST);
+    return true;
+}
+
+void HomingCycle::cancel() {
+    if (this->isActive() == false) {
+        return;
+    }
+
+    this->stepper->stop();
+    this->stepper->setMaxSpeed(this->fastSpeed);
+    this->state = HOMING_IDLE;
+}
+
+bool HomingCycle::tick() {
+    if (this->isActive() == false) {
+        return false;
+    }
+
+    this->elapsedTicks += 1;
+    if (this->elapsedTicks > (unsigned long)HOMING_TIMEOUT * this->ticksPerSecond) {
+        this->cancel();
+        this->state = HOMING_FAILED;
+        return false;
+    }
+
+    switch (this->state)
+    {
+    case HOMING_FAST:
+        if (this->isReferenceReached() == true) {
+            this->stepper->halt();
+            this->state = HOMING_BACK_OFF;
+            //UP, negative steps
+            this->stepper->move(-this->getHoleSteps(HOMING_BACK_OFF_HOLES) - this->backlashSteps);
+        }
+        break;
+
+    case HOMING_BACK_OFF:
+        if (this->stepper->isRunning() == false) {
+            this->approach(this->slowSpeed, HOMING_SLOW);
+        }
+        break;
+
+    case HOMING_SLOW:
+        if (this->isReferenceReached() == true) {
+            //slow speed is below start-stop speed, no steps are lost
+            this->stepper->halt();
+            this->finish();
+            return true;
+        }
+        break;
+    }
+
+    return false;
+}
+
+void HomingCycle::approach(unsigned int speed, uint8_t state) {
+    this->state = state;
+    this->stepper->setMaxSpeed(speed);
+    this->stepper->run(HOMING_DIRECTION);
+    this->watchHoles = *this->passedHoles;
+    this->watchPosition = this->stepper->position;
+}
+
+bool HomingCycle::isReferenceReached() {
+#if ENDSTOP != ENDSTOP_NO_PIN
+    return FastPin<ENDSTOP>::read() == ENDSTOP_ACTIVE_LEVEL;
+#else
+    if (*this->passedHoles != this->watchHoles) {
+        this->watchHoles = *this->passedHoles;
+        this->watchPosition = this->stepper->position;
+        return false;
+    }
+
+    //first steps after reversal only take up backlash
+    return labs(this->stepper->position - this->watchPosition) >
+        this->getHoleSteps(HOMING_STALL_HOLES) + this->backlashSteps;
+#endif
+}
+
+long HomingCycle::getHoleSteps(uint8_t holes) {
+    if (this->estimator->stepsPerHole == 0) {
+        return (long)holes * HOMING_DEFAULT_STEPS_PER_HOLE;
+    }
+
+    return ((long)holes * this->estimator->stepsPerHole) >> 8;
+}
+
+void HomingCycle::finish() {
+    long deviation = *this->passedHoles * this->estimator->umPerHole;
+
+    //hole count starts from reference, interpolation starts from here
+    *this->passedHoles = 0;
+    this->estimator->encoder->edgeStepPosition = this->stepper->position;
+    this->stepper->setMaxSpeed(this->fastSpeed);
+
+    //the first homing measures zero restored from EEPROM, not the reference
+    if (this->runs > 0 && labs(deviation) > this->deviationSpread) {
+        this->deviationSpread = labs(deviation);
+    }
+    if (this->runs < 0xFF) {
+        this->runs += 1;
+    }
+    this->lastDeviation = deviation;
+    this->lastTime = this->elapsedTicks * 1000 / this->ticksPerSecond;
+    this->state = HOMING_DONE;
+}
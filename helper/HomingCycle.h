@@ -0,0 +1,129 @@
+#ifndef HOMING_CYCLE_H
+#define HOMING_CYCLE_H
+
+#include <Arduino.h>
+
+#include "Pins.h"
+#include "StepGenerator.h"
+#include "PositionEstimator.h"
+
+// homing states
+#define HOMING_IDLE 0
+#define HOMING_FAST 1
+#define HOMING_BACK_OFF 2
+#define HOMING_SLOW 3
+#define HOMING_DONE 4
+#define HOMING_FAILED 5
+
+// reference is at the bottom, DOWN is driven by HIGH level of DIR
+#define HOMING_DIRECTION HIGH
+// holes left after reference is hit at fast speed, approached again slowly
+#define HOMING_BACK_OFF_HOLES 3
+// wheel stands still while stepper makes steps of this many holes - reference is hit
+#define HOMING_STALL_HOLES 2
+// used while steps per hole ratio is not learned yet
+#define HOMING_DEFAULT_STEPS_PER_HOLE 100
+// homing is abandoned if reference is not found in this time, s
+#define HOMING_TIMEOUT 60
+
+/**
+ * @brief Automatic zero calibration: fast approach to reference at the
+ * bottom, back off by HOMING_BACK_OFF_HOLES, slow approach again and
+ * zero is set on the second contact, so it does not depend on speed.
+ *
+ * Reference is ENDSTOP input if it is connected (see Pins.h), otherwise
+ * platform stopped by hard stop: stepper makes HOMING_STALL_HOLES worth
+ * of steps and no new hole comes from the wheel.
+ *
+ * Time of every homing and distance between old and new zero are kept.
+ * The first distance shows how far zero restored from EEPROM was,
+ * the next ones show repeatability of the reference.
+ *
+ * tick() is called from control ISR, other methods from loop() with
+ * interrupts disabled.
+ */
+class HomingCycle {
+  public:
+    StepGenerator* stepper;
+    PositionEstimator* estimator;
+    volatile int* passedHoles;
+    unsigned int ticksPerSecond;
+    unsigned int fastSpeed;
+    unsigned int slowSpeed;
+    unsigned int backlashSteps = 0;
+
+    volatile uint8_t state = HOMING_IDLE;
+    unsigned long elapsedTicks = 0;
+    // hole count and step position when the last hole came, stall detection
+    int watchHoles = 0;
+    long watchPosition = 0;
+
+    // results
+    uint8_t runs = 0;
+    // duration of the last homing, ms
+    unsigned long lastTime = 0;
+    // position of old zero above reference, um
+    long lastDeviation = 0;
+    // the biggest deviation of repeated homings, um
+    long deviationSpread = 0;
+
+    HomingCycle(StepGenerator* stepper, PositionEstimator* estimator, unsigned int ticksPerSecond) {
+      this->stepper = stepper;
+      this->estimator = estimator;
+      this->passedHoles = estimator->passedHoles;
+      this->ticksPerSecond = ticksPerSecond;
+    }
+
+    /**
+     * @brief homes another axis from now on, called while homing is not active
+     */
+    void setAxis(StepGenerator* stepper, PositionEstimator* estimator) {
+      this->stepper = stepper;
+      this->estimator = estimator;
+      this->passedHoles = estimator->passedHoles;
+    }
+
+    /**
+     * @param fastSpeed speed of the first approach and back off, steps per second
+     * @param slowSpeed speed of the second approach
+     */
+    void setSpeeds(unsigned int fastSpeed, unsigned int slowSpeed) {
+      this->fastSpeed = fastSpeed;
+      this->slowSpeed = slowSpeed;
+    }
+
+    /**
+     * @brief configures endstop pin, if it is connected
+     */
+    void begin();
+
+    /**
+     * @return false if homing is running already
+     */
+    bool start();
+
+    /**
+     * @brief abandons homing, stepper decelerates to rest
+     */
+    void cancel();
+
+    bool isActive() {
+      return this->state == HOMING_FAST || this->state == HOMING_BACK_OFF || this->state == HOMING_SLOW;
+    }
+
+    /**
+     * @brief drives homing, needs to be called on every control tick
+     * instead of other stepper supervision while homing is active
+     *
+     * @return true on the tick zero is set
+     */
+    bool tick();
+
+  private:
+    void approach(unsigned int speed, uint8_t state);
+    bool isReferenceReached();
+    long getHoleSteps(uint8_t holes);
+    void finish();
+};
+
+#endif
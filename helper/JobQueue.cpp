@@ -0,0 +1,94 @@
+#include "JobQueue.h"
+
+//lower to load, raise to print height, print, lower to unload
+static const JobSegment defaultJob[] PROGMEM = {
+    {JOB_MOVE, 0},
+    {JOB_DWELL, 0},
+    {JOB_MOVE, 4200},
+    {JOB_DWELL, 10000},
+    {JOB_MOVE, 0},
+};
+
+void JobQueue::loadDefault() {
+    this->record.amount = sizeof(defaultJob) / sizeof(JobSegment);
+    memcpy_P(this->record.segments, defaultJob, sizeof(defaultJob));
+}
+
+bool JobQueue::start() {
+    if (this->isRunning() == true || this->record.amount == 0) {
+        return false;
+    }
+
+    this->prepareMove(0);
+    this->startSegment(0);
+    return true;
+}
+
+void JobQueue::resume() {
+    if (this->state == JOB_PAUSED) {
+        this->startSegment(this->segmentIndex + 1);
+    }
+}
+
+void JobQueue::tick(bool isTargetReached) {
+    switch (this->state)
+    {
+    case JOB_MOVING:
+        if (isTargetReached == true) {
+            break;
+        }
+        //stopped short of target, stopped move is not a finished one
+        if (*this->isStepperRunning == false) {
+            this->state = JOB_IDLE;
+        }
+        return;
+
+    case JOB_DWELLING:
+        if (this->remainingTicks > 0) {
+            this->remainingTicks -= 1;
+            return;
+        }
+        break;
+
+    default:
+        return;
+    }
+
+    this->startSegment(this->segmentIndex + 1);
+}
+
+void JobQueue::startSegment(uint8_t index) {
+    if (index >= this->record.amount) {
+        this->state = JOB_IDLE;
+        return;
+    }
+
+    JobSegment &segment = this->record.segments[index];
+    this->segmentIndex = index;
+
+    if (segment.type == JOB_MOVE) {
+        *this->targetPassedHoles = this->nextHoles;
+        *this->targetRemainder = this->nextRemainder;
+        *this->isStepperRunning = true;
+        this->state = JOB_MOVING;
+        this->prepareMove(index + 1);
+        return;
+    }
+
+    if (segment.value == 0) {
+        this->state = JOB_PAUSED;
+    } else {
+        this->remainingTicks = segment.value * this->ticksPerSecond / 1000;
+        this->state = JOB_DWELLING;
+    }
+}
+
+void JobQueue::prepareMove(uint8_t fromIndex) {
+    for (uint8_t i = fromIndex; i < this->record.amount; i++) {
+        if (this->record.segments[i].type == JOB_MOVE) {
+            this->nextHoles = this->record.segments[i].value / this->umPerHole;
+            this->nextRemainder = this->record.segments[i].value % this->umPerHole;
+            return;
+        }
+    }
+}
@@ -0,0 +1,122 @@
+#ifndef JOB_QUEUE_H
+#define JOB_QUEUE_H
+
+#include <Arduino.h>
+
+// segment types
+#define JOB_MOVE 0 // value is height, um
+#define JOB_DWELL 1 // value is time, ms, 0 - wait for resume()
+
+#define JOB_MAX_SEGMENTS 10
+#define JOB_MAX_DWELL 600000L //ms
+
+// queue states
+#define JOB_IDLE 0
+#define JOB_MOVING 1
+#define JOB_DWELLING 2
+#define JOB_PAUSED 3
+
+// fixed width and packed, EEPROM layout is the same in host build
+struct __attribute__((packed)) JobSegment {
+  uint8_t type;
+  int32_t value;
+};
+
+// job as it is stored in EEPROM, see JobStore
+struct __attribute__((packed)) JobRecord {
+  uint8_t sequence;
+  uint8_t amount;
+  JobSegment segments[JOB_MAX_SEGMENTS];
+  uint8_t crc;
+};
+
+/**
+ * @brief Runs segments of job (print cycle) back to back.
+ * Moves are made by position controller through the same target
+ * variables as semi-auto and template windows, so job window has to
+ * keep STOP_ON_TARGET mode. Next segment is started on the very control
+ * tick previous one ends, target of next move is split into holes while
+ * previous segment runs.
+ *
+ * Move ends only when position controller reports its target reached,
+ * any other stop of the stepper (user, slip) cancels the job. Platform
+ * stops between two moves: every move target is a height the platen has
+ * to stand at (load, print, unload) and the controller lands on it hole
+ * exact, so moves are not blended.
+ *
+ * tick() is called from control ISR, other methods from loop() with
+ * interrupts disabled.
+ */
+class JobQueue {
+  public:
+    JobRecord record;
+
+    volatile uint8_t state = JOB_IDLE;
+    volatile uint8_t segmentIndex = 0;
+    volatile unsigned long remainingTicks = 0;
+
+    volatile int* targetPassedHoles;
+    volatile long* targetRemainder;
+    volatile bool* isStepperRunning;
+    long umPerHole;
+    unsigned int ticksPerSecond;
+
+    // target of next move, prepared in advance
+    int nextHoles = 0;
+    long nextRemainder = 0;
+
+    JobQueue(
+      volatile int* targetPassedHoles,
+      volatile long* targetRemainder,
+      volatile bool* isStepperRunning,
+      unsigned int ticksPerSecond) {
+        this->targetPassedHoles = targetPassedHoles;
+        this->targetRemainder = targetRemainder;
+        this->isStepperRunning = isStepperRunning;
+        this->ticksPerSecond = ticksPerSecond;
+        this->record.sequence = 0;
+        this->record.amount = 0;
+      }
+
+    void setUMPerHole(long umPerHole) {
+      this->umPerHole = umPerHole;
+    };
+
+    /**
+     * @brief replaces job by default print cycle, used when EEPROM has no valid job
+     */
+    void loadDefault();
+
+    /**
+     * @brief starts job from the first segment
+     *
+     * @return false if job is empty or is running already
+     */
+    bool start();
+
+    /**
+     * @brief continues job paused by dwell segment without time
+     */
+    void resume();
+
+    void cancel() {
+      this->state = JOB_IDLE;
+    }
+
+    bool isRunning() {
+      return this->state != JOB_IDLE;
+    }
+
+    /**
+     * @brief advances job, needs to be called on every control tick after stepper supervision
+     *
+     * @param isTargetReached position controller reached target on this tick
+     */
+    void tick(bool isTargetReached);
+
+  private:
+    void startSegment(uint8_t index);
+    void prepareMove(uint8_t fromIndex);
+};
+
+#endif
@@ -0,0 +1,48 @@
+#include <EEPROM.h>
+
+#include "JobStore.h"
+#include "Crc8.h"
+
+bool JobStore::readRecord(uint8_t slot, JobRecord &record) {
+    EEPROM.get(this->getAddress(slot), record);
+
+    return record.amount <= JOB_MAX_SEGMENTS &&
+        crc8((uint8_t*)&record, offsetof(JobRecord, crc)) == record.crc;
+}
+
+bool JobStore::begin(JobRecord &record) {
+    JobRecord first;
+    JobRecord second;
+    bool isFirstValid = this->readRecord(0, first);
+    bool isSecondValid = this->readRecord(1, second);
+
+    //sequence wraps around, so compare by difference
+    if (isSecondValid == true &&
+        (isFirstValid == false || (int8_t)(second.sequence - first.sequence) > 0)) {
+        record = second;
+        this->lastSlot = 1;
+        return true;
+    }
+
+    if (isFirstValid == true) {
+        record = first;
+        this->lastSlot = 0;
+        return true;
+    }
+
+    return false;
+}
+
+bool JobStore::save(JobRecord &record) {
+    if (this->isBusy() == true) {
+        return false;
+    }
+
+    this->lastSlot = this->lastSlot == 0 ? 1 : 0;
+    record.sequence += 1;
+    record.crc = crc8((uint8_t*)&record, offsetof(JobRecord, crc));
+
+    this->writer.start(this->getAddress(this->lastSlot), &record, sizeof(JobRecord));
+
+    return true;
+}
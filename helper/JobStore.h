@@ -0,0 +1,64 @@
+#ifndef JOB_STORE_H
+#define JOB_STORE_H
+
+#include <Arduino.h>
+
+#include "JobQueue.h"
+#include "EepromRecordWriter.h"
+
+// EEPROM area used by job, [start; end), between motion settings and template table
+#define JOB_STORE_START 384
+#define JOB_STORE_END 512
+
+/**
+ * @brief Job storage with two copies of JobRecord.
+ * Every save goes to the copy which is not the newest one, so record
+ * torn by power loss leaves the previous version of job valid. Copies
+ * are sequence-numbered and CRC protected.
+ *
+ * Saved record is written from itself by EepromRecordWriter, it must not
+ * change until isBusy() is false.
+ */
+class JobStore {
+  public:
+    // copy which holds the newest record
+    uint8_t lastSlot = 1;
+
+    EepromRecordWriter writer;
+
+    /**
+     * @brief reads the newest valid copy, needs to be called once in setup()
+     *
+     * @param record filled with job, left untouched if there is no valid copy
+     * @return true if valid copy was found
+     */
+    bool begin(JobRecord &record);
+
+    /**
+     * @brief schedules record writing, its sequence and crc are updated here
+     *
+     * @return false if previous record is still being written
+     */
+    bool save(JobRecord &record);
+
+    /**
+     * @brief writes next byte of scheduled record if EEPROM is ready,
+     * needs to be called on every loop() pass
+     */
+    void service() {
+      this->writer.service();
+    }
+
+    bool isBusy() {
+      return this->writer.isBusy();
+    }
+
+  private:
+    int getAddress(uint8_t slot) {
+      return JOB_STORE_START + slot * sizeof(JobRecord);
+    }
+
+    bool readRecord(uint8_t slot, JobRecord &record);
+};
+
+#endif
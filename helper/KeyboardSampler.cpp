@@ -0,0 +1,93 @@
+#include "KeyboardSampler.h"
+
+// matched from first to last
+const ButtonThreshold buttonThresholds[] PROGMEM = {
+    {BUTTON_BACK, BUTTON_BACK_C},
+    {BUTTON_SELECT, BUTTON_SELECT_C},
+    {BUTTON_LEFT, BUTTON_LEFT_C},
+    {BUTTON_RIGHT, BUTTON_RIGHT_C},
+};
+
+#define BUTTONS_AMOUNT (sizeof(buttonThresholds) / sizeof(ButtonThreshold))
+
+/**
+ * @brief is analog signal value meets requirements + - borderWindowValue to buttonsAnalogReaderValue
+ * Example: incoming analog signal = 85, BUTTON_BACK value = 82, border value = 10,
+ * if 85-10 < 82 > 85 + 10, return = true
+ *
+ * @param buttonsAnalogReaderValue incoming value from analog read input
+ * @param buttonDefinedValue predefined button value. Example: #defined BUTTON_BACK = 82
+ * @param borderWindowValue acceptable window for incoming signal error
+ * @return true
+ * @return false
+ */
+static bool isButtonSignalPassed(int buttonsAnalogReaderValue, int buttonDefinedValue, int borderWindowValue)
+{
+    return buttonsAnalogReaderValue > (buttonDefinedValue - borderWindowValue) &&
+        buttonsAnalogReaderValue < (buttonDefinedValue + borderWindowValue);
+}
+
+int getPressedButtonCode(int buttonsAnalogReaderValue, int pressedButtonCode)
+{
+    for (uint8_t i = 0; i < BUTTONS_AMOUNT; i++) {
+        int value = pgm_read_word(&buttonThresholds[i].value);
+        int code = pgm_read_word(&buttonThresholds[i].code);
+        int window = code == pressedButtonCode ? 
+            BUTTONS_VALUES_WINDOW + BUTTONS_HYSTERESIS : 
+            BUTTONS_VALUES_WINDOW;
+
+        if (isButtonSignalPassed(buttonsAnalogReaderValue, value, window)) {
+            return code;
+        }
+    }
+
+    return -1;
+}
+
+void KeyboardSampler::begin() {
+    //AVcc reference, keyboard channel
+    ADMUX = _BV(REFS0) | ((this->pin - A0) & 0x07);
+    //conversion is started by Timer0 overflow (millis() timer)
+    ADCSRB = _BV(ADTS2);
+    //prescaler 128, auto trigger, interrupt
+    ADCSRA = _BV(ADEN) | _BV(ADATE) | _BV(ADIE) | _BV(ADPS2) | _BV(ADPS1) | _BV(ADPS0);
+}
+
+void KeyboardSampler::onSample(int value) {
+    this->samples[this->sampleIndex] = value;
+    this->sampleIndex = this->sampleIndex == 2 ? 0 : this->sampleIndex + 1;
+
+    //median of 3
+    int a = this->samples[0], b = this->samples[1], c = this->samples[2];
+    this->filteredValue = max(min(a, b), min(max(a, b), c));
+
+    int code = getPressedButtonCode(this->filteredValue, this->pressedCode);
+
+    if (code != this->candidateCode) {
+        this->candidateCode = code;
+        this->candidateSamples = 0;
+    } else if (this->candidateSamples < KEY_DEBOUNCE_SAMPLES) {
+        this->candidateSamples += 1;
+
+        if (this->candidateSamples == KEY_DEBOUNCE_SAMPLES && code != this->pressedCode) {
+            if (this->pressedCode != -1) {
+                this->pushEvent(this->pressedCode, KEY_RELEASE);
+            }
+
+            if (code != -1) {
+                this->pushEvent(code, KEY_PRESS);
+                this->pressedAt = millis();
+                this->isHoldSent = false;
+            }
+
+            this->pressedCode = code;
+        }
+    }
+
+    if (this->pressedCode != -1 && 
+        this->isHoldSent == false && 
+        millis() - this->pressedAt >= KEY_HOLD_TIME) {
+        this->pushEvent(this->pressedCode, KEY_HOLD);
+        this->isHoldSent = true;
+    }
+}
@@ -0,0 +1,118 @@
+#ifndef KEYBOARD_SAMPLER_H
+#define KEYBOARD_SAMPLER_H
+
+#include <Arduino.h>
+
+#include "RingBuffer.h"
+
+#define BUTTONS_VALUES_WINDOW 100
+// pressed button is held while signal stays in window widened by this value
+#define BUTTONS_HYSTERESIS 20
+
+// buttons analog values
+#define BUTTON_BACK 1010
+#define BUTTON_SELECT 715
+#define BUTTON_LEFT 466
+#define BUTTON_RIGHT 238
+
+// buttons codes
+#define BUTTON_BACK_C 1
+#define BUTTON_SELECT_C 2
+#define BUTTON_LEFT_C 3
+#define BUTTON_RIGHT_C 4
+
+// key event types
+#define KEY_PRESS 0
+#define KEY_RELEASE 1
+#define KEY_HOLD 2
+
+// samples in a row (~1 ms each) with same button before press or release is accepted
+#define KEY_DEBOUNCE_SAMPLES 20
+// how long button has to be pressed to send KEY_HOLD, ms
+#define KEY_HOLD_TIME 1000
+// must be power of 2
+#define KEY_EVENT_QUEUE_SIZE 8
+
+struct ButtonThreshold {
+  int value;
+  int code;
+};
+
+struct KeyEvent {
+  int code;
+  uint8_t type;
+};
+
+/**
+ * @brief Get the Pressed Button Code object
+ *
+ * @param buttonsAnalogReaderValue analog keyboard input value
+ * @param pressedButtonCode currently pressed button, its window is widened by BUTTONS_HYSTERESIS
+ * @return int, predefined button code values. If -1, no button pressed
+ */
+int getPressedButtonCode(int buttonsAnalogReaderValue, int pressedButtonCode = -1);
+
+/**
+ * @brief Free-running keyboard reader.
+ * ADC converts keyboard pin on every Timer0 overflow (~1 kHz) by itself,
+ * ISR(ADC_vect) only takes the result: median of 3 last samples is
+ * matched against buttons table, and debounced button changes are put
+ * into event queue as press, release and hold events.
+ */
+class KeyboardSampler {
+  public:
+    uint8_t pin;
+
+    int samples[3] = {0, 0, 0};
+    uint8_t sampleIndex = 0;
+    volatile int filteredValue = 0;
+
+    // debounce state machine
+    int candidateCode = -1;
+    uint8_t candidateSamples = 0;
+    int pressedCode = -1;
+    unsigned long pressedAt = 0;
+    bool isHoldSent = false;
+
+    // filled by ISR(ADC_vect), drained by loop()
+    RingBuffer<KeyEvent, KEY_EVENT_QUEUE_SIZE> events;
+
+    KeyboardSampler(uint8_t pin) {
+      this->pin = pin;
+    }
+
+    /**
+     * @brief starts auto-triggered conversions of keyboard pin
+     */
+    void begin();
+
+    /**
+     * @brief takes next key event
+     *
+     * @param event filled if queue is not empty
+     * @return true if event was taken
+     */
+    bool popEvent(KeyEvent &event) {
+      return this->events.pop(event);
+    }
+
+    /**
+     * @brief filtered analog value, for keyboard calibration
+     */
+    int getFilteredValue() {
+      return this->filteredValue;
+    }
+
+    /**
+     * @brief needs to be called from ISR(ADC_vect)
+     */
+    void onSample(int value);
+
+  private:
+    void pushEvent(int code, uint8_t type) {
+      KeyEvent event = {code, type};
+      this->events.push(event);
+    }
+};
+
+#endif
@@ -0,0 +1,65 @@
+#include "MenuGraph.h"
+
+static const char mainMenuTitle[] PROGMEM = "Main menu";
+static const char screenSaverTitle[] PROGMEM = "Screen saver";
+static const char engineControlTitle[] PROGMEM = "Engine control";
+static const char manualModeMenuTitle[] PROGMEM = "Manual control";
+static const char manualModeWindowTitle[] PROGMEM = "Manual control window";
+static const char semiAutoModeMenuTitle[] PROGMEM = "Semi-auto control";
+static const char semiAutoModeWindowTitle[] PROGMEM = "Semi-auto control window";
+static const char templatesMenuTitle[] PROGMEM = "Templates";
+static const char templateWindowTitle[] PROGMEM = "Template window";
+static const char templateEditorMenuTitle[] PROGMEM = "Template editor";
+static const char templateEditorWindowTitle[] PROGMEM = "Template editor window";
+static const char jobMenuTitle[] PROGMEM = "Job";
+static const char jobWindowTitle[] PROGMEM = "Job window";
+static const char jobEditorMenuTitle[] PROGMEM = "Job editor";
+static const char jobEditorWindowTitle[] PROGMEM = "Job editor window";
+static const char calibrationMenuTitle[] PROGMEM = "Calibration";
+static const char zeroMenuTitle[] PROGMEM = "Manual zero";
+static const char calibrationWindowTitle[] PROGMEM = "Calibration window";
+static const char homingMenuTitle[] PROGMEM = "Auto homing";
+static const char homingWindowTitle[] PROGMEM = "Homing window";
+static const char tuningMenuTitle[] PROGMEM = "Speed autotune";
+static const char tuningWindowTitle[] PROGMEM = "Autotune window";
+static const char axisMenuTitle[] PROGMEM = "Axis";
+static const char axisWindowTitle[] PROGMEM = "Axis window";
+static const char diagnosticsWindowTitle[] PROGMEM = "Diagnostics";
+
+//screen saver neighbours are not used, it returns to the window it covered.
+//Diagnostics is hidden, it is opened by BACK on main screen.
+//Templates are paged by template window itself, see TemplateTable.h
+const MenuNode menuGraph[MENU_WINDOWS_AMOUNT] PROGMEM = {
+    //title, kind, number, amount, BACK, SELECT, LEFT, RIGHT, parameter
+    {mainMenuTitle, WINDOW_MAIN, 0, 0, W_DIAGNOSTICS, W_ENGINE_CONTROL, W_ENGINE_CONTROL, W_ENGINE_CONTROL, 0},
+    {screenSaverTitle, WINDOW_SCREEN_SAVER, 0, 0, W_NONE, W_NONE, W_NONE, W_NONE, 0},
+
+    {engineControlTitle, WINDOW_MENU, 1, 7, W_MAIN, W_MANUAL_MENU, W_AXIS_MENU, W_TEMPLATES, 0},
+    {manualModeMenuTitle, WINDOW_MENU, 1, 2, W_ENGINE_CONTROL, W_MANUAL, W_SEMI_AUTO_MENU, W_SEMI_AUTO_MENU, 0},
+    {manualModeWindowTitle, WINDOW_MANUAL, 0, 0, W_MANUAL_MENU, W_NONE, W_NONE, W_NONE, 0},
+    {semiAutoModeMenuTitle, WINDOW_MENU, 2, 2, W_ENGINE_CONTROL, W_SEMI_AUTO, W_MANUAL_MENU, W_MANUAL_MENU, 0},
+    {semiAutoModeWindowTitle, WINDOW_SEMI_AUTO, 0, 0, W_SEMI_AUTO_MENU, W_NONE, W_NONE, W_NONE, 0},
+
+    {templatesMenuTitle, WINDOW_MENU, 2, 7, W_MAIN, W_TEMPLATE, W_ENGINE_CONTROL, W_TEMPLATE_EDITOR_MENU, 0},
+    {templateWindowTitle, WINDOW_TEMPLATE, 0, 0, W_TEMPLATES, W_NONE, W_NONE, W_NONE, TEMPLATE_MODE_RUN},
+    {templateEditorMenuTitle, WINDOW_MENU, 3, 7, W_MAIN, W_TEMPLATE_EDITOR, W_TEMPLATES, W_JOB_MENU, 0},
+    {templateEditorWindowTitle, WINDOW_TEMPLATE, 0, 0, W_TEMPLATE_EDITOR_MENU, W_NONE, W_NONE, W_NONE, TEMPLATE_MODE_EDIT},
+
+    {jobMenuTitle, WINDOW_MENU, 4, 7, W_MAIN, W_JOB, W_TEMPLATE_EDITOR_MENU, W_JOB_EDITOR_MENU, 0},
+    {jobWindowTitle, WINDOW_JOB, 0, 0, W_JOB_MENU, W_NONE, W_NONE, W_NONE, JOB_MODE_RUN},
+    {jobEditorMenuTitle, WINDOW_MENU, 5, 7, W_MAIN, W_JOB_EDITOR, W_JOB_MENU, W_CALIBRATION_MENU, 0},
+    {jobEditorWindowTitle, WINDOW_JOB, 0, 0, W_JOB_EDITOR_MENU, W_NONE, W_NONE, W_NONE, JOB_MODE_EDIT},
+
+    {calibrationMenuTitle, WINDOW_MENU, 6, 7, W_MAIN, W_HOMING_MENU, W_JOB_EDITOR_MENU, W_AXIS_MENU, 0},
+    {zeroMenuTitle, WINDOW_MENU, 2, 3, W_CALIBRATION_MENU, W_CALIBRATION, W_HOMING_MENU, W_TUNING_MENU, 0},
+    {calibrationWindowTitle, WINDOW_CALIBRATION, 0, 0, W_ZERO_MENU, W_NONE, W_NONE, W_NONE, CALIBRATION_MODE_MANUAL},
+    {homingMenuTitle, WINDOW_MENU, 1, 3, W_CALIBRATION_MENU, W_HOMING, W_TUNING_MENU, W_ZERO_MENU, 0},
+    {homingWindowTitle, WINDOW_CALIBRATION, 0, 0, W_HOMING_MENU, W_NONE, W_NONE, W_NONE, CALIBRATION_MODE_HOMING},
+    {tuningMenuTitle, WINDOW_MENU, 3, 3, W_CALIBRATION_MENU, W_TUNING, W_ZERO_MENU, W_HOMING_MENU, 0},
+    {tuningWindowTitle, WINDOW_CALIBRATION, 0, 0, W_TUNING_MENU, W_NONE, W_NONE, W_NONE, CALIBRATION_MODE_TUNING},
+
+    {axisMenuTitle, WINDOW_MENU, 7, 7, W_MAIN, W_AXIS, W_CALIBRATION_MENU, W_ENGINE_CONTROL, 0},
+    {axisWindowTitle, WINDOW_AXIS, 0, 0, W_AXIS_MENU, W_NONE, W_NONE, W_NONE, 0},
+
+    {diagnosticsWindowTitle, WINDOW_DIAGNOSTICS, 0, 0, W_MAIN, W_NONE, W_NONE, W_NONE, 0},
+};
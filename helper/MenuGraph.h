@@ -0,0 +1,89 @@
+#ifndef MENU_GRAPH_H
+#define MENU_GRAPH_H
+
+#include <Arduino.h>
+#include <avr/pgmspace.h>
+
+// window kinds, every kind has one behaviour object (see AnalogKeyboard.h)
+#define WINDOW_MENU 0
+#define WINDOW_MAIN 1
+#define WINDOW_SCREEN_SAVER 2
+#define WINDOW_MANUAL 3
+#define WINDOW_SEMI_AUTO 4
+#define WINDOW_TEMPLATE 5
+#define WINDOW_CALIBRATION 6
+#define WINDOW_DIAGNOSTICS 7
+#define WINDOW_JOB 8
+#define WINDOW_AXIS 9
+
+// window ids, index of node in menuGraph
+#define W_MAIN 0
+#define W_SCREEN_SAVER 1
+#define W_ENGINE_CONTROL 2
+#define W_MANUAL_MENU 3
+#define W_MANUAL 4
+#define W_SEMI_AUTO_MENU 5
+#define W_SEMI_AUTO 6
+#define W_TEMPLATES 7
+#define W_TEMPLATE 8
+#define W_TEMPLATE_EDITOR_MENU 9
+#define W_TEMPLATE_EDITOR 10
+#define W_JOB_MENU 11
+#define W_JOB 12
+#define W_JOB_EDITOR_MENU 13
+#define W_JOB_EDITOR 14
+#define W_CALIBRATION_MENU 15
+#define W_ZERO_MENU 16
+#define W_CALIBRATION 17
+#define W_HOMING_MENU 18
+#define W_HOMING 19
+#define W_TUNING_MENU 20
+#define W_TUNING 21
+#define W_AXIS_MENU 22
+#define W_AXIS 23
+#define W_DIAGNOSTICS 24
+#define MENU_WINDOWS_AMOUNT 25
+
+// parameter of WINDOW_TEMPLATE windows
+#define TEMPLATE_MODE_RUN 0
+#define TEMPLATE_MODE_EDIT 1
+
+// parameter of WINDOW_JOB windows
+#define JOB_MODE_RUN 0
+#define JOB_MODE_EDIT 1
+
+// parameter of WINDOW_CALIBRATION windows
+#define CALIBRATION_MODE_MANUAL 0
+#define CALIBRATION_MODE_HOMING 1
+#define CALIBRATION_MODE_TUNING 2
+
+// neighbour value when button does not change window
+#define W_NONE 0xFF
+
+/**
+ * @brief One window of menu, lives in flash.
+ * Neighbours are ids of windows opened by BACK, SELECT, LEFT and RIGHT
+ * buttons, parameter is kind specific (TEMPLATE_MODE_* for
+ * WINDOW_TEMPLATE, JOB_MODE_* for WINDOW_JOB, CALIBRATION_MODE_* for
+ * WINDOW_CALIBRATION)
+ */
+struct MenuNode {
+  const char* title;
+  uint8_t kind;
+  uint8_t windowNumber;
+  uint8_t amountOfWindowsOnCurrentLevel;
+  uint8_t higherLevelMenu;
+  uint8_t lowerLevelMenu;
+  uint8_t prevMenu;
+  uint8_t nextMenu;
+  uint8_t parameter;
+};
+
+extern const MenuNode menuGraph[MENU_WINDOWS_AMOUNT] PROGMEM;
+
+// reads one byte field of window node from flash
+#define MENU_NODE_BYTE(id, field) pgm_read_byte(&menuGraph[id].field)
+// title of window node, pointer to flash
+#define MENU_NODE_TITLE(id) ((const char*)pgm_read_ptr(&menuGraph[id].title))
+
+#endif
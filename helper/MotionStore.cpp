@@ -0,0 +1,35 @@
+#include <EEPROM.h>
+
+#include "MotionStore.h"
+#include "MotionTuner.h"
+#include "Crc8.h"
+
+bool MotionStore::begin(int &speed, int &acceleration) {
+    MotionRecord record;
+    EEPROM.get(MOTION_STORE_START, record);
+
+    if (record.mark != MOTION_STORE_MARK ||
+        crc8((uint8_t*)&record, offsetof(MotionRecord, crc)) != record.crc ||
+        record.speed == 0 || record.speed > TUNING_MAX_SPEED ||
+        record.acceleration == 0 || record.acceleration > TUNING_MAX_ACCELERATION) {
+        return false;
+    }
+
+    speed = record.speed;
+    acceleration = record.acceleration;
+    return true;
+}
+
+bool MotionStore::save(unsigned int speed, unsigned int acceleration) {
+    if (this->isBusy() == true) {
+        return false;
+    }
+
+    this->pendingRecord.mark = MOTION_STORE_MARK;
+    this->pendingRecord.speed = speed;
+    this->pendingRecord.acceleration = acceleration;
+    this->pendingRecord.crc = crc8((uint8_t*)&this->pendingRecord, offsetof(MotionRecord, crc));
+    this->writer.start(MOTION_STORE_START, &this->pendingRecord, sizeof(MotionRecord));
+
+    return true;
+}
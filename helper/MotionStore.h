@@ -0,0 +1,61 @@
+#ifndef MOTION_STORE_H
+#define MOTION_STORE_H
+
+#include <Arduino.h>
+
+#include "EepromRecordWriter.h"
+
+// EEPROM area used by motion settings, [start; end), between position journal and job
+#define MOTION_STORE_START 352
+#define MOTION_STORE_END 384
+
+// first byte of valid record, cells of older layouts never match it
+#define MOTION_STORE_MARK 0x4D
+
+struct __attribute__((packed)) MotionRecord {
+  uint8_t mark;
+  uint16_t speed; //steps per second
+  uint16_t acceleration; //steps per second^2
+  uint8_t crc;
+};
+
+/**
+ * @brief Speed and acceleration found by MotionTuner.
+ * One CRC protected copy: record torn by power loss is not loaded and
+ * built-in values are used, which are the safe ones.
+ */
+class MotionStore {
+  public:
+    MotionRecord pendingRecord;
+    EepromRecordWriter writer;
+
+    /**
+     * @brief reads stored settings, needs to be called once in setup()
+     *
+     * @param speed left untouched if there is no valid record
+     * @param acceleration left untouched if there is no valid record
+     * @return true if valid record was found
+     */
+    bool begin(int &speed, int &acceleration);
+
+    /**
+     * @brief schedules record writing
+     *
+     * @return false if previous record is still being written
+     */
+    bool save(unsigned int speed, unsigned int acceleration);
+
+    /**
+     * @brief writes next byte of scheduled record if EEPROM is ready,
+     * needs to be called on every loop() pass
+     */
+    void service() {
+      this->writer.service();
+    }
+
+    bool isBusy() {
+      return this->writer.isBusy();
+    }
+};
+
+#endif
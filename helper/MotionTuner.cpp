@@ -0,0 +1,179 @@
+#include <util/atomic.h>
+
+#include "MotionTuner.h"
+
+bool MotionTuner::start() {
+    if (this->isActive() == true || this->isMovePending == true || this->estimator->stepsPerHole == 0) {
+        return false;
+    }
+
+    //test moves go up and back, so there has to be room for overshoot below origin
+    this->origin = max(*this->passedHoles * this->estimator->umPerHole, TUNING_MIN_HEIGHT);
+    this->speed = this->baseSpeed;
+    this->acceleration = this->baseAcceleration;
+    this->passedSpeed = 0;
+    this->passedAcceleration = 0;
+    this->isReturning = false;
+    this->isSpeedSweepShort = false;
+    this->state = TUNING_SPEED;
+
+    if (this->startLevel() == false) {
+        this->state = TUNING_FAILED;
+        return false;
+    }
+    return true;
+}
+
+void MotionTuner::cancel() {
+    if (this->isActive() == false) {
+        return;
+    }
+
+    this->controller->cancel();
+    this->isMovePending = false;
+    this->isReturning = false;
+    this->state = TUNING_IDLE;
+}
+
+void MotionTuner::service() {
+    if (this->isMovePending == false) {
+        return;
+    }
+
+    //stepper is at rest, c0 is calculated here and not in control ISR
+    this->stepper->setAcceleration(this->moveAcceleration);
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        //tuning could be cancelled meanwhile
+        if (this->isMovePending == true) {
+            this->controller->setSpeeds(this->moveSpeed, this->approachSpeed);
+            this->controller->moveTo(this->moveTarget);
+            this->isMovePending = false;
+        }
+    }
+}
+
+bool MotionTuner::tick(bool isSlipped) {
+    if (this->isActive() == false || this->isMovePending == true) {
+        return false;
+    }
+
+    if (isSlipped == true) {
+        this->controller->cancel();
+        this->stepper->halt();
+
+        //passed level slips too, nothing is safe
+        if (this->isReturning == true) {
+            this->state = TUNING_FAILED;
+            return true;
+        }
+
+        this->isReturning = true;
+        if (this->passedSpeed == 0) {
+            this->requestMove(this->approachSpeed, this->baseAcceleration, this->origin);
+        } else {
+            this->requestMove(this->passedSpeed, this->passedAcceleration, this->origin);
+        }
+        return false;
+    }
+
+    if (this->controller->service() == false) {
+        return false;
+    }
+
+    if (this->isReturning == true) {
+        this->isReturning = false;
+        return this->nextPhase();
+    }
+
+    if (this->leg == 0) {
+        this->leg = 1;
+        this->controller->moveTo(this->origin);
+        return false;
+    }
+
+    this->passedSpeed = this->speed;
+    this->passedAcceleration = this->acceleration;
+    return this->nextLevel();
+}
+
+void MotionTuner::requestMove(unsigned int speed, unsigned int acceleration, long target) {
+    this->moveSpeed = speed;
+    this->moveAcceleration = acceleration;
+    this->moveTarget = target;
+    this->isMovePending = true;
+}
+
+bool MotionTuner::startLevel() {
+    long travel = this->getTravel();
+
+    if (travel > TUNING_MAX_TRAVEL) {
+        return false;
+    }
+
+    this->leg = 0;
+    this->requestMove(this->speed, this->acceleration, this->origin + travel);
+    return true;
+}
+
+bool MotionTuner::nextLevel() {
+    if (this->state == TUNING_SPEED) {
+        if (this->speed >= TUNING_MAX_SPEED) {
+            return this->nextPhase();
+        }
+        this->speed = min(this->speed + max(this->speed >> TUNING_LEVEL_SHIFT, 1U), TUNING_MAX_SPEED);
+    } else {
+        if (this->acceleration >= TUNING_MAX_ACCELERATION) {
+            return this->nextPhase();
+        }
+        this->acceleration = min(this->acceleration + max(this->acceleration >> TUNING_LEVEL_SHIFT, 1U), TUNING_MAX_ACCELERATION);
+    }
+
+    if (this->startLevel() == false) {
+        this->isSpeedSweepShort = this->state == TUNING_SPEED;
+        return this->nextPhase();
+    }
+    return false;
+}
+
+bool MotionTuner::nextPhase() {
+    if (this->passedSpeed == 0) {
+        this->state = TUNING_FAILED;
+        return true;
+    }
+
+    if (this->state == TUNING_SPEED) {
+        this->state = TUNING_ACCELERATION;
+        this->speed = this->passedSpeed;
+        this->acceleration = this->passedAcceleration;
+        this->speedSweepAcceleration = this->passedAcceleration;
+        return this->nextLevel();
+    }
+
+    //higher acceleration makes ramps of higher speeds short enough
+    if (this->isSpeedSweepShort == true && this->passedAcceleration > this->speedSweepAcceleration) {
+        this->isSpeedSweepShort = false;
+        this->state = TUNING_SPEED;
+        this->speed = this->passedSpeed;
+        this->acceleration = this->passedAcceleration;
+        return this->nextLevel();
+    }
+
+    this->tunedSpeed = (unsigned long)this->passedSpeed * TUNING_MARGIN / 100;
+    this->tunedAcceleration = (unsigned long)this->passedAcceleration * TUNING_MARGIN / 100;
+    this->state = TUNING_DONE;
+    return true;
+}
+
+long MotionTuner::getTravel() {
+    //ramp up and down take v^2 / a steps together
+    unsigned long steps = (unsigned long)this->speed * this->speed / this->acceleration +
+        (unsigned long)this->speed * TUNING_CRUISE_TIME / 1000;
+
+    if (steps >= 0x800000UL) {
+        return TUNING_MAX_TRAVEL + 1;
+    }
+
+    long holes = (steps << 8) / this->estimator->stepsPerHole + 1 + POSITION_APPROACH_HOLES;
+    return holes * this->estimator->umPerHole;
+}
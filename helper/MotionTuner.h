@@ -0,0 +1,151 @@
+#ifndef MOTION_TUNER_H
+#define MOTION_TUNER_H
+
+#include <Arduino.h>
+
+#include "StepGenerator.h"
+#include "PositionEstimator.h"
+#include "PositionController.h"
+
+// tuner states
+#define TUNING_IDLE 0
+#define TUNING_SPEED 1
+#define TUNING_ACCELERATION 2
+#define TUNING_DONE 3
+#define TUNING_FAILED 4
+
+// every level is 1/2^shift above the previous one
+#define TUNING_LEVEL_SHIFT 3
+#define TUNING_MAX_SPEED 3000 //steps per second
+#define TUNING_MAX_ACCELERATION 3000 //steps per second^2
+// tuned values are this part of the highest passed level, %
+#define TUNING_MARGIN 80
+// test move cruises at level speed at least this long, ms
+#define TUNING_CRUISE_TIME 250
+// test moves go up from origin, it is not lower than this, um
+#define TUNING_MIN_HEIGHT 2000L
+// sweep ends at level which needs longer test move, um
+#define TUNING_MAX_TRAVEL 20000L
+
+/**
+ * @brief Finds the highest speed and acceleration the machine moves
+ * with without losing steps. Every level is a test move up from origin
+ * and back, long enough to ramp up, cruise TUNING_CRUISE_TIME and ramp
+ * down. First speed is raised at starting acceleration, then
+ * acceleration at the highest passed speed. Sweep ends on the first
+ * level SlipMonitor reports slip on, platform returns to origin at the
+ * last passed level then. Speed sweep which ended because its ramps
+ * did not fit TUNING_MAX_TRAVEL is continued after acceleration was
+ * raised. Tuned values keep TUNING_MARGIN of the highest passed ones.
+ *
+ * Moves are made by position controller, so origin is found by the
+ * wheel after slip. c0 of StepGenerator::setAcceleration() needs sqrt,
+ * so every move is configured and started from loop() by service(),
+ * control ISR only waits for its end in tick().
+ */
+class MotionTuner {
+  public:
+    PositionController* controller;
+    StepGenerator* stepper;
+    PositionEstimator* estimator;
+    volatile int* passedHoles;
+
+    // values tuning starts from, used while it is not active
+    unsigned int baseSpeed;
+    unsigned int baseAcceleration;
+    unsigned int approachSpeed;
+
+    volatile uint8_t state = TUNING_IDLE;
+    // level under test and the highest passed one
+    volatile unsigned int speed = 0;
+    volatile unsigned int acceleration = 0;
+    unsigned int passedSpeed = 0;
+    unsigned int passedAcceleration = 0;
+    // position test moves start and end at, um
+    long origin = 0;
+    // 0 going up, 1 going back to origin
+    uint8_t leg = 0;
+    // platform goes back to origin after slip
+    volatile bool isReturning = false;
+    // speed sweep ended on travel limit, and acceleration it was made at
+    bool isSpeedSweepShort = false;
+    unsigned int speedSweepAcceleration = 0;
+
+    // move which is configured and started by service()
+    volatile bool isMovePending = false;
+    unsigned int moveSpeed;
+    unsigned int moveAcceleration;
+    long moveTarget;
+
+    // results, valid in TUNING_DONE state
+    unsigned int tunedSpeed = 0;
+    unsigned int tunedAcceleration = 0;
+
+    MotionTuner(PositionController* controller) {
+      this->setAxis(controller);
+    }
+
+    /**
+     * @brief makes test moves with another axis from now on, called while
+     * tuning is not active
+     */
+    void setAxis(PositionController* controller) {
+      this->controller = controller;
+      this->stepper = controller->stepper;
+      this->estimator = controller->estimator;
+      this->passedHoles = controller->passedHoles;
+    }
+
+    /**
+     * @param speed current cruise speed, steps per second
+     * @param acceleration current acceleration, steps per second^2
+     * @param approachSpeed speed near target, is not tuned
+     */
+    void setSpeeds(unsigned int speed, unsigned int acceleration, unsigned int approachSpeed) {
+      this->baseSpeed = speed;
+      this->baseAcceleration = acceleration;
+      this->approachSpeed = approachSpeed;
+    }
+
+    /**
+     * @brief called from loop() with interrupts disabled
+     *
+     * @return false if tuning is running already, steps per hole ratio is
+     * not learned yet or starting level needs too long test move
+     */
+    bool start();
+
+    /**
+     * @brief abandons tuning, stepper decelerates to rest. Caller restores
+     * base speed and acceleration
+     */
+    void cancel();
+
+    bool isActive() {
+      return this->state == TUNING_SPEED || this->state == TUNING_ACCELERATION;
+    }
+
+    /**
+     * @brief configures and starts pending test move, needs to be called
+     * on every loop() pass
+     */
+    void service();
+
+    /**
+     * @brief drives tuning, needs to be called on every control tick
+     * instead of other stepper supervision while tuning is active
+     *
+     * @param isSlipped slip was detected on this tick
+     * @return true on the tick tuning ends, state is TUNING_DONE or TUNING_FAILED
+     */
+    bool tick(bool isSlipped);
+
+  private:
+    void requestMove(unsigned int speed, unsigned int acceleration, long target);
+    bool startLevel();
+    bool nextLevel();
+    bool nextPhase();
+    long getTravel();
+};
+
+#endif
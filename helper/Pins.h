@@ -0,0 +1,56 @@
+#ifndef PINS_H
+#define PINS_H
+
+#include <Arduino.h>
+
+// Wiring of the board. Pins are compile time constants, so modules drive
+// them directly through registers (see FastGpio.h)
+
+// keyboard analog reader port number
+#define B_ANALOG_READER A6
+
+// measuremenet digital reader, INT1
+#define M_DIGITAL_READER 3
+// channel B pin value when wheel has only one sensor
+#define ENCODER_NO_PIN 0xFF
+// second (quadrature) channel of reader, ENCODER_NO_PIN if not connected
+#define M_DIGITAL_READER_B ENCODER_NO_PIN
+
+//Step motor
+#define STEP 4
+#define DIR  5
+#define EN   6
+// level of EN pin which enables stepper driver
+#define EN_ACTIVE_LEVEL LOW
+
+// amount of platens (axes) driven by the board, 1 - 4. Axis 1 uses pins
+// above, every next one has its own STEP, DIR and reader, EN is shared.
+// Readers of axes 2-4 use pin change interrupts, channel B and endstop
+// are wired for axis 1 only. Can be given by build flags as well
+#ifndef AXES_AMOUNT
+#define AXES_AMOUNT 1
+#endif
+
+#define STEP_2 7
+#define DIR_2 8
+#define M_DIGITAL_READER_2 9
+
+#define STEP_3 10
+#define DIR_3 11
+#define M_DIGITAL_READER_3 12
+
+#define STEP_4 13
+#define DIR_4 A0
+#define M_DIGITAL_READER_4 A1
+
+// endstop of homing at the bottom, ENDSTOP_NO_PIN if not connected,
+// platform stopped by hard stop is detected by reader then
+#define ENDSTOP_NO_PIN 0xFF
+#define ENDSTOP ENDSTOP_NO_PIN
+// level of ENDSTOP pin when platform is on it, pin has pull-up
+#define ENDSTOP_ACTIVE_LEVEL LOW
+
+//Sound speaker
+#define SPEAKER 2
+
+#endif
@@ -0,0 +1,197 @@
+#include "PositionController.h"
+
+void PositionController::setTarget(long target) {
+    long umPerHole = this->estimator->umPerHole;
+
+    this->target = target;
+    //floor, remainder is never negative
+    this->targetHoles = target / umPerHole;
+    if (target < 0 && target % umPerHole != 0) {
+        this->targetHoles -= 1;
+    }
+    this->targetRemainder = target - this->targetHoles * umPerHole;
+
+    //without ratio remainder cannot be made by steps, round to nearest hole
+    if (this->estimator->stepsPerHole == 0) {
+        if (this->targetRemainder >= umPerHole / 2) {
+            this->targetHoles += 1;
+        }
+        this->targetRemainder = 0;
+    }
+}
+
+int PositionController::getGoal() {
+    int holes = *this->passedHoles;
+
+    //above target, or on it but came from above: go one hole lower
+    //and approach target going up
+    if (holes > this->targetHoles ||
+        (holes == this->targetHoles && this->stepper->direction == HIGH)) {
+        return this->targetHoles - 1;
+    }
+
+    return this->targetHoles;
+}
+
+void PositionController::moveTo(long target) {
+    if (this->state == POSITION_IDLE) {
+        this->setTarget(target);
+        this->state = POSITION_FAST;
+        return;
+    }
+
+    if (target == this->target) {
+        return;
+    }
+
+    this->setTarget(target);
+
+    //extend or shorten fast move on the fly. Move which now ends inside
+    //approach zone or goes the wrong way is stopped by service()
+    int remaining = this->getGoal() - *this->passedHoles;
+    uint8_t direction = remaining > 0 ? LOW : HIGH;
+    if (this->state == POSITION_FAST &&
+        this->stepper->hasTarget() == true &&
+        this->stepper->direction == direction &&
+        abs(remaining) > POSITION_APPROACH_HOLES) {
+        this->plan(remaining);
+    }
+
+    //fine part was started for the old target, make it again
+    if (this->state == POSITION_FINE) {
+        this->stepper->stop();
+        this->state = POSITION_APPROACH;
+    }
+}
+
+bool PositionController::service() {
+    if (this->state == POSITION_IDLE) {
+        return true;
+    }
+
+    if (this->state == POSITION_FINE) {
+        if (this->stepper->isRunning() == false) {
+            this->finish();
+            return true;
+        }
+        return false;
+    }
+
+    int remaining = this->getGoal() - *this->passedHoles;
+
+    if (remaining == 0) {
+        if (this->state == POSITION_APPROACH) {
+            //approach speed is below start-stop speed, no steps are lost
+            this->stepper->halt();
+        } else {
+            //target reached at speed, overshoot is approached back
+            this->stepper->stop();
+        }
+
+        if (this->stepper->isRunning() == true) {
+            return false;
+        }
+
+        //the rest of target above the hole edge, going up. Steps made
+        //after the edge already count (retarget during fine part)
+        long steps = this->estimator->micrometresToSteps(this->targetRemainder) -
+            (this->estimator->encoder->edgeStepPosition - this->stepper->position);
+
+        if (steps > 0) {
+            this->state = POSITION_FINE;
+            this->stepper->setMaxSpeed(this->approachSpeed);
+            this->stepper->move(-steps);
+            return false;
+        }
+
+        if (steps < 0) {
+            //already above target, leave the hole down and approach again
+            this->state = POSITION_APPROACH;
+            this->stepper->setMaxSpeed(this->approachSpeed);
+            this->stepper->run(HIGH);
+            return false;
+        }
+
+        this->finish();
+        return true;
+    }
+
+    //UP (more holes) is driven by LOW level of DIR
+    uint8_t direction = remaining > 0 ? LOW : HIGH;
+
+    if (this->stepper->isRunning() == true) {
+        if (this->stepper->direction != direction) {
+            //overshoot, turn back once at rest
+            this->stepper->stop();
+        } else if (this->state == POSITION_FAST && abs(remaining) <= POSITION_APPROACH_HOLES) {
+            this->stepper->stop();
+        }
+        return false;
+    }
+
+    this->plan(remaining);
+    return false;
+}
+
+void PositionController::cancel() {
+    if (this->state == POSITION_IDLE) {
+        return;
+    }
+
+    this->stepper->stop();
+    this->finish();
+}
+
+void PositionController::plan(int remaining) {
+    uint8_t direction = remaining > 0 ? LOW : HIGH;
+    unsigned int holesLeft = abs(remaining);
+    unsigned long stepsPerHole = this->estimator->stepsPerHole;
+
+    if (holesLeft <= POSITION_APPROACH_HOLES) {
+        this->state = POSITION_APPROACH;
+        this->stepper->setMaxSpeed(this->approachSpeed);
+        this->stepper->run(direction);
+        return;
+    }
+
+    this->state = POSITION_FAST;
+    this->stepper->setMaxSpeed(this->fastSpeed);
+
+    if (stepsPerHole == 0) {
+        //ratio is not known yet, service() stops it in approach zone
+        this->stepper->run(direction);
+        return;
+    }
+
+    this->stepper->move(this->getFastSteps(remaining));
+}
+
+long PositionController::getFastSteps(int remaining) {
+    uint8_t direction = remaining > 0 ? LOW : HIGH;
+    unsigned int holesLeft = abs(remaining);
+    long steps = ((holesLeft - POSITION_APPROACH_HOLES) * this->estimator->stepsPerHole) >> 8;
+
+    if (this->stepper->direction != direction) {
+        steps += this->backlashSteps;
+    }
+
+    //positive steps are driven by HIGH level of DIR
+    return direction == HIGH ? steps : -steps;
+}
+
+long PositionController::planFastSteps(long target) {
+    this->setTarget(target);
+
+    int remaining = this->getGoal() - *this->passedHoles;
+
+    if (abs(remaining) <= POSITION_APPROACH_HOLES || this->estimator->stepsPerHole == 0) {
+        return 0;
+    }
+
+    return this->getFastSteps(remaining);
+}
+
+void PositionController::finish() {
+    this->state = POSITION_IDLE;
+    this->stepper->setMaxSpeed(this->fastSpeed);
+}
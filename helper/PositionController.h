@@ -0,0 +1,109 @@
+#ifndef POSITION_CONTROLLER_H
+#define POSITION_CONTROLLER_H
+
+#include <Arduino.h>
+
+#include "StepGenerator.h"
+#include "PositionEstimator.h"
+
+// controller states
+#define POSITION_IDLE 0
+#define POSITION_FAST 1
+#define POSITION_APPROACH 2
+#define POSITION_FINE 3
+
+// last holes before target are passed at approach speed
+#define POSITION_APPROACH_HOLES 2
+
+/**
+ * @brief Moves platform to target position for semi-auto and template windows.
+ * Steps per hole ratio learned by PositionEstimator gives distance to
+ * target in steps: fast part of move is a StepGenerator::move() which
+ * starts decelerating early enough to stop POSITION_APPROACH_HOLES before
+ * target hole, the rest is passed at approach speed and stepper is
+ * halted right on target hole edge. Part of target finer than one hole
+ * is made by steps after that edge. Until ratio is learned fast part
+ * runs until approach zone is reached and targets are rounded to holes.
+ *
+ * Target hole is always approached going up, so backlash is taken up
+ * the same way and stop is made on the same edge every time. Targets
+ * below current position are passed by one hole and approached back.
+ * First steps after reversal do not move the wheel (backlash), fast move
+ * in reversed direction is made longer by backlashSteps.
+ *
+ * All methods are called from control ISR.
+ */
+class PositionController {
+  public:
+    StepGenerator* stepper;
+    PositionEstimator* estimator;
+    volatile int* passedHoles;
+
+    unsigned int fastSpeed;
+    unsigned int approachSpeed;
+    unsigned int backlashSteps = 0;
+
+    uint8_t state = POSITION_IDLE;
+    // target, um
+    long target = 0;
+    // target split into hole and micrometres above it
+    int targetHoles = 0;
+    long targetRemainder = 0;
+
+    PositionController(StepGenerator* stepper, PositionEstimator* estimator) {
+      this->stepper = stepper;
+      this->estimator = estimator;
+      this->passedHoles = estimator->passedHoles;
+    }
+
+    /**
+     * @param fastSpeed speed of fast part of move, steps per second
+     * @param approachSpeed speed near target, low enough to halt without losing steps
+     */
+    void setSpeeds(unsigned int fastSpeed, unsigned int approachSpeed) {
+      this->fastSpeed = fastSpeed;
+      this->approachSpeed = approachSpeed;
+    }
+
+    /**
+     * @brief starts move to target, or retargets move which is in progress
+     *
+     * @param target position, um
+     */
+    void moveTo(long target);
+
+    /**
+     * @brief drives move, needs to be called on every control tick while move is active
+     *
+     * @return true when target is reached and stepper is at rest
+     */
+    bool service();
+
+    /**
+     * @brief abandons move, stepper decelerates to rest
+     */
+    void cancel();
+
+    bool isActive() {
+      return this->state != POSITION_IDLE;
+    }
+
+    /**
+     * @brief distance of fast part of move to target, for moves of several
+     * axes at once. Called while controller is idle, the rest of the move
+     * is made by moveTo() after fast part
+     *
+     * @param target position, um
+     * @return long steps, sign is direction, 0 if target is in approach zone or ratio is not learned
+     */
+    long planFastSteps(long target);
+
+  private:
+    void setTarget(long target);
+    int getGoal();
+    void plan(int remaining);
+    long getFastSteps(int remaining);
+    void finish();
+};
+
+#endif
@@ -0,0 +1,84 @@
+#include <util/atomic.h>
+
+#include "PositionEstimator.h"
+
+void PositionEstimator::observe() {
+    int holes = *this->passedHoles;
+
+    if (holes == this->anchorHoles) {
+        return;
+    }
+
+    int holesDelta = holes - this->anchorHoles;
+    int8_t holeDirection = holesDelta > 0 ? 1 : -1;
+    long position = this->encoder->edgeStepPosition;
+    long stepsDelta = labs(position - this->anchorPosition);
+
+    if (abs(holesDelta) > POSITION_MAX_HOLES_PER_TICK) {
+        //position was set, not moved to. Interpolate from here
+        this->encoder->edgeStepPosition = this->stepper->position;
+        position = this->stepper->position;
+        this->learnSteps = 0;
+        this->learnHoles = 0;
+    } else if (stepsDelta == 0 || holeDirection != this->lastHoleDirection) {
+        //first hole after reversal includes backlash
+        this->learnSteps = 0;
+        this->learnHoles = 0;
+    } else {
+        this->learnSteps += stepsDelta;
+        this->learnHoles += abs(holesDelta);
+
+        if (this->learnHoles >= POSITION_LEARN_HOLES) {
+            unsigned long estimate = (this->learnSteps << 8) / this->learnHoles;
+
+            if (this->stepsPerHole == 0) {
+                this->stepsPerHole = estimate;
+            } else {
+                this->stepsPerHole = (3 * this->stepsPerHole + estimate) / 4;
+            }
+
+            this->learnSteps = 0;
+            this->learnHoles = 0;
+        }
+    }
+
+    this->lastHoleDirection = holeDirection;
+    this->anchorHoles = holes;
+    this->anchorPosition = position;
+}
+
+long PositionEstimator::getPosition() {
+    int holes;
+    long edgePosition, position;
+    int8_t edgeDirection;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        holes = *this->passedHoles;
+        edgePosition = this->encoder->edgeStepPosition;
+        edgeDirection = this->encoder->edgeDirection;
+        position = this->stepper->position;
+    }
+
+    long holesPosition = holes * this->umPerHole;
+    if (this->stepsPerHole == 0) {
+        return holesPosition;
+    }
+
+    //UP is driven by LOW level of DIR, so steps go down while holes go up
+    long travel = (edgePosition - position) * edgeDirection;
+    long fraction;
+    if (travel <= 0) {
+        fraction = 0;
+    } else if (travel >= (long)(this->stepsPerHole >> 8)) {
+        //wheel has to give next edge soon, never run ahead of it
+        fraction = this->umPerHole;
+    } else {
+        fraction = ((travel * this->umPerHole) << 8) / (long)this->stepsPerHole;
+    }
+
+    //going down, hole n is counted on the edge which is at n + 1 holes
+    if (edgeDirection > 0) {
+        return holesPosition + fraction;
+    }
+    return holesPosition + this->umPerHole - fraction;
+}
@@ -0,0 +1,73 @@
+#ifndef POSITION_ESTIMATOR_H
+#define POSITION_ESTIMATOR_H
+
+#include <Arduino.h>
+
+#include "StepGenerator.h"
+#include "HoleEncoder.h"
+
+// holes in one direction averaged into one steps per hole estimate
+#define POSITION_LEARN_HOLES 4
+// bigger position jump between two ticks is not a move (calibration, restore)
+#define POSITION_MAX_HOLES_PER_TICK 2
+
+/**
+ * @brief Position finer than one reader hole.
+ * Encoder stores step position of stepper at every edge, so hole count
+ * is anchored there and part of hole passed since is interpolated from
+ * steps made after the edge. Interpolated part is limited to one hole,
+ * the wheel stays the reference and step errors never accumulate.
+ *
+ * Steps per hole ratio is learned on control ticks from the same edge
+ * anchors, averaged over several holes in one direction.
+ */
+class PositionEstimator {
+  public:
+    HoleEncoder* encoder;
+    StepGenerator* stepper;
+    volatile int* passedHoles;
+    long umPerHole = 0;
+    // learned ratio, 24.8 fixed point, 0 until first estimate
+    unsigned long stepsPerHole = 0;
+
+    // hole count seen on previous tick and edge it was counted on
+    int anchorHoles = 0;
+    long anchorPosition = 0;
+    int8_t lastHoleDirection = 0;
+    // steps and holes collected for next ratio estimate
+    long learnSteps = 0;
+    int learnHoles = 0;
+
+    PositionEstimator(HoleEncoder* encoder, volatile int* passedHoles) {
+      this->encoder = encoder;
+      this->stepper = encoder->stepper;
+      this->passedHoles = passedHoles;
+    }
+
+    void setUMPerHole(long umPerHole) {
+      this->umPerHole = umPerHole;
+    }
+
+    /**
+     * @brief learns steps per hole ratio, needs to be called from control ISR
+     * on every tick, whatever moves stepper
+     */
+    void observe();
+
+    /**
+     * @brief current position, can be called from loop()
+     *
+     * @return long um
+     */
+    long getPosition();
+
+    /**
+     * @param micrometres distance
+     * @return long steps, 0 while ratio is not learned
+     */
+    long micrometresToSteps(long micrometres) {
+      return ((micrometres << 8) / this->umPerHole * this->stepsPerHole) >> 16;
+    }
+};
+
+#endif
@@ -0,0 +1,78 @@
+#include <EEPROM.h>
+
+#include "PositionJournal.h"
+#include "Crc8.h"
+
+bool PositionJournal::readRecord(uint16_t slot, PositionRecord &record) {
+    EEPROM.get(this->startAddress + slot * sizeof(PositionRecord), record);
+
+    if (record.sequence == POSITION_JOURNAL_NO_SEQUENCE) {
+        return false;
+    }
+
+    return crc8((uint8_t*)&record, offsetof(PositionRecord, crc)) == record.crc;
+}
+
+bool PositionJournal::begin(int* passedHoles) {
+    PositionRecord record;
+    bool isFound = false;
+
+    for (uint16_t slot = 0; slot < this->slotsAmount; slot++) {
+        if (this->readRecord(slot, record) == false) {
+            continue;
+        }
+
+        //sequence wraps around, so compare by difference
+        if (isFound == false || (int16_t)(record.sequence - this->lastSequence) > 0) {
+            isFound = true;
+            this->lastSlot = slot;
+            this->lastSequence = record.sequence;
+            for (uint8_t i = 0; i < AXES_AMOUNT; i++) {
+                this->lastCommittedHoles[i] = record.passedHoles[i];
+            }
+        }
+    }
+
+    if (isFound == false) {
+        //empty journal, first record goes to the first slot
+        this->lastSlot = this->slotsAmount - 1;
+        this->lastSequence = 0;
+    }
+
+    for (uint8_t i = 0; i < AXES_AMOUNT; i++) {
+        if (isFound == true) {
+            passedHoles[i] = this->lastCommittedHoles[i];
+        } else {
+            this->lastCommittedHoles[i] = passedHoles[i];
+        }
+    }
+
+    return isFound;
+}
+
+void PositionJournal::commit(const int* passedHoles) {
+    bool isChanged = false;
+
+    for (uint8_t i = 0; i < AXES_AMOUNT; i++) {
+        if (passedHoles[i] != this->lastCommittedHoles[i]) {
+            isChanged = true;
+        }
+    }
+
+    if (this->isBusy() == true || isChanged == false) {
+        return;
+    }
+
+    this->lastSlot = (this->lastSlot + 1) % this->slotsAmount;
+    this->lastSequence += 1;
+    if (this->lastSequence == POSITION_JOURNAL_NO_SEQUENCE) {
+        this->lastSequence = 0;
+    }
+    this->pendingRecord.sequence = this->lastSequence;
+    for (uint8_t i = 0; i < AXES_AMOUNT; i++) {
+        this->lastCommittedHoles[i] = passedHoles[i];
+        this->pendingRecord.passedHoles[i] = passedHoles[i];
+    }
+    this->pendingRecord.crc = crc8((uint8_t*)&this->pendingRecord, offsetof(PositionRecord, crc));
+    this->writer.start(this->startAddress + this->lastSlot * sizeof(PositionRecord), &this->pendingRecord, sizeof(PositionRecord));
+}
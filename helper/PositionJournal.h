@@ -0,0 +1,82 @@
+#ifndef POSITION_JOURNAL_H
+#define POSITION_JOURNAL_H
+
+#include <Arduino.h>
+
+#include "Pins.h"
+#include "EepromRecordWriter.h"
+
+// EEPROM area used by journal, [start; end), motion settings, job and template table are above it
+#define POSITION_JOURNAL_START 0
+#define POSITION_JOURNAL_END 352
+
+// sequence value of erased EEPROM cells, never written
+#define POSITION_JOURNAL_NO_SEQUENCE 0xFFFF
+
+// record keeps all axes, so its size and slots change with AXES_AMOUNT
+struct __attribute__((packed)) PositionRecord {
+  uint16_t sequence;
+  int16_t passedHoles[AXES_AMOUNT];
+  uint8_t crc;
+};
+
+/**
+ * @brief Wear-levelled position storage.
+ * Every commit goes to the next slot of a ring which covers the whole
+ * journal area, so each cell is rewritten once per (area / record size)
+ * commits instead of on every hole. Records are sequence-numbered and CRC
+ * protected: record which was torn by power loss is skipped on boot and
+ * the previous one is used. Records are written by EepromRecordWriter.
+ */
+class PositionJournal {
+  public:
+    int startAddress;
+    uint16_t slotsAmount;
+
+    // newest written slot and its sequence
+    uint16_t lastSlot = 0;
+    uint16_t lastSequence = POSITION_JOURNAL_NO_SEQUENCE;
+    int lastCommittedHoles[AXES_AMOUNT];
+
+    // record which is being written
+    PositionRecord pendingRecord;
+    EepromRecordWriter writer;
+
+    PositionJournal(int startAddress = POSITION_JOURNAL_START, int endAddress = POSITION_JOURNAL_END) {
+      this->startAddress = startAddress;
+      this->slotsAmount = (endAddress - startAddress) / sizeof(PositionRecord);
+    }
+
+    /**
+     * @brief scans journal for the newest valid record, needs to be called once in setup()
+     *
+     * @param passedHoles restored value of every axis, left untouched if journal is empty
+     * @return true if valid record was found
+     */
+    bool begin(int* passedHoles);
+
+    /**
+     * @brief schedules new record if position changed since last commit.
+     * Ignored while previous record is still being written
+     *
+     * @param passedHoles current position of every axis
+     */
+    void commit(const int* passedHoles);
+
+    /**
+     * @brief writes next byte of scheduled record if EEPROM is ready,
+     * needs to be called on every loop() pass
+     */
+    void service() {
+      this->writer.service();
+    }
+
+    bool isBusy() {
+      return this->writer.isBusy();
+    }
+
+  private:
+    bool readRecord(uint16_t slot, PositionRecord &record);
+};
+
+#endif
@@ -0,0 +1,59 @@
+#include <util/atomic.h>
+
+#include "Profiler.h"
+
+#if PROFILING_ENABLED
+Profiler profiler;
+#endif
+
+void ProfileCounter::stop() {
+    unsigned long duration = (uint16_t)(TCNT1 - this->startTicks);
+
+    if (this->isLongSpan == true) {
+        unsigned long span = micros() - this->startMicros;
+        if (span > PROFILE_MAX_TIMER_SPAN) {
+            duration = span * PROFILE_TICKS_PER_US;
+        }
+    }
+
+    if (duration < this->minimal) {
+        this->minimal = duration;
+    }
+    if (duration > this->maximal) {
+        this->maximal = duration;
+    }
+
+    if (this->total + duration < this->total) {
+        this->total >>= 1;
+        this->count >>= 1;
+    }
+    this->total += duration;
+    this->count += 1;
+}
+
+void ProfileCounter::reset() {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        this->minimal = 0xFFFFFFFF;
+        this->maximal = 0;
+        this->total = 0;
+        this->count = 0;
+        this->overruns = 0;
+    }
+}
+
+ProfileCounter Profiler::read(ProfileCounter &counter) {
+    ProfileCounter copy;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        copy = counter;
+    }
+
+    return copy;
+}
+
+void Profiler::reset() {
+    this->controlTick.reset();
+    this->loopPass.reset();
+    this->draw.reset();
+    this->eepromWrite.reset();
+}
@@ -0,0 +1,108 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <Arduino.h>
+
+// set to 0 to compile all measurements out
+#define PROFILING_ENABLED 1
+
+// Timer1 runs free from F_CPU / 8 (see StepGenerator.h), ticks per us
+#define PROFILE_TICKS_PER_US (F_CPU / 8 / 1000000L)
+// Timer1 wraps after 32 ms, longer spans are measured by micros(), us
+#define PROFILE_MAX_TIMER_SPAN 30000
+
+/**
+ * @brief Min, max and average duration of one code span, Timer1 ticks.
+ * Short spans (ISR) are measured only by free-running Timer1, spans which
+ * can be longer than its period also take micros() on start.
+ * Total and count are halved together before total overflows, so average
+ * follows recent spans and never wraps.
+ */
+class ProfileCounter {
+  public:
+    bool isLongSpan;
+    uint16_t startTicks;
+    unsigned long startMicros;
+
+    unsigned long minimal;
+    unsigned long maximal;
+    unsigned long total;
+    unsigned long count;
+    // periodic span (ISR) which was not finished before its next period came
+    unsigned int overruns;
+
+    ProfileCounter(bool isLongSpan = false) {
+      this->isLongSpan = isLongSpan;
+      this->reset();
+    }
+
+    void start() {
+      this->startTicks = TCNT1;
+      if (this->isLongSpan == true) {
+        this->startMicros = micros();
+      }
+    }
+
+    void stop();
+
+    void reset();
+
+    void markOverrun() {
+      this->overruns += 1;
+    }
+
+    /**
+     * @return unsigned long average duration, us
+     */
+    unsigned long getAverage() {
+      if (this->count == 0) {
+        return 0;
+      }
+      return this->total / this->count / PROFILE_TICKS_PER_US;
+    }
+
+    unsigned long getMinimal() {
+      return this->count == 0 ? 0 : this->minimal / PROFILE_TICKS_PER_US;
+    }
+
+    unsigned long getMaximal() {
+      return this->maximal / PROFILE_TICKS_PER_US;
+    }
+};
+
+/**
+ * @brief Counters of all measured spans, see PROFILE_START and PROFILE_STOP
+ */
+class Profiler {
+  public:
+    // ISR(TIMER2_A), stepper supervision
+    ProfileCounter controlTick;
+    // one loop() pass
+    ProfileCounter loopPass = ProfileCounter(true);
+    // one frame of current window, all pages
+    ProfileCounter draw = ProfileCounter(true);
+    // one EEPROM byte write of position journal
+    ProfileCounter eepromWrite;
+
+    /**
+     * @brief copies counter which can be changed by ISR
+     */
+    ProfileCounter read(ProfileCounter &counter);
+
+    void reset();
+};
+
+#if PROFILING_ENABLED
+extern Profiler profiler;
+
+#define PROFILE_START(counter) profiler.counter.start()
+#define PROFILE_STOP(counter) profiler.counter.stop()
+// counts overrun of span if condition is true
+#define PROFILE_OVERRUN(counter, condition) if (condition) profiler.counter.markOverrun()
+#else
+#define PROFILE_START(counter)
+#define PROFILE_STOP(counter)
+#define PROFILE_OVERRUN(counter, condition)
+#endif
+
+#endif
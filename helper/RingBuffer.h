@@ -0,0 +1,61 @@
+#ifndef RING_BUFFER_H
+#define RING_BUFFER_H
+
+#include <Arduino.h>
+
+/**
+ * @brief Lock-free single-producer/single-consumer queue.
+ * Producer (ISR) only moves head, consumer (loop) only moves tail, both
+ * indexes are single bytes, so no interrupt locking is needed on AVR.
+ *
+ * @tparam T item type
+ * @tparam SIZE capacity + 1, must be power of 2
+ */
+template <typename T, uint8_t SIZE>
+class RingBuffer {
+  public:
+    T items[SIZE];
+    volatile uint8_t head = 0;
+    volatile uint8_t tail = 0;
+
+    /**
+     * @param item value to put
+     * @return false if queue is full and item is lost
+     */
+    bool push(const T &item) {
+      uint8_t next = (this->head + 1) & (SIZE - 1);
+
+      if (next == this->tail) {
+        return false;
+      }
+
+      this->items[this->head] = item;
+      //item has to be in memory before consumer can see new head
+      asm volatile("" ::: "memory");
+      this->head = next;
+
+      return true;
+    }
+
+    /**
+     * @param item filled if queue is not empty
+     * @return true if item was taken
+     */
+    bool pop(T &item) {
+      if (this->tail == this->head) {
+        return false;
+      }
+
+      item = this->items[this->tail];
+      asm volatile("" ::: "memory");
+      this->tail = (this->tail + 1) & (SIZE - 1);
+
+      return true;
+    }
+
+    bool isEmpty() {
+      return this->tail == this->head;
+    }
+};
+
+#endif
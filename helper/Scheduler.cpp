@@ -0,0 +1,74 @@
+#include <avr/sleep.h>
+
+#include "Scheduler.h"
+
+void Scheduler::setTask(uint8_t id, void (*callback)(), unsigned int latencyBound) {
+    ScheduledTask &task = this->tasks[id];
+
+    task.callback = callback;
+    task.latencyBound = latencyBound * 1000UL;
+    task.maxLatency = 0;
+    task.overruns = 0;
+    task.isActive = false;
+}
+
+void Scheduler::startPeriodic(uint8_t id, unsigned long period) {
+    ScheduledTask &task = this->tasks[id];
+
+    task.period = period * 1000UL;
+    task.deadline = micros() + task.period;
+    task.isActive = true;
+}
+
+void Scheduler::startOnce(uint8_t id, unsigned long delay) {
+    ScheduledTask &task = this->tasks[id];
+
+    task.period = 0;
+    task.deadline = micros() + delay * 1000UL;
+    task.isActive = true;
+}
+
+void Scheduler::run() {
+    for (uint8_t i = 0; i < SCHEDULER_MAX_TASKS; i++) {
+        ScheduledTask &task = this->tasks[i];
+        unsigned long now = micros();
+
+        if (this->isDue(task, now) == false) {
+            continue;
+        }
+
+        unsigned long latency = now - task.deadline;
+        if (latency > task.maxLatency) {
+            task.maxLatency = latency;
+        }
+        if (latency > task.latencyBound) {
+            task.overruns += 1;
+        }
+
+        if (task.period == 0) {
+            task.isActive = false;
+        } else {
+            task.deadline += task.period;
+            //missed periods are skipped, not run back to back
+            if ((long)(now - task.deadline) >= 0) {
+                task.deadline = now + task.period;
+            }
+        }
+
+        //callback may start or stop any task, itself included
+        task.callback();
+    }
+}
+
+void Scheduler::idle() {
+    unsigned long now = micros();
+
+    for (uint8_t i = 0; i < SCHEDULER_MAX_TASKS; i++) {
+        if (this->isDue(this->tasks[i], now) == true) {
+            return;
+        }
+    }
+
+    set_sleep_mode(SLEEP_MODE_IDLE);
+    sleep_mode();
+}
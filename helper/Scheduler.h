@@ -0,0 +1,89 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <Arduino.h>
+
+#define SCHEDULER_MAX_TASKS 6
+
+struct ScheduledTask {
+  void (*callback)();
+  unsigned long deadline; //us, micros()
+  unsigned long period; //us, 0 - one-shot
+  // latency above this bound is counted as overrun, us
+  unsigned long latencyBound;
+  // the worst delay between deadline and start of callback, us
+  unsigned long maxLatency;
+  uint16_t overruns;
+  bool isActive;
+};
+
+/**
+ * @brief Deadline scheduler of loop() tasks.
+ * Task is registered once by id and then started as periodic or one-shot
+ * one. Periodic deadlines advance by period, not from the moment the
+ * task ran, so long render does not shift the next deadlines. Delay of
+ * every start is measured against its deadline.
+ *
+ * Nothing here runs in ISR, tasks are started, stopped and run from loop().
+ */
+class Scheduler {
+  public:
+    ScheduledTask tasks[SCHEDULER_MAX_TASKS];
+
+    Scheduler() {
+      for (uint8_t i = 0; i < SCHEDULER_MAX_TASKS; i++) {
+        this->tasks[i].callback = NULL;
+        this->tasks[i].isActive = false;
+      }
+    }
+
+    /**
+     * @brief registers task, it stays stopped until started
+     *
+     * @param id task index, less than SCHEDULER_MAX_TASKS
+     * @param callback function to run
+     * @param latencyBound allowed delay of start, ms
+     */
+    void setTask(uint8_t id, void (*callback)(), unsigned int latencyBound);
+
+    /**
+     * @brief runs task every period, first time after one period
+     *
+     * @param period ms
+     */
+    void startPeriodic(uint8_t id, unsigned long period);
+
+    /**
+     * @brief runs task once, restarts it if it is waiting already
+     *
+     * @param delay ms
+     */
+    void startOnce(uint8_t id, unsigned long delay);
+
+    void stop(uint8_t id) {
+      this->tasks[id].isActive = false;
+    }
+
+    bool isActive(uint8_t id) {
+      return this->tasks[id].isActive;
+    }
+
+    /**
+     * @brief runs tasks which reached deadline, needs to be called on every loop() pass
+     */
+    void run();
+
+    /**
+     * @brief sleeps (idle mode) until the next interrupt if no task is due.
+     * Timer0 and control tick wake CPU every millisecond, so deadlines are
+     * still checked at least once per ms
+     */
+    void idle();
+
+  private:
+    bool isDue(ScheduledTask &task, unsigned long now) {
+      return task.isActive == true && (long)(now - task.deadline) >= 0;
+    }
+};
+
+#endif
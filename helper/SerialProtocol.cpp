@@ -0,0 +1,97 @@
+#include "SerialProtocol.h"
+#include "Crc8.h"
+
+bool SerialProtocol::receive(ProtocolFrame &frame) {
+    while (this->port->available() > 0) {
+        uint8_t value = this->port->read();
+
+        switch (this->rxState)
+        {
+        case PROTOCOL_WAIT_START:
+            if (value == PROTOCOL_START) {
+                this->rxState = PROTOCOL_WAIT_LENGTH;
+            }
+            break;
+
+        case PROTOCOL_WAIT_LENGTH:
+            if (value > PROTOCOL_MAX_PAYLOAD) {
+                this->rxState = PROTOCOL_WAIT_START;
+                break;
+            }
+            this->rxFrame.length = value;
+            this->rxCrc = crc8(&value, 1);
+            this->rxState = PROTOCOL_WAIT_TYPE;
+            break;
+
+        case PROTOCOL_WAIT_TYPE:
+            this->rxFrame.type = value;
+            this->rxCrc = crc8(&value, 1, this->rxCrc);
+            this->rxIndex = 0;
+            this->rxState = this->rxFrame.length > 0 ? PROTOCOL_WAIT_PAYLOAD : PROTOCOL_WAIT_CRC;
+            break;
+
+        case PROTOCOL_WAIT_PAYLOAD:
+            this->rxFrame.payload[this->rxIndex++] = value;
+            this->rxCrc = crc8(&value, 1, this->rxCrc);
+            if (this->rxIndex >= this->rxFrame.length) {
+                this->rxState = PROTOCOL_WAIT_CRC;
+            }
+            break;
+
+        case PROTOCOL_WAIT_CRC:
+            this->rxState = PROTOCOL_WAIT_START;
+            if (value == this->rxCrc) {
+                frame = this->rxFrame;
+                return true;
+            }
+            break;
+        }
+    }
+
+    return false;
+}
+
+bool SerialProtocol::sendReply(const ProtocolFrame &frame) {
+    if (this->isReplyPending == true) {
+        return false;
+    }
+
+    this->reply = frame;
+    this->isReplyPending = true;
+    this->service();
+
+    return true;
+}
+
+bool SerialProtocol::sendNow(const ProtocolFrame &frame) {
+    //replies go first
+    if (this->isReplyPending == true ||
+        this->port->availableForWrite() < frame.length + PROTOCOL_FRAME_OVERHEAD) {
+        return false;
+    }
+
+    this->write(frame);
+    return true;
+}
+
+void SerialProtocol::service() {
+    if (this->isReplyPending == false ||
+        this->port->availableForWrite() < this->reply.length + PROTOCOL_FRAME_OVERHEAD) {
+        return;
+    }
+
+    this->write(this->reply);
+    this->isReplyPending = false;
+}
+
+void SerialProtocol::write(const ProtocolFrame &frame) {
+    uint8_t crc = crc8(&frame.length, 1);
+    crc = crc8(&frame.type, 1, crc);
+    crc = crc8(frame.payload, frame.length, crc);
+
+    this->port->write(PROTOCOL_START);
+    this->port->write(frame.length);
+    this->port->write(frame.type);
+    this->port->write(frame.payload, frame.length);
+    this->port->write(crc);
+}
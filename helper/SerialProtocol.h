@@ -0,0 +1,166 @@
+#ifndef SERIAL_PROTOCOL_H
+#define SERIAL_PROTOCOL_H
+
+#include <Arduino.h>
+
+#define PROTOCOL_BAUD_RATE 115200
+// first byte of every frame
+#define PROTOCOL_START 0xA5
+#define PROTOCOL_MAX_PAYLOAD 32
+// start, length, type and crc
+#define PROTOCOL_FRAME_OVERHEAD 4
+// telemetry is sent this often, ms
+#define PROTOCOL_TELEMETRY_PERIOD 100
+
+// commands, host -> board
+#define CMD_GO_TO 0x01 // int32 target, um
+#define CMD_RUN_TEMPLATE 0x02 // uint8 template index
+#define CMD_STOP 0x03
+#define CMD_SET_ZERO 0x04
+#define CMD_READ_CONFIG 0x05
+#define CMD_READ_PROFILE 0x06
+#define CMD_READ_TEMPLATE 0x07 // uint8 index
+#define CMD_WRITE_TEMPLATE 0x08 // uint8 index, int32 height, um, name without zero
+#define CMD_RUN_JOB 0x09
+#define CMD_READ_TASKS 0x0A
+#define CMD_READ_DISPLAY 0x0B
+#define CMD_HOME 0x0C
+#define CMD_READ_HOMING 0x0D
+#define CMD_TUNE 0x0E
+#define CMD_READ_TUNING 0x0F
+#define CMD_SELECT_AXIS 0x10 // uint8 axis index, 0xFF - all axes
+
+// frames, board -> host
+#define FRAME_ACK 0x80 // uint8 command, uint8 status
+#define FRAME_CONFIG 0x81
+#define FRAME_PROFILE 0x82
+#define FRAME_TEMPLATE 0x83 // uint8 index, uint8 status, int32 height, um, name
+#define FRAME_TASKS 0x84 // per task: uint16 latency bound, ms, uint16 max latency, us, uint16 overruns
+// uint8 window id, uint8 valid pages, 8 x uint16 page checksums, uint16 pixel writes,
+// uint8 rendered pages, uint8 sent pages, uint16 sent bytes of the last frame
+#define FRAME_DISPLAY 0x85
+// uint8 state, uint8 runs, uint32 time, ms, int32 zero deviation, um, int32 deviation spread, um
+#define FRAME_HOMING 0x86
+// uint8 state, uint16 speed and acceleration under test, uint16 speed and acceleration
+// in use, uint16 slips, uint8 peak load, % of steps per hole
+#define FRAME_TUNING 0x87
+// int16 keyboard ADC value, uint8 1 if it is mapped to button signal range
+#define FRAME_KEYBOARD 0x88
+#define FRAME_TELEMETRY 0x90
+
+// ACK statuses
+#define STATUS_OK 0
+#define STATUS_BUSY 1
+#define STATUS_BAD_ARGUMENT 2
+#define STATUS_UNKNOWN_COMMAND 3
+#define STATUS_DAMAGED 4
+
+// receiver states
+#define PROTOCOL_WAIT_START 0
+#define PROTOCOL_WAIT_LENGTH 1
+#define PROTOCOL_WAIT_TYPE 2
+#define PROTOCOL_WAIT_PAYLOAD 3
+#define PROTOCOL_WAIT_CRC 4
+
+/**
+ * @brief Frame payload, little endian numbers
+ */
+struct ProtocolFrame {
+  uint8_t type;
+  uint8_t length;
+  uint8_t payload[PROTOCOL_MAX_PAYLOAD];
+
+  void begin(uint8_t type) {
+    this->type = type;
+    this->length = 0;
+  }
+
+  void putByte(uint8_t value) {
+    this->payload[this->length++] = value;
+  }
+
+  void putInt(uint16_t value) {
+    this->putByte(value);
+    this->putByte(value >> 8);
+  }
+
+  void putLong(uint32_t value) {
+    this->putInt(value);
+    this->putInt(value >> 16);
+  }
+
+  uint8_t getByte(uint8_t offset) {
+    return this->payload[offset];
+  }
+
+  uint32_t getLong(uint8_t offset) {
+    return (uint32_t)this->payload[offset] |
+      ((uint32_t)this->payload[offset + 1] << 8) |
+      ((uint32_t)this->payload[offset + 2] << 16) |
+      ((uint32_t)this->payload[offset + 3] << 24);
+  }
+};
+
+/**
+ * @brief Framed binary protocol over serial port.
+ * Frame is [0xA5, payload length, type, payload..., crc8], crc8 covers
+ * length, type and payload. Broken frames are dropped and receiver waits
+ * for next start byte.
+ *
+ * Serial TX is interrupt driven already, frame is written only when
+ * whole of it fits into TX buffer, so loop() never waits for the port.
+ * Reply which does not fit is kept and written on next service(),
+ * telemetry which does not fit is skipped, next one is newer anyway.
+ */
+class SerialProtocol {
+  public:
+    HardwareSerial* port;
+
+    uint8_t rxState = PROTOCOL_WAIT_START;
+    uint8_t rxIndex = 0;
+    uint8_t rxCrc = 0;
+    ProtocolFrame rxFrame;
+
+    ProtocolFrame reply;
+    bool isReplyPending = false;
+
+    SerialProtocol(HardwareSerial* port) {
+      this->port = port;
+    }
+
+    void begin() {
+      this->port->begin(PROTOCOL_BAUD_RATE);
+    }
+
+    /**
+     * @brief parses received bytes, needs to be called from loop()
+     *
+     * @param frame filled with received command
+     * @return true if whole valid frame was received
+     */
+    bool receive(ProtocolFrame &frame);
+
+    /**
+     * @brief queues reply to command, only one reply can wait for the port
+     *
+     * @return false if previous reply is still waiting
+     */
+    bool sendReply(const ProtocolFrame &frame);
+
+    /**
+     * @brief writes frame right away if it fits into TX buffer
+     *
+     * @return false if frame was skipped
+     */
+    bool sendNow(const ProtocolFrame &frame);
+
+    /**
+     * @brief writes waiting reply, needs to be called on every loop() pass
+     */
+    void service();
+
+  private:
+    void write(const ProtocolFrame &frame);
+};
+
+#endif
@@ -0,0 +1,52 @@
+#include "SlipMonitor.h"
+
+bool SlipMonitor::observe() {
+    int holes = *this->passedHoles;
+    long holeSteps = this->estimator->stepsPerHole >> 8;
+
+    if (holeSteps == 0) {
+        this->reset();
+        return false;
+    }
+
+    if (holes != this->watchHoles) {
+        //steps of one hole, first hole after reversal includes backlash
+        if (this->allowance == 0 && abs(holes - this->watchHoles) <= POSITION_MAX_HOLES_PER_TICK) {
+            long load = this->travel * 100 / holeSteps;
+            if (load > this->peakLoad) {
+                this->peakLoad = min(load, 0xFFL);
+            }
+        }
+        this->reset();
+        return false;
+    }
+
+    if (this->stepper->direction != this->watchDirection) {
+        this->watchDirection = this->stepper->direction;
+        this->travel = 0;
+        this->allowance = this->backlashSteps;
+    }
+
+    long position = this->stepper->position;
+    this->travel += labs(position - this->watchPosition);
+    this->watchPosition = position;
+
+    if (this->travel <= holeSteps + holeSteps * SLIP_TOLERANCE / 100 + this->allowance) {
+        return false;
+    }
+
+    //reported once, next report needs the same amount of steps again
+    this->travel = 0;
+    if (this->slips < 0xFFFF) {
+        this->slips += 1;
+    }
+    return true;
+}
+
+void SlipMonitor::reset() {
+    this->watchHoles = *this->passedHoles;
+    this->watchPosition = this->stepper->position;
+    this->watchDirection = this->stepper->direction;
+    this->travel = 0;
+    this->allowance = 0;
+}
@@ -0,0 +1,64 @@
+#ifndef SLIP_MONITOR_H
+#define SLIP_MONITOR_H
+
+#include <Arduino.h>
+
+#include "StepGenerator.h"
+#include "PositionEstimator.h"
+
+// steps made without new hole may exceed learned steps per hole by this much, %
+#define SLIP_TOLERANCE 50
+
+/**
+ * @brief Compares steps issued by the step generator with holes counted
+ * by the reader. Steps made since the last hole are summed on control
+ * ticks; if they reach learned steps per hole plus SLIP_TOLERANCE and no
+ * hole came, stepper is losing steps (or the platform is blocked).
+ * Reversal restarts the sum and allows backlash on top of it.
+ *
+ * Nothing is checked until PositionEstimator learned the ratio. Position
+ * stays right after slip, it is counted by the wheel, not by steps.
+ *
+ * All methods are called from control ISR.
+ */
+class SlipMonitor {
+  public:
+    StepGenerator* stepper;
+    PositionEstimator* estimator;
+    volatile int* passedHoles;
+    unsigned int backlashSteps = 0;
+
+    // hole count, step position and direction seen on previous tick
+    int watchHoles = 0;
+    long watchPosition = 0;
+    uint8_t watchDirection = LOW;
+    // steps made since the last hole and extra steps allowed for them
+    long travel = 0;
+    long allowance = 0;
+
+    // slips detected since power on
+    volatile unsigned int slips = 0;
+    // the biggest steps of one hole seen so far, % of learned ratio
+    volatile uint8_t peakLoad = 0;
+
+    SlipMonitor(StepGenerator* stepper, PositionEstimator* estimator) {
+      this->stepper = stepper;
+      this->estimator = estimator;
+      this->passedHoles = estimator->passedHoles;
+    }
+
+    /**
+     * @brief needs to be called on every control tick, after PositionEstimator::observe()
+     *
+     * @return true on the tick slip is detected, caller stops the stepper
+     */
+    bool observe();
+
+    /**
+     * @brief starts watching from current position, for moves which stall
+     * the wheel on purpose (homing) and position jumps
+     */
+    void reset();
+};
+
+#endif
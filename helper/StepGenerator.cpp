@@ -0,0 +1,346 @@
+#include <util/atomic.h>
+
+#include "StepGenerator.h"
+#include "FastGpio.h"
+
+typedef FastPin<EN> EnablePin;
+
+void StepTimeBase::begin() {
+    for (uint8_t i = 0; i < AXES_AMOUNT; i++) {
+        axisSetupDriver(i);
+    }
+
+    EnablePin::write(EN_ACTIVE_LEVEL);
+    EnablePin::setOutput();
+
+    //normal mode, prescaler 8, no interrupts until first move
+    TCCR1A = 0;
+    TCCR1B = _BV(CS11);
+    TIMSK1 &= ~_BV(OCIE1A);
+}
+
+void StepTimeBase::setMaxSpeed(unsigned int stepsPerSecond) {
+    if (stepsPerSecond == 0) {
+        stepsPerSecond = 1;
+    }
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        this->minimalDelay = (STEP_TIMER_FREQUENCY / stepsPerSecond) << 8;
+    }
+}
+
+void StepTimeBase::setAcceleration(unsigned int stepsPerSecondSquared) {
+    if (stepsPerSecondSquared == 0) {
+        stepsPerSecondSquared = 1;
+    }
+
+    //c0 = 0.676 * f * sqrt(2 / a), 0.676 compensates error of first steps
+    //of the incremental approximation. Calculated once here, never in ISR
+    double firstDelay = 0.676 * STEP_TIMER_FREQUENCY * sqrt(2.0 / stepsPerSecondSquared);
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        this->initialDelay = (unsigned long)firstDelay << 8;
+    }
+}
+
+bool StepTimeBase::isTakenBy(StepGenerator* axis) {
+    return this->state != STEPPER_IDLE && (this->lead != axis || this->isGroup == true);
+}
+
+void StepTimeBase::run(StepGenerator* axis, uint8_t direction) {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        if (this->isTakenBy(axis) == false) {
+            if (this->state == STEPPER_IDLE) {
+                this->lead = axis;
+                this->hasTarget = false;
+                this->start(direction);
+            } else {
+                this->steer(direction);
+            }
+        }
+    }
+}
+
+void StepTimeBase::move(StepGenerator* axis, long steps) {
+    uint8_t direction = steps > 0 ? HIGH : LOW;
+
+    if (steps == 0) {
+        return;
+    }
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        if (this->isTakenBy(axis) == true) {
+            //caller repeats the move once time base is free
+        } else if (this->state != STEPPER_IDLE && this->lead->direction != direction) {
+            //caller repeats the move once stepper is at rest
+            this->hasTarget = false;
+            this->isReversePending = false;
+            this->state = STEPPER_DECEL;
+        } else {
+            this->stepsToGo = abs(steps);
+            this->hasTarget = true;
+            this->isReversePending = false;
+
+            if (this->state == STEPPER_IDLE) {
+                this->lead = axis;
+                this->start(direction);
+            }
+        }
+    }
+}
+
+bool StepTimeBase::moveTogether(const long* steps) {
+    uint8_t leadIndex = 0;
+    long leadSteps = 0;
+    bool isStarted = false;
+
+    for (uint8_t i = 0; i < AXES_AMOUNT; i++) {
+        if (labs(steps[i]) > leadSteps) {
+            leadIndex = i;
+            leadSteps = labs(steps[i]);
+        }
+    }
+
+    if (leadSteps == 0) {
+        return false;
+    }
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        if (this->state == STEPPER_IDLE) {
+            this->lead = this->axes[leadIndex];
+            this->isGroup = true;
+            this->groupSteps = leadSteps;
+
+            for (uint8_t i = 0; i < AXES_AMOUNT; i++) {
+                StepGenerator* axis = this->axes[i];
+
+                if (i == leadIndex || steps[i] == 0) {
+                    axis->share = 0;
+                    continue;
+                }
+                //error starts from half, follower steps are centered between lead ones
+                axis->share = labs(steps[i]);
+                axis->error = leadSteps / 2;
+                axis->isMoving = true;
+                axis->setDirection(steps[i] > 0 ? HIGH : LOW);
+            }
+
+            this->stepsToGo = leadSteps;
+            this->hasTarget = true;
+            this->isReversePending = false;
+            this->start(steps[leadIndex] > 0 ? HIGH : LOW);
+            isStarted = true;
+        }
+    }
+
+    return isStarted;
+}
+
+void StepTimeBase::runTogether(uint8_t direction) {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        if (this->state == STEPPER_IDLE) {
+            this->lead = this->axes[0];
+            this->isGroup = true;
+            this->groupSteps = 1;
+
+            //every lead step is a step of all axes
+            for (uint8_t i = 1; i < AXES_AMOUNT; i++) {
+                this->axes[i]->share = 1;
+                this->axes[i]->error = 0;
+                this->axes[i]->isMoving = true;
+                this->axes[i]->setDirection(direction);
+            }
+
+            this->hasTarget = false;
+            this->start(direction);
+        } else if (this->isGroup == true && this->hasTarget == false) {
+            this->steer(direction);
+        }
+    }
+}
+
+void StepTimeBase::stop() {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        this->isReversePending = false;
+        if (this->state != STEPPER_IDLE) {
+            this->state = STEPPER_DECEL;
+        }
+    }
+}
+
+void StepTimeBase::halt() {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        TIMSK1 &= ~_BV(OCIE1A);
+        this->isReversePending = false;
+        this->pendingTicks = 0;
+        this->finish();
+    }
+}
+
+void StepTimeBase::steer(uint8_t direction) {
+    this->hasTarget = false;
+
+    if (this->lead->direction != direction) {
+        //cannot reverse at speed, stop first and turn back after
+        this->isReversePending = true;
+        this->state = STEPPER_DECEL;
+    } else {
+        this->isReversePending = false;
+        if (this->state == STEPPER_DECEL) {
+            this->state = STEPPER_ACCEL;
+        }
+    }
+}
+
+void StepTimeBase::start(uint8_t direction) {
+    this->lead->setDirection(direction);
+    this->lead->share = 0;
+    this->lead->isMoving = true;
+
+    this->rampStep = 0;
+    this->pendingTicks = 0;
+    if (this->initialDelay > this->minimalDelay) {
+        this->stepDelay = this->initialDelay;
+        this->state = STEPPER_ACCEL;
+    } else {
+        this->stepDelay = this->minimalDelay;
+        this->state = STEPPER_CRUISE;
+    }
+
+    //first step right away, DIR setup time is covered by 16 ticks (8 us)
+    OCR1A = TCNT1 + 16;
+    TIFR1 = _BV(OCF1A);
+    TIMSK1 |= _BV(OCIE1A);
+}
+
+void StepTimeBase::finish() {
+    this->state = STEPPER_IDLE;
+    this->hasTarget = false;
+    this->rampStep = 0;
+    this->isGroup = false;
+
+    for (uint8_t i = 0; i < AXES_AMOUNT; i++) {
+        this->axes[i]->isMoving = false;
+        this->axes[i]->share = 0;
+    }
+}
+
+void StepTimeBase::schedule(unsigned long ticks) {
+    uint16_t chunk;
+
+    if (ticks > STEP_TIMER_MAX_CHUNK) {
+        this->pendingTicks = ticks - STEP_TIMER_MAX_CHUNK;
+        chunk = STEP_TIMER_MAX_CHUNK;
+    } else {
+        this->pendingTicks = 0;
+        chunk = ticks;
+    }
+
+    uint16_t next = OCR1A + chunk;
+    //compare point is already behind the counter (ISR was delayed),
+    //step as soon as possible instead of waiting for timer overflow
+    if ((int16_t)(next - TCNT1) < 16) {
+        next = TCNT1 + 16;
+    }
+    OCR1A = next;
+}
+
+void StepTimeBase::onTimerCompare() {
+    if (this->pendingTicks != 0) {
+        this->schedule(this->pendingTicks);
+        return;
+    }
+
+    StepGenerator* lead = this->lead;
+    lead->step();
+
+    if (this->isGroup == true) {
+        for (uint8_t i = 0; i < AXES_AMOUNT; i++) {
+            StepGenerator* axis = this->axes[i];
+
+            if (axis->share == 0) {
+                continue;
+            }
+            axis->error += axis->share;
+            if (axis->error >= this->groupSteps) {
+                axis->error -= this->groupSteps;
+                axis->step();
+            }
+        }
+    }
+
+    bool isFinished = false;
+    //step n of acceleration waits c(n) before the next one, the shorter
+    //c(n + 1) is for the step after, so ramp starts with c0 and
+    //deceleration ends with it
+    unsigned long delay = this->stepDelay;
+
+    if (this->hasTarget) {
+        this->stepsToGo -= 1;
+        if (this->stepsToGo <= 0) {
+            isFinished = true;
+        } else if (this->stepsToGo <= this->rampStep) {
+            this->state = STEPPER_DECEL;
+        }
+    }
+
+    if (isFinished == false) {
+        switch (this->state)
+        {
+        case STEPPER_ACCEL:
+            this->rampStep += 1;
+            this->stepDelay -= (2 * this->stepDelay) / (4 * (unsigned long)this->rampStep + 1);
+            if (this->stepDelay <= this->minimalDelay) {
+                this->stepDelay = this->minimalDelay;
+                this->state = STEPPER_CRUISE;
+            }
+            break;
+
+        case STEPPER_CRUISE:
+            //max speed was raised while running
+            if (this->stepDelay > this->minimalDelay) {
+                this->state = STEPPER_ACCEL;
+            }
+            //or lowered
+            if (this->stepDelay < this->minimalDelay) {
+                this->stepDelay = this->minimalDelay;
+            }
+            delay = this->stepDelay;
+            break;
+
+        case STEPPER_DECEL:
+            if (this->rampStep == 0) {
+                isFinished = true;
+            } else {
+                this->stepDelay += (2 * this->stepDelay) / (4 * (unsigned long)this->rampStep - 1);
+                this->rampStep -= 1;
+                delay = this->stepDelay;
+            }
+            break;
+        }
+    }
+
+    if (isFinished == true) {
+        TIMSK1 &= ~_BV(OCIE1A);
+
+        if (this->isReversePending == true) {
+            //followers of group run turn back with the lead
+            this->isReversePending = false;
+            for (uint8_t i = 0; i < AXES_AMOUNT; i++) {
+                if (this->axes[i]->share != 0) {
+                    this->axes[i]->setDirection(this->axes[i]->direction == HIGH ? LOW : HIGH);
+                }
+            }
+            this->start(lead->direction == HIGH ? LOW : HIGH);
+            //step just made was the last one of deceleration, the first one
+            //back waits as long as the first one of the ramp does
+            this->schedule(this->stepDelay >> 8);
+        } else {
+            this->finish();
+        }
+    } else {
+        this->schedule(delay >> 8);
+    }
+
+    axisStepsLow();
+}
@@ -0,0 +1,253 @@
+#ifndef STEP_GENERATOR_H
+#define STEP_GENERATOR_H
+
+#include <Arduino.h>
+
+#include "Pins.h"
+#include "AxisPins.h"
+
+// Timer1 runs free from F_CPU / 8, so one tick is 0.5 us
+#define STEP_TIMER_FREQUENCY (F_CPU / 8)
+// longest delay which can be loaded into 16 bit compare register at once,
+// half of the counter range is taken by compare points already passed
+// (see schedule()), so chunk must stay below it
+#define STEP_TIMER_MAX_CHUNK 0x4000
+
+// step generator states
+#define STEPPER_IDLE  0
+#define STEPPER_ACCEL 1
+#define STEPPER_CRUISE 2
+#define STEPPER_DECEL 3
+
+class StepGenerator;
+
+/**
+ * @brief Step pulse engine driven by Timer1 compare A interrupt, one
+ * for all axes. Timer1 is left free running in normal mode and every
+ * step pushes OCR1A forward by the next step delay, which is calculated
+ * incrementally (c[n] = c[n-1] - 2*c[n-1]/(4n+1)), so acceleration,
+ * cruise and deceleration cost one division per step and no float math
+ * in ISR. STEP and DIR are written through constant registers (FastPin),
+ * so the pulse costs two instructions.
+ *
+ * One motion runs at a time, ramp is counted in steps of its lead axis,
+ * which steps on every compare. In group motion (moveTogether(),
+ * runTogether()) other axes follow the lead Bresenham-style: every lead
+ * step adds axis distance to its error, axis steps when error reaches
+ * lead distance. So all axes start and stop together, keep ratio of
+ * their distances on ramps too and no axis steps faster than the lead.
+ *
+ * Speed and acceleration are shared by all axes.
+ */
+class StepTimeBase {
+  public:
+    // step generators of axes, by index, registered by their constructors
+    StepGenerator* axes[AXES_AMOUNT];
+    // axis ramp is counted for, the last one which moved
+    StepGenerator* lead = 0;
+    // other axes follow the lead
+    volatile bool isGroup = false;
+    // lead distance of group motion, steps, denominator of followers' errors
+    long groupSteps = 1;
+
+    volatile uint8_t state = STEPPER_IDLE;
+
+    // first step delay (c0) and cruise delay (cmin), timer ticks, 24.8 fixed point
+    unsigned long initialDelay;
+    unsigned long minimalDelay;
+    // current step delay, timer ticks, 24.8 fixed point
+    volatile unsigned long stepDelay;
+    // amount of steps made on acceleration ramp (n)
+    volatile unsigned int rampStep = 0;
+    // lead steps left to go, used only when hasTarget is true
+    volatile long stepsToGo = 0;
+    volatile bool hasTarget = false;
+    // part of current delay which did not fit into compare register
+    volatile unsigned long pendingTicks = 0;
+    // start in opposite direction as soon as deceleration finishes
+    volatile bool isReversePending = false;
+
+    /**
+     * @brief configures STEP/DIR pins of all axes (see Pins.h), enables
+     * drivers and starts Timer1 in normal mode
+     */
+    void begin();
+
+    /**
+     * @param stepsPerSecond cruise speed of lead axis
+     */
+    void setMaxSpeed(unsigned int stepsPerSecond);
+
+    /**
+     * @param stepsPerSecondSquared acceleration and deceleration rate of lead axis
+     */
+    void setAcceleration(unsigned int stepsPerSecondSquared);
+
+    /**
+     * @brief runs one axis, see StepGenerator::run(). Ignored while
+     * another axis or group moves, caller repeats it on the next tick
+     */
+    void run(StepGenerator* axis, uint8_t direction);
+
+    /**
+     * @brief moves one axis, see StepGenerator::move(). Ignored while
+     * another axis or group moves
+     */
+    void move(StepGenerator* axis, long steps);
+
+    /**
+     * @brief moves all axes at once, the one with the longest distance leads
+     *
+     * @param steps relative distance of every axis, by index, sign is direction
+     * @return false if something moves already or there is nothing to move
+     */
+    bool moveTogether(const long* steps);
+
+    /**
+     * @brief runs all axes in the same direction until stop() or halt(),
+     * axis 1 leads. Can be called repeatedly like run(), ignored while
+     * one axis moves
+     *
+     * @param direction HIGH or LOW level of DIR pins
+     */
+    void runTogether(uint8_t direction);
+
+    /**
+     * @brief decelerates to rest, whatever moves
+     */
+    void stop();
+
+    /**
+     * @brief stops immediately, without deceleration
+     */
+    void halt();
+
+    bool isRunning() {
+      return this->state != STEPPER_IDLE;
+    }
+
+    /**
+     * @brief needs to be called from ISR(TIMER1_COMPA_vect)
+     */
+    void onTimerCompare();
+
+  private:
+    bool isTakenBy(StepGenerator* axis);
+    void steer(uint8_t direction);
+    void start(uint8_t direction);
+    void finish();
+    void schedule(unsigned long ticks);
+};
+
+/**
+ * @brief Stepper of one axis, pulses come from shared StepTimeBase.
+ * Keeps position and direction of its axis and passes moves to time
+ * base as a single axis motion, so position controller, homing and
+ * autotune drive any axis the same way.
+ */
+class StepGenerator {
+  public:
+    StepTimeBase* timeBase;
+    // index of axis, selects its pins (see AxisPins.h)
+    uint8_t index;
+    // absolute position, steps. Positive when DIR pin is HIGH
+    volatile long position = 0;
+    // HIGH or LOW level of DIR pin for current move
+    volatile uint8_t direction = LOW;
+    // axis takes part in current motion of time base
+    volatile bool isMoving = false;
+    // distance of group motion follower, steps, 0 when axis does not follow the lead
+    long share = 0;
+    // Bresenham error of follower, lead steps
+    long error = 0;
+
+    StepGenerator(StepTimeBase* timeBase, uint8_t index) {
+      this->timeBase = timeBase;
+      this->index = index;
+      timeBase->axes[index] = this;
+    }
+
+    /**
+     * @param stepsPerSecond cruise speed, shared by all axes
+     */
+    void setMaxSpeed(unsigned int stepsPerSecond) {
+      this->timeBase->setMaxSpeed(stepsPerSecond);
+    }
+
+    /**
+     * @param stepsPerSecondSquared acceleration and deceleration rate, shared by all axes
+     */
+    void setAcceleration(unsigned int stepsPerSecondSquared) {
+      this->timeBase->setAcceleration(stepsPerSecondSquared);
+    }
+
+    /**
+     * @brief runs stepper in given direction until stop() or halt(),
+     * can be called repeatedly, already running move is not restarted
+     *
+     * @param direction HIGH or LOW level of DIR pin
+     */
+    void run(uint8_t direction) {
+      this->timeBase->run(this, direction);
+    }
+
+    /**
+     * @brief moves for given amount of steps, deceleration starts exactly
+     * when steps left to go are equal to steps needed to stop
+     *
+     * @param steps relative distance, sign is direction
+     */
+    void move(long steps) {
+      this->timeBase->move(this, steps);
+    }
+
+    /**
+     * @brief decelerates to rest, group motion the axis takes part in too
+     */
+    void stop() {
+      if (this->isMoving == true) {
+        this->timeBase->stop();
+      }
+    }
+
+    /**
+     * @brief stops immediately, without deceleration
+     */
+    void halt() {
+      if (this->isMoving == true) {
+        this->timeBase->halt();
+      }
+    }
+
+    bool isRunning() {
+      return this->isMoving;
+    }
+
+    /**
+     * @brief tells if axis makes move() of its own, which can be extended
+     */
+    bool hasTarget() {
+      return this->isMoving == true && this->timeBase->lead == this &&
+        this->timeBase->isGroup == false && this->timeBase->hasTarget == true;
+    }
+
+    /**
+     * @brief called from step ISR, pulse is ended by time base
+     */
+    void step() {
+      axisStepHigh(this->index);
+
+      if (this->direction == HIGH) {
+        this->position += 1;
+      } else {
+        this->position -= 1;
+      }
+    }
+
+    void setDirection(uint8_t direction) {
+      this->direction = direction;
+      axisWriteDirection(this->index, direction);
+    }
+};
+
+#endif
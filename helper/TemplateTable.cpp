@@ -0,0 +1,94 @@
+#include <EEPROM.h>
+
+#include "TemplateTable.h"
+#include "Crc8.h"
+
+static const uint8_t endMark = TEMPLATE_TABLE_END_MARK;
+
+//written once, when table is formatted
+static const TemplateRecord defaultTemplates[] PROGMEM = {
+    {"T - shirt", 3000, 0},
+    {"Sweater", 4200, 0},
+    {"Hoody", 5500, 0},
+};
+
+bool TemplateTable::begin() {
+    if (EEPROM.read(TEMPLATE_TABLE_START) != TEMPLATE_TABLE_VERSION) {
+        this->format();
+        return false;
+    }
+
+    this->amount = 0;
+    while (this->amount < TEMPLATE_SLOTS_AMOUNT &&
+        EEPROM.read(this->getAddress(this->amount)) != TEMPLATE_TABLE_END_MARK) {
+        this->amount += 1;
+    }
+
+    return true;
+}
+
+void TemplateTable::format() {
+    TemplateRecord record;
+    uint8_t defaultsAmount = sizeof(defaultTemplates) / sizeof(TemplateRecord);
+
+    //blocking writes, only on the first start of the board
+    for (uint8_t i = 0; i < defaultsAmount; i++) {
+        memcpy_P(&record, &defaultTemplates[i], sizeof(TemplateRecord));
+        record.crc = crc8((uint8_t*)&record, offsetof(TemplateRecord, crc));
+        EEPROM.put(this->getAddress(i), record);
+    }
+    EEPROM.update(this->getAddress(defaultsAmount), TEMPLATE_TABLE_END_MARK);
+    EEPROM.update(TEMPLATE_TABLE_START, TEMPLATE_TABLE_VERSION);
+
+    this->amount = defaultsAmount;
+}
+
+bool TemplateTable::read(uint8_t index, TemplateRecord &record) {
+    if (this->isBusy() == true && index == this->pendingIndex) {
+        record = this->pendingRecord;
+        return true;
+    }
+
+    EEPROM.get(this->getAddress(index), record);
+    if (crc8((uint8_t*)&record, offsetof(TemplateRecord, crc)) != record.crc) {
+        strcpy_P(record.name, PSTR("Damaged"));
+        record.height = 0;
+        return false;
+    }
+
+    return true;
+}
+
+bool TemplateTable::save(uint8_t index, TemplateRecord &record) {
+    if (this->isBusy() == true || index > this->amount || index >= TEMPLATE_SLOTS_AMOUNT) {
+        return false;
+    }
+
+    record.name[TEMPLATE_NAME_LENGTH - 1] = '\0';
+    record.crc = crc8((uint8_t*)&record, offsetof(TemplateRecord, crc));
+
+    this->pendingRecord = record;
+    this->pendingIndex = index;
+
+    //new template, next slot becomes the end of table
+    if (index == this->amount) {
+        this->amount += 1;
+        if (this->amount < TEMPLATE_SLOTS_AMOUNT) {
+            this->writer.start(this->getAddress(index + 1), &endMark, 1);
+            this->isRecordPending = true;
+            return true;
+        }
+    }
+
+    this->writer.start(this->getAddress(index), &this->pendingRecord, sizeof(TemplateRecord));
+    return true;
+}
+
+void TemplateTable::service() {
+    this->writer.service();
+
+    if (this->isRecordPending == true && this->writer.isBusy() == false) {
+        this->isRecordPending = false;
+        this->writer.start(this->getAddress(this->pendingIndex), &this->pendingRecord, sizeof(TemplateRecord));
+    }
+}
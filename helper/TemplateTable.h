@@ -0,0 +1,98 @@
+#ifndef TEMPLATE_TABLE_H
+#define TEMPLATE_TABLE_H
+
+#include <Arduino.h>
+
+#include "EepromRecordWriter.h"
+
+// EEPROM area used by template table, [start; end), position journal is below it
+#define TEMPLATE_TABLE_START 512
+#define TEMPLATE_TABLE_END 1024
+
+// first byte of area, table is formatted with default templates if it differs
+#define TEMPLATE_TABLE_VERSION 1
+// first byte of slot which follows the last template
+#define TEMPLATE_TABLE_END_MARK 0xFF
+
+// name with terminating zero
+#define TEMPLATE_NAME_LENGTH 12
+#define TEMPLATE_MAX_HEIGHT 100000L //um
+
+struct __attribute__((packed)) TemplateRecord {
+  char name[TEMPLATE_NAME_LENGTH];
+  int32_t height; //um, long of AVR
+  uint8_t crc;
+};
+
+#define TEMPLATE_SLOTS_AMOUNT ((TEMPLATE_TABLE_END - TEMPLATE_TABLE_START - 1) / sizeof(TemplateRecord))
+
+/**
+ * @brief Garment templates stored in EEPROM.
+ * Version byte is followed by CRC protected records, table ends at the
+ * first slot which starts with end mark. Nothing but amount is kept in
+ * RAM, windows read the record they show.
+ *
+ * Records are written by EepromRecordWriter. End mark of the next slot
+ * is written before appended record, so torn write never exposes old
+ * data of next slots. Record torn by power loss is reported as damaged
+ * and can be saved again.
+ */
+class TemplateTable {
+  public:
+    uint8_t amount = 0;
+
+    // record which is being written, it waits while writer puts end mark after it
+    TemplateRecord pendingRecord;
+    uint8_t pendingIndex;
+    bool isRecordPending = false;
+    EepromRecordWriter writer;
+
+    /**
+     * @brief counts templates, formats table with default ones if it is
+     * not formatted yet. Needs to be called once in setup()
+     *
+     * @return false if table was formatted
+     */
+    bool begin();
+
+    /**
+     * @brief reads template, scheduled record is returned while it is written
+     *
+     * @param index template index, less than amount
+     * @param record filled with template
+     * @return false if record is damaged
+     */
+    bool read(uint8_t index, TemplateRecord &record);
+
+    /**
+     * @brief schedules template writing, index equal to amount adds new template
+     *
+     * @param index template index
+     * @param record template, crc is calculated here
+     * @return false if index is out of table or previous record is still being written
+     */
+    bool save(uint8_t index, TemplateRecord &record);
+
+    /**
+     * @brief writes next byte of scheduled record if EEPROM is ready,
+     * needs to be called on every loop() pass
+     */
+    void service();
+
+    bool isBusy() {
+      return this->isRecordPending == true || this->writer.isBusy() == true;
+    }
+
+    bool isFull() {
+      return this->amount >= TEMPLATE_SLOTS_AMOUNT;
+    }
+
+  private:
+    int getAddress(uint8_t index) {
+      return TEMPLATE_TABLE_START + 1 + index * sizeof(TemplateRecord);
+    }
+
+    void format();
+};
+
+#endif
@@ -0,0 +1,108 @@
+#include <util/atomic.h>
+
+#include "ToneSequencer.h"
+#include "FastGpio.h"
+
+typedef FastPin<SPEAKER> SpeakerPin;
+
+//Melodies
+static const Note edgeMelody[] PROGMEM = {
+    {2000, 150}, {NOTE_REST, 100}, {2000, 150}, {0, 0},
+};
+static const Note targetMelody[] PROGMEM = {
+    {2500, 60}, {0, 0},
+};
+static const Note errorMelody[] PROGMEM = {
+    {800, 300}, {NOTE_REST, 100}, {800, 300}, {NOTE_REST, 100}, {800, 300}, {0, 0},
+};
+
+static const Note* const melodies[SOUNDS_AMOUNT] PROGMEM = {
+    edgeMelody,
+    targetMelody,
+    errorMelody,
+};
+
+void ToneSequencer::begin() {
+    SpeakerPin::low();
+    SpeakerPin::setOutput();
+    TIMSK1 &= ~_BV(OCIE1B);
+}
+
+bool ToneSequencer::play(uint8_t sound) {
+    if (this->queue.push(sound) == false) {
+        return false;
+    }
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        if (this->isPlaying() == false && this->startMelody() == true) {
+            OCR1B = TCNT1 + this->stepTicks;
+            TIFR1 = _BV(OCF1B);
+            TIMSK1 |= _BV(OCIE1B);
+        }
+    }
+
+    return true;
+}
+
+bool ToneSequencer::startMelody() {
+    uint8_t sound;
+
+    if (this->queue.pop(sound) == false || sound >= SOUNDS_AMOUNT) {
+        return false;
+    }
+
+    this->note = (const Note*)pgm_read_ptr(&melodies[sound]);
+    this->startNote();
+    return true;
+}
+
+void ToneSequencer::startNote() {
+    uint16_t frequency = pgm_read_word(&this->note->frequency);
+    uint16_t duration = pgm_read_word(&this->note->duration);
+
+    this->isNoteSounding = frequency != NOTE_REST;
+#if TONE_ACTIVE_BUZZER
+    this->stepTicks = TONE_STEP_TICKS;
+    this->remainingSteps = duration;
+#else
+    if (this->isNoteSounding == true) {
+        this->stepTicks = STEP_TIMER_FREQUENCY / 2 / frequency;
+        this->remainingSteps = (unsigned long)duration * frequency * 2 / 1000;
+    } else {
+        this->stepTicks = TONE_STEP_TICKS;
+        this->remainingSteps = duration;
+    }
+#endif
+
+    if (this->isNoteSounding == true) {
+        SpeakerPin::high();
+    } else {
+        SpeakerPin::low();
+    }
+}
+
+void ToneSequencer::onTimerCompare() {
+    OCR1B += this->stepTicks;
+
+    if (this->remainingSteps > 1) {
+        this->remainingSteps -= 1;
+#if !TONE_ACTIVE_BUZZER
+        if (this->isNoteSounding == true) {
+            SpeakerPin::toggle();
+        }
+#endif
+        return;
+    }
+
+    this->note += 1;
+    if (pgm_read_word(&this->note->duration) != 0) {
+        this->startNote();
+        return;
+    }
+
+    //melody is over, next one or silence
+    if (this->startMelody() == false) {
+        SpeakerPin::low();
+        TIMSK1 &= ~_BV(OCIE1B);
+    }
+}
@@ -0,0 +1,80 @@
+#ifndef TONE_SEQUENCER_H
+#define TONE_SEQUENCER_H
+
+#include <Arduino.h>
+
+#include "Pins.h"
+#include "StepGenerator.h"
+#include "RingBuffer.h"
+
+// speaker makes its own tone when pin is HIGH, frequency of notes is
+// not generated then, only their timing is kept. 0 for passive speaker
+#define TONE_ACTIVE_BUZZER 1
+
+// one duration step of rests (and of notes on active buzzer), 1 ms in Timer1 ticks
+#define TONE_STEP_TICKS (STEP_TIMER_FREQUENCY / 1000)
+// melodies waiting for speaker, power of 2
+#define TONE_QUEUE_SIZE 8
+
+// sound events, index in melodies table
+#define SOUND_EDGE 0 // edge of allowed moving is reached
+#define SOUND_TARGET 1 // move to target is finished
+#define SOUND_ERROR 2 // position was not restored, stepper lost steps or autotune failed
+#define SOUNDS_AMOUNT 3
+
+#define NOTE_REST 0
+
+/**
+ * @brief Note of melody, melody ends with note of zero duration
+ */
+struct Note {
+  uint16_t frequency; //Hz, NOTE_REST for silence
+  uint16_t duration; //ms
+};
+
+/**
+ * @brief Plays melodies from flash on SPEAKER pin (see Pins.h) by Timer1
+ * compare B interrupt.
+ * Timer1 runs free for StepGenerator (compare A), here OCR1B is pushed
+ * forward by half period of note (or by 1 ms for rests), so timing does
+ * not depend on loop() at all. Sound events are queued by loop() and
+ * played one after another.
+ */
+class ToneSequencer {
+  public:
+    RingBuffer<uint8_t, TONE_QUEUE_SIZE> queue;
+    // note which is played, in flash
+    const Note* note;
+    uint16_t stepTicks;
+    // steps (half periods or ms) left for current note
+    unsigned long remainingSteps;
+    bool isNoteSounding;
+
+    /**
+     * @brief configures speaker pin, needs to be called after StepGenerator::begin()
+     */
+    void begin();
+
+    /**
+     * @brief queues melody of sound event, never waits for speaker
+     *
+     * @param sound SOUND_* event
+     * @return false if queue is full and sound is lost
+     */
+    bool play(uint8_t sound);
+
+    bool isPlaying() {
+      return (TIMSK1 & _BV(OCIE1B)) != 0;
+    }
+
+    /**
+     * @brief needs to be called from ISR(TIMER1_COMPB_vect)
+     */
+    void onTimerCompare();
+
+  private:
+    bool startMelody();
+    void startNote();
+};
+
+#endif
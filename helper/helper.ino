@@ -1,29 +1,33 @@
 #include <U8glib.h>
 #include <GyverTimers.h>
-#include <AccelStepper.h>
 #include <EEPROM.h>
+#include <util/atomic.h>
 
+#include "Pins.h"
 #include "AnalogKeyboard.h"
-
-// keyboard analog reader port number
-#define B_ANALOG_READER A6
-
-// measuremenet digital reader
-#define M_DIGITAL_READER 3
-
-#define BUTTONS_VALUES_WINDOW 100
-
-// buttons analog values
-#define BUTTON_BACK 1010
-#define BUTTON_SELECT 715
-#define BUTTON_LEFT 466
-#define BUTTON_RIGHT 238
-
-// buttons codes
-#define BUTTON_BACK_C 1
-#define BUTTON_SELECT_C 2
-#define BUTTON_LEFT_C 3
-#define BUTTON_RIGHT_C 4
+#include "MenuGraph.h"
+#include "StepGenerator.h"
+#include "Axis.h"
+#include "AxisGroup.h"
+#include "PositionJournal.h"
+#include "TemplateTable.h"
+#include "JobQueue.h"
+#include "JobStore.h"
+#include "DisplayDevice.h"
+#include "DisplayTransmitter.h"
+#include "KeyboardSampler.h"
+#include "Profiler.h"
+#include "SerialProtocol.h"
+#include "Scheduler.h"
+#include "ToneSequencer.h"
+#include "HoldRepeater.h"
+#include "HomingCycle.h"
+#include "MotionTuner.h"
+#include "MotionStore.h"
+
+// pins are defined in Pins.h
+
+// buttons analog values and codes are in KeyboardSampler.h
 
 // consts for map function, which translates default analog
 // signal (0 - 1023) to needed interval
@@ -32,35 +36,33 @@
 // A4 - SDA, A5 - SCK
 U8GLIB_SH1106_128X64 u8g(U8G_I2C_OPT_NONE);
 
-//Step motor
-#define STEP 4
-#define DIR  5
-
-//Sound speaker
-#define SPEAKER 2
-
 //Timers
-unsigned long time;
-unsigned long readerTime;
-unsigned long displayTime;
-unsigned long speakerTime;
+//loop() tasks run by scheduler, see Scheduler.h
+#define TASK_RENDER 0
+#define TASK_HOLD_REPEAT 1
+#define TASK_SCREEN_SAVER 2
+#define TASK_TELEMETRY 3
+
+// periods, ms
+#define RENDER_PERIOD 100 //10 fps
+// screen saver is tried again after this time while platform moves, ms
+#define SCREEN_SAVER_RETRY_TIME 1000
+
+// tasks are defined next to loop()
+void renderFrame();
+void repeatHeldButton();
+void fadeScreen();
+void sendTelemetry();
+
+Scheduler scheduler;
+// speed and step of held LEFT/RIGHT, restarted by every hold event
+HoldRepeater holdRepeater;
 
 // If keyboard needs calibration
 bool isKeyboardDebugEnabled = false;
-// time, when button was pressed
-volatile unsigned long buttonPressedAt;
-// time, when button was pressed
-volatile unsigned long buttonReleasedAt;
-// how long is button pressed
-volatile unsigned long buttonPressingTime;
-// -1 - means buttons are not pressed at all
-// When we have value transition from previouslyPressedButtonCode = -1 to
-// pressedButtonCode = (4,6,etc) we can be sure what a button was pressed.
-// When we have value transition from previouslyPressedButtonCode = (4,6,etc) to
-// pressedButtonCode = -1 we can be sure what a button was released
-volatile int previouslyPressedButtonCode = -1;
+// -1 - means buttons are not pressed at all.
+// Updated by press and release events of keyboard sampler
 volatile int pressedButtonCode = -1;
-volatile unsigned long buttonHoldingTriggeredAt;
 
 volatile int
   currentWindowNumber = 0,
@@ -69,17 +71,15 @@ volatile int
 //Screen 
 int screenFadingTime = 1; //minutes
 volatile bool isRenderAllowed = true;
-volatile bool showScreenSaver = false;
 const unsigned char PROGMEM magentaLogo [] = {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x7F, 0xFF, 0xC0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x7F, 0x1F, 0xC0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x7F, 0xFF, 0xC0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x7F, 0xFF, 0xC0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x7F, 0xFF, 0xC0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x0F, 0xFE, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x0F, 0xFE, 0x00, 0x00, 0x3C, 0x0F, 0x07, 0xC0, 0xFF, 0x9F, 0xF9, 0xC3, 0x8F, 0xFE, 0x07, 0xC0, 0x3C, 0x0F, 0x07, 0xC1, 0xFF, 0x9F, 0xF9, 0xC3, 0x8F, 0xFE, 0x07, 0xC0, 0x3E, 0x1F, 0x0F, 0xE1, 0xE0, 0x1C, 0x01, 0xC3, 0x8F, 0xFE, 0x0F, 0xE0, 0x3E, 0x1F, 0x0F, 0xE1, 0xC0, 0x1C, 0x01, 0xE3, 0x8F, 0xFE, 0x0F, 0xE0, 0x3F, 0x3F, 0x0E, 0xE1, 0xC0, 0x1C, 0x01, 0xF3, 0x8F, 0xFE, 0x0E, 0xE0, 0x3F, 0xFF, 0x1E, 0xF1, 0xC7, 0xDF, 0xF1, 0xFB, 0x8F, 0xFE, 0x1E, 0xF0, 0x3B, 0xF7, 0x1C, 0x71, 0xC7, 0xDF, 0xF1, 0xFF, 0x8F, 0xFE, 0x1C, 0x70, 0x39, 0xE7, 0x1C, 0x71, 0xC1, 0xDC, 0x01, 0xDF, 0x8F, 0xFE, 0x1C, 0x70, 0x38, 0xC7, 0x3F, 0xF9, 0xC1, 0xDC, 0x01, 0xCF, 0x8F, 0xFE, 0x3F, 0xF8, 0x38, 0x07, 0x3F, 0xF9, 0xE3, 0xDC, 0x01, 0xC7, 0x8F, 0xFE, 0x3F, 0xF8, 0x38, 0x07, 0x78, 0x3D, 0xFF, 0xDF, 0xF9, 0xC3, 0x8F, 0xFE, 0x78, 0x3C, 0x38, 0x07, 0x78, 0x3C, 0xFF, 0x9F, 0x99, 0xC3, 0x8F, 0xFE, 0x78, 0x3C, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x60, 0x00, 0x0F, 0xFE, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x60, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x40, 0x00, 0xC0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xC0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1B, 0x9E, 0x63, 0x31, 0xC0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x3F, 0xBE, 0xE7, 0x77, 0xE0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x7F, 0xF7, 0xCE, 0xF7, 0xE0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x7B, 0xF1, 0xCF, 0xE3, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xF7, 0x63, 0xBF, 0xF3, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFE, 0xE3, 0xBD, 0xF7, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFC, 0xC3, 0x99, 0xC6, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0xD8, 0x81, 0x11, 0x86, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0xC0, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x07, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x06, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
 
 // Position reader variables
-bool previousReaderValue = 0;
-bool currentReaderValue = 0;
-volatile int passedHoles = 0; // value of passed holes by detector
+// passed holes are counted by every axis, see Axis.h
 volatile int targetPassedHoles = 0; // value of passed holes by detector
+volatile long targetRemainder = 0; // um above target hole, templates only
 int amountOfHolesOnWheel = 10;
 int degreeToGetOneMilimeter = 250;
-double mmPerHole = 0;
+long umPerHole = 0; // micrometres per reader hole, see getUMperHole
 bool direction = UP;
 
 //Stepper
@@ -87,81 +87,70 @@ volatile bool
   isStepperRunning = false,
   isStepperStopped = false;
 int 
-  stepperSpeed = 200,
-  stepperAcceleration = 50;
+  stepperSpeed = 200, //steps per second, replaced by autotuned value from EEPROM
+  stepperAcceleration = 50, //steps per second^2, replaced by autotuned value from EEPROM
+  stepperApproachSpeed = 40, //steps per second, last holes before target
+  stepperBacklash = 0; //steps, lost motion after reversal, measured on machine
 
-int keyboardDebugging(int analogButtonsReaderPortNumber, bool isMapingEnabled = false)
-{
-  int analogValue = analogRead(analogButtonsReaderPortNumber);
+// Control ISR (stepper supervision) frequency, Hz
+#define CONTROL_TICK_FREQUENCY 1000
 
-  if (isMapingEnabled == true)
-  {
-    Serial.println(map(analogValue, 0, 1023, LOWEST_BUTTON_SIGNAL, HIGHEST_BUTTON_SIGNAL));
-  }
-  else
-  {
-    Serial.println(analogValue);
-  }
-}
+// When control ISR stops stepper by itself. ISR never reads window
+// pointers, loop() sets this value on every window change
+#define STOP_ON_USER 0
+#define STOP_ON_TARGET 1
+#define STOP_ON_ZERO 2
+volatile uint8_t stepperStopMode = STOP_ON_USER;
+
+//Keyboard
+//ADC is busy with free-running conversions of keyboard pin, see ISR(ADC_vect)
+KeyboardSampler keyboard(B_ANALOG_READER);
 
 //Speaker
-bool playSound = false;
+//Melodies are played by Timer1 compare B, see ISR(TIMER1_B)
+ToneSequencer speaker;
 bool isSpeakerTimerSetAllowed = false;
+// set by control ISR when move to target is finished, sound is queued by loop()
+volatile bool isTargetReached = false;
+// set by control ISR when stepper was stopped because it lost steps
+volatile bool isSlipDetected = false;
+// set by control ISR when autotune ends, results are applied by loop()
+volatile bool isTuningFinished = false;
 
-//EEPROM
-//ALSO declared in AnalogKeyboard.cpp in CalibrationWindow::onSelect
-int eepromAddress = 0;
+//Remote control and telemetry, framed binary protocol, see SerialProtocol.h
+SerialProtocol protocol(&Serial);
 
 /**
- * @brief is analog signal value meets requirements + - borderWindowValue to buttonsAnalogReaderValue
- * Example: incoming analog signal = 85, BUTTON_BACK value = 82, border value = 10,
- * if 85-10 < 82 > 85 + 10, return = true
- *
- * @param buttonsAnalogReaderValue incoming value from analog read input
- * @param buttonDefinedValue predefined button value. Example: #defined BUTTON_BACK = 82
- * @param borderWindowValue acceptable window for incoming signal error
- * @return true
- * @return false
+ * @brief sends keyboard ADC value as FRAME_KEYBOARD, the port carries
+ * only protocol frames. Skipped if serial port is busy
  */
-bool isButtonSignalPassed(int buttonsAnalogReaderValue, int buttonDefinedValue, int borderWindowValue)
+void keyboardDebugging(bool isMapingEnabled = false)
 {
-  if (buttonsAnalogReaderValue > (buttonDefinedValue - borderWindowValue) &&
-      buttonsAnalogReaderValue < (buttonDefinedValue + borderWindowValue))
+  ProtocolFrame frame;
+  int analogValue = keyboard.getFilteredValue();
+
+  frame.begin(FRAME_KEYBOARD);
+  if (isMapingEnabled == true)
   {
-    return true;
+    frame.putInt(map(analogValue, 0, 1023, LOWEST_BUTTON_SIGNAL, HIGHEST_BUTTON_SIGNAL));
   }
   else
   {
-    return false;
+    frame.putInt(analogValue);
   }
+  frame.putByte(isMapingEnabled);
+  protocol.sendNow(frame);
 }
 
-/**
- * @brief Get the Pressed Button Code object
- *
- * @param buttonsAnalogReaderValue analog keyboard input value
- * @return int, predefined button code values. If -1, no button pressed
- */
-int getPressedButtonCode(int buttonsAnalogReaderValue)
-{
-  if (isButtonSignalPassed(buttonsAnalogReaderValue, BUTTON_BACK, BUTTONS_VALUES_WINDOW))
-  {
-    return BUTTON_BACK_C;
-  }
-  if (isButtonSignalPassed(buttonsAnalogReaderValue, BUTTON_SELECT, BUTTONS_VALUES_WINDOW))
-  {
-    return BUTTON_SELECT_C;
-  }
-  if (isButtonSignalPassed(buttonsAnalogReaderValue, BUTTON_LEFT, BUTTONS_VALUES_WINDOW))
-  {
-    return BUTTON_LEFT_C;
-  }
-  if (isButtonSignalPassed(buttonsAnalogReaderValue, BUTTON_RIGHT, BUTTONS_VALUES_WINDOW))
-  {
-    return BUTTON_RIGHT_C;
-  }
-  return -1;
-}
+//EEPROM
+//passedHoles of all axes are saved from loop() when stepper is at rest, never from ISR
+PositionJournal positionJournal;
+//Templates are paged from EEPROM by template window
+TemplateTable templateTable;
+//Job (print cycle) is kept in RAM and saved to EEPROM by job editor
+JobStore jobStore;
+//Autotuned speed and acceleration
+MotionStore motionStore;
 
 /**
  * @brief clears display
@@ -176,258 +165,983 @@ void clearDisplay()
 };
 
 /**
- * @brief getting milimeters per reader's hole
+ * @brief getting micrometres per reader's hole
  *
  * @param amountOfHolesOnWheel how much holes in reader's wheel
  * @param degreeToGetOneMilimeter how much degree we need to get one milimeter
- * @return double
+ * @return long
  */
-double getMMperHole(int amountOfHolesOnWheel, double degreeToGetOneMilimeter)
+long getUMperHole(int amountOfHolesOnWheel, int degreeToGetOneMilimeter)
 {
-  double mmPerOneDegree = 1 / degreeToGetOneMilimeter;
-  double mmPerHole = (360 / amountOfHolesOnWheel) * mmPerOneDegree;
-  return mmPerHole;
+  long umPerOneDegree = 360 * UM_PER_MM / amountOfHolesOnWheel;
+  return roundDivide(umPerOneDegree, degreeToGetOneMilimeter);
 }
 
-void playEdgeSound(const int& speakerPin, const unsigned long& speakerTime, bool& playSound) {
-    if (millis() - speakerTime > 0 &&
-        millis() - speakerTime < 150) {
-      digitalWrite(speakerPin, HIGH);
-    }
+//Stepper
+//Pulses of all axes are generated by Timer1, see ISR(TIMER1_A)
+StepTimeBase timeBase;
+
+//Platens, every one with its stepper, reader and position controller
+Axis axes[AXES_AMOUNT] = {
+  {&timeBase, 0},
+#if AXES_AMOUNT > 1
+  {&timeBase, 1},
+#endif
+#if AXES_AMOUNT > 2
+  {&timeBase, 2},
+#endif
+#if AXES_AMOUNT > 3
+  {&timeBase, 3},
+#endif
+};
 
-    if (millis() - speakerTime > 150 &&
-        millis() - speakerTime < 250) {
-      digitalWrite(speakerPin, LOW);
-    }
+//Axis windows move and show, AXIS_ALL moves all of them together.
+//Changed by axis window or remote command, applied by loop() at rest
+volatile uint8_t selectedAxis = 0;
+volatile uint8_t appliedAxis = 0;
+//Axis which is shown, calibrated, homed and tuned, axis 1 when all are selected
+Axis* axis = &axes[0];
 
-    if (millis() - speakerTime > 250 &&
-        millis() - speakerTime < 400) {
-      digitalWrite(speakerPin, HIGH);
-    }
+//Moves all axes to target of semi-auto and template windows, see ISR(TIMER2_A)
+AxisGroup axisGroup(&timeBase, axes);
 
-    if (millis() - speakerTime > 400) {
-      digitalWrite(speakerPin, LOW);
+//Runs job segments one by one from ISR(TIMER2_A)
+JobQueue jobQueue(&targetPassedHoles, &targetRemainder, &isStepperRunning, CONTROL_TICK_FREQUENCY);
 
-      playSound = false;
-    }
-}
+//Automatic zero calibration, driven from ISR(TIMER2_A)
+HomingCycle homing(&axes[0].stepper, &axes[0].estimator, CONTROL_TICK_FREQUENCY);
 
-//Stepper
-//mode, pul, dir
-AccelStepper stepper(1, STEP, DIR);
+//Finds the highest safe speed and acceleration with test moves
+MotionTuner motionTuner(&axes[0].controller);
 
 // Menu windows logic declaration
-MainMenu *mainMenu = new MainMenu("Main menu", 0, 0, 0, magentaLogo, &u8g);
-ScreenSaver *screenSaver = new ScreenSaver("Screen saver", -1, 0, 0, &u8g);
+// Menu structure is in flash (see MenuGraph.cpp), here is one
+// behaviour object per window kind
+MenuWindow menuWindow(WINDOW_MENU, &u8g);
+MainMenu mainMenu(magentaLogo, &u8g);
+ScreenSaver screenSaver(&u8g);
+ManualModeWindow manualModeWindow(&u8g);
+SemiAutomaticModeWindow semiAutoModeWindow(&u8g, &axes[0].passedHoles, &targetPassedHoles, &targetRemainder);
+TemplateWindow templateWindow(&u8g, &templateTable, &axes[0].passedHoles, &targetPassedHoles, &targetRemainder);
+CalibrationWindow calibrationWindow(&u8g, &homing, &motionTuner, &axes[0].slipMonitor);
+JobWindow jobWindow(&u8g, &jobQueue, &jobStore, &axes[0].passedHoles);
+AxisWindow axisWindow(&u8g, &selectedAxis);
+DiagnosticsWindow diagnosticsWindow(&u8g);
 
-EngineControllerMenu *engineControllerMenu = new EngineControllerMenu("Engine control", 1, 1, 3, &u8g);
-ManualModeMenu *manualModeMenu = new ManualModeMenu("Manual control", 11, 1, 2, &u8g);
-ManualModeWindow *manualModeWindow = new ManualModeWindow("Manual control window", 111, 0, 0, &u8g);
-SemiAutomaticModeMenu *semiAutoModeMenu = new SemiAutomaticModeMenu("Semi-auto control", 12, 2, 2, &u8g);
-SemiAutomaticModeWindow *semiAutoModeWindow = new SemiAutomaticModeWindow("Semi-auto control window", 121, 0, 0, &u8g, &passedHoles, &targetPassedHoles);
+// Current window holder
+uint8_t previousWindowId = W_MAIN;
+uint8_t currentWindowId = W_MAIN;
+MenuWindow *currentWindow;
 
-TemplatesMenu *templatesMenu = new TemplatesMenu("Templates", 2, 2, 3, &u8g);
-TShirtTemplate *tShirtTemplate = new TShirtTemplate("T - shirt", 21, 1, 3, 3.0, &passedHoles, &targetPassedHoles, &u8g);
-SweaterTemplate *sweaterTemplate = new SweaterTemplate("Sweater", 22, 2, 3, 4.2, &passedHoles, &targetPassedHoles, &u8g);
-HoodyTemplate *hoodyTemplate = new HoodyTemplate("Hoody", 23, 3, 3, 5.5, &passedHoles, &targetPassedHoles, &u8g);
+/**
+ * @brief Get behaviour object of window kind and point it to the window
+ *
+ * @param id window id from MenuGraph.h
+ * @return MenuWindow*
+ */
+MenuWindow* getWindow(uint8_t id)
+{
+  MenuWindow* window;
 
-CalibrationMenu *calibrationMenu = new CalibrationMenu("Calibration", 3, 3, 3, &u8g);
-CalibrationWindow *calibrationWindow = new CalibrationWindow("Calibration window", 31, 0, 0, &u8g);
+  switch (MENU_NODE_BYTE(id, kind))
+  {
+  case WINDOW_MAIN:
+    window = &mainMenu;
+    break;
 
-// Current window holder
-MenuWindow *previousWindow;
-MenuWindow *currentWindow;
+  case WINDOW_SCREEN_SAVER:
+    window = &screenSaver;
+    break;
 
-void setup()
-{ 
-  EEPROM.get(eepromAddress, passedHoles);
-  mmPerHole = getMMperHole(amountOfHolesOnWheel, degreeToGetOneMilimeter);
-  // Measurement ruler init
-  pinMode(M_DIGITAL_READER, INPUT);
-  pinMode(SPEAKER, OUTPUT);
-  previousReaderValue = digitalRead(M_DIGITAL_READER);
-  currentReaderValue = digitalRead(M_DIGITAL_READER);
+  case WINDOW_MANUAL:
+    window = &manualModeWindow;
+    break;
+
+  case WINDOW_SEMI_AUTO:
+    window = &semiAutoModeWindow;
+    break;
+
+  case WINDOW_TEMPLATE:
+    window = &templateWindow;
+    break;
+
+  case WINDOW_CALIBRATION:
+    window = &calibrationWindow;
+    break;
+
+  case WINDOW_JOB:
+    window = &jobWindow;
+    break;
+
+  case WINDOW_AXIS:
+    window = &axisWindow;
+    break;
 
-  // Menu windows init
-  mainMenu->setPullOfWindows(engineControllerMenu, engineControllerMenu, engineControllerMenu, engineControllerMenu);
-  screenSaver->setPullOfWindows(engineControllerMenu, engineControllerMenu, engineControllerMenu, engineControllerMenu);
+  case WINDOW_DIAGNOSTICS:
+    window = &diagnosticsWindow;
+    break;
+
+  default:
+    window = &menuWindow;
+    break;
+  }
+
+  window->id = id;
+  return window;
+}
+
+/**
+ * @brief passes speed and acceleration to everything that moves stepper,
+ * called from loop() when stepper is at rest
+ */
+void applyMotionSettings()
+{
+  timeBase.setMaxSpeed(stepperSpeed);
+  timeBase.setAcceleration(stepperAcceleration);
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    for (uint8_t i = 0; i < AXES_AMOUNT; i++) {
+      axes[i].controller.setSpeeds(stepperSpeed, stepperApproachSpeed);
+    }
+    homing.setSpeeds(stepperSpeed, stepperApproachSpeed);
+    motionTuner.setSpeeds(stepperSpeed, stepperAcceleration, stepperApproachSpeed);
+  }
+}
 
-  engineControllerMenu->setPullOfWindows(mainMenu, manualModeMenu, calibrationMenu, templatesMenu);
-  manualModeMenu->setPullOfWindows(engineControllerMenu, manualModeWindow, semiAutoModeMenu, semiAutoModeMenu);
-  manualModeWindow->setPullOfWindows(manualModeMenu, nullptr, nullptr, nullptr);
-  semiAutoModeMenu->setPullOfWindows(engineControllerMenu, semiAutoModeWindow, manualModeMenu, manualModeMenu);
-  semiAutoModeWindow->setPullOfWindows(semiAutoModeMenu, nullptr, nullptr, nullptr);
+/**
+ * @brief points windows, homing and autotune to selected axis, called
+ * from loop() when nothing moves
+ */
+void applyAxisSelection()
+{
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    appliedAxis = selectedAxis;
+    axis = &axes[appliedAxis == AXIS_ALL ? 0 : appliedAxis];
+
+    semiAutoModeWindow.passedHoles = &axis->passedHoles;
+    templateWindow.passedHoles = &axis->passedHoles;
+    jobWindow.passedHoles = &axis->passedHoles;
+    calibrationWindow.slipMonitor = &axis->slipMonitor;
+    homing.setAxis(&axis->stepper, &axis->estimator);
+    motionTuner.setAxis(&axis->controller);
+  }
+  currentWindow->markDirty();
+}
 
-  templatesMenu->setPullOfWindows(mainMenu, tShirtTemplate, engineControllerMenu, calibrationMenu);
-  tShirtTemplate->setPullOfWindows(templatesMenu, nullptr, hoodyTemplate, sweaterTemplate);
-  sweaterTemplate->setPullOfWindows(templatesMenu, nullptr, tShirtTemplate, hoodyTemplate);
-  hoodyTemplate->setPullOfWindows(templatesMenu, nullptr, sweaterTemplate, tShirtTemplate);
+/**
+ * @brief tells if anything moves or is going to move platforms
+ */
+bool isMotionBusy()
+{
+  return isStepperRunning == true || timeBase.isRunning() == true ||
+    jobQueue.isRunning() == true || homing.isActive() == true || motionTuner.isActive() == true;
+}
 
-  //Cannot declarate mmPerHole in constructor, so declaring it through setter here
-  tShirtTemplate->setMMPerHole(mmPerHole);
-  sweaterTemplate->setMMPerHole(mmPerHole);
-  hoodyTemplate->setMMPerHole(mmPerHole);
+void setup()
+{ 
+  int restoredHoles[AXES_AMOUNT] = {0};
+  bool isPositionRestored = positionJournal.begin(restoredHoles);
+  templateTable.begin();
+  umPerHole = getUMperHole(amountOfHolesOnWheel, degreeToGetOneMilimeter);
+  // Measurement ruler init
+  for (uint8_t i = 0; i < AXES_AMOUNT; i++) {
+    axes[i].passedHoles = restoredHoles[i];
+    axes[i].encoder.begin();
+    axes[i].estimator.setUMPerHole(umPerHole);
+  }
 
-  calibrationMenu->setPullOfWindows(mainMenu, calibrationWindow, templatesMenu, engineControllerMenu);
-  calibrationWindow->setPullOfWindows(calibrationMenu, nullptr, nullptr, nullptr);
+  //Template heights are converted to reader holes when template is shown
+  templateWindow.setUMPerHole(umPerHole);
+  semiAutoModeWindow.setUMPerHole(umPerHole);
+  jobQueue.setUMPerHole(umPerHole);
+  jobWindow.setUMPerHole(umPerHole);
+  if (jobStore.begin(jobQueue.record) == false) {
+    jobQueue.loadDefault();
+  }
 
-  currentWindow = mainMenu;
-  previousWindow = mainMenu;
+  currentWindow = getWindow(currentWindowId);
 
   //Stepper init
-  // unsigned long stepperTime;
-  stepper.setMaxSpeed(1000);
+  timeBase.begin();
+  motionStore.begin(stepperSpeed, stepperAcceleration);
+  applyMotionSettings();
+  //shares Timer1 with stepper
+  speaker.begin();
+  //nothing in journal, zero has to be calibrated
+  if (isPositionRestored == false) {
+    speaker.play(SOUND_ERROR);
+  }
+  for (uint8_t i = 0; i < AXES_AMOUNT; i++) {
+    axes[i].controller.backlashSteps = stepperBacklash;
+    axes[i].slipMonitor.backlashSteps = stepperBacklash;
+  }
+  homing.begin();
+  homing.backlashSteps = stepperBacklash;
   
+  keyboard.begin();
+  displayDevice.begin(&u8g);
   clearDisplay();
-  Serial.begin(9600);
-  Timer2.setFrequency(1);
+  protocol.begin();
+  Timer2.setFrequency(CONTROL_TICK_FREQUENCY);
   Timer2.enableISR(CHANNEL_A);
-  time = millis();
-  displayTime = millis();
-  readerTime = millis();
-  speakerTime = millis();
-  
-  buttonHoldingTriggeredAt = millis();
-  //This condition (buttonPressedAt and buttonReleasedAt) helps
-  //trigger screenSaver even if button was not pressed (handy for just turned on board)
-  buttonPressedAt = millis() - 1;
-  buttonReleasedAt = millis();
+
+  scheduler.setTask(TASK_RENDER, renderFrame, 20);
+  scheduler.setTask(TASK_HOLD_REPEAT, repeatHeldButton, 10);
+  scheduler.setTask(TASK_SCREEN_SAVER, fadeScreen, 1000);
+  scheduler.setTask(TASK_TELEMETRY, sendTelemetry, 20);
+  scheduler.startPeriodic(TASK_RENDER, RENDER_PERIOD);
+  scheduler.startPeriodic(TASK_TELEMETRY, PROTOCOL_TELEMETRY_PERIOD);
+  //screen saver is shown even if button was not pressed (handy for just turned on board)
+  scheduler.startOnce(TASK_SCREEN_SAVER, 60000UL * screenFadingTime);
 }
 
-ISR(TIMER2_A)
+ISR(TIMER1_A)
 {
+  timeBase.onTimerCompare();
+}
+
+ISR(TIMER1_B)
+{
+  speaker.onTimerCompare();
+}
+
+ISR(TWI_vect)
+{
+  displayTransmitter.onTwiInterrupt();
+}
+
+ISR(ADC_vect)
+{
+  keyboard.onSample(ADC);
+}
+
+ISR(INT1_vect)
+{
+  axes[0].encoder.onEdge();
+}
+
+#if AXES_AMOUNT > 1
+/**
+ * @brief readers of axes 2-4 share pin change interrupts of their ports,
+ * every encoder checks its own pin
+ */
+void watchReaders()
+{
+  for (uint8_t i = 1; i < AXES_AMOUNT; i++) {
+    axes[i].encoder.onPinChange();
+  }
+}
+
+ISR(PCINT0_vect)
+{
+  watchReaders();
+}
+
+ISR(PCINT1_vect)
+{
+  watchReaders();
+}
+
+ISR(PCINT2_vect)
+{
+  watchReaders();
+}
+#endif
+
+/**
+ * @brief tells if platform is on zero or below, any of platforms moved together
+ */
+bool isAtZero(bool isGroup)
+{
+  if (isGroup == false) {
+    return axis->passedHoles <= 0;
+  }
+
+  for (uint8_t i = 0; i < AXES_AMOUNT; i++) {
+    if (axes[i].passedHoles <= 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * @brief reads holes passed by applied axis from loop(), reader ISR writes
+ * the counter and int is read in two bytes
+ */
+int readPassedHoles()
+{
+  int passedHoles;
+
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    passedHoles = axis->passedHoles;
+  }
+  return passedHoles;
+}
+
+/**
+ * @brief control tick: starts, stops and drives stepper, runs in ISR(TIMER2_A)
+ *
+ * @return true if position controller reached target on this tick,
+ * the only stop which ends move of job segment
+ */
+bool superviseStepper()
+{
+  //windows move all axes or the shown one, calibration moves the shown one
+  bool isGroup = appliedAxis == AXIS_ALL && stepperStopMode != STOP_ON_USER;
+
+  for (uint8_t i = 0; i < AXES_AMOUNT; i++) {
+    axes[i].estimator.observe();
+  }
+
+  //Homing drives stepper by itself, stop request cancels it
+  if (homing.isActive() == true) {
+    //platform is stopped by hard stop on purpose
+    axis->slipMonitor.reset();
+    if (isStepperStopped == false) {
+      if (homing.tick() == true) {
+        isTargetReached = true;
+      }
+      return false;
+    }
+    homing.cancel();
+  }
+
+  //every axis is watched, they share time base and stop together
+  bool isSlipped = false;
+  for (uint8_t i = 0; i < AXES_AMOUNT; i++) {
+    if (axes[i].slipMonitor.observe() == true) {
+      isSlipped = true;
+    }
+  }
+
+  //Autotune drives stepper by itself and handles slips of test moves
+  if (motionTuner.isActive() == true) {
+    if (isStepperStopped == false) {
+      if (motionTuner.tick(isSlipped) == true) {
+        isTuningFinished = true;
+      }
+      return false;
+    }
+    motionTuner.cancel();
+    isTuningFinished = true;
+  }
+
+  //Safety stop, position stays right, it is counted by the wheel
+  if (isSlipped == true) {
+    axis->controller.cancel();
+    axisGroup.cancel();
+    jobQueue.cancel();
+    timeBase.halt();
+    isStepperRunning = false;
+    isSlipDetected = true;
+  }
+
   //Stepper
-  if(isStepperStopped == true 
-          //Semi-auto stepper controlling window
-      || (currentWindow->index == 121 && 
-          targetPassedHoles == passedHoles) 
-          //Manual stepper controlling window
-      || (currentWindow->index == 111 &&
-          passedHoles <= 0 && direction == DOWN)
-          //all templates
-      || ((currentWindow->index > 20 && currentWindow->index < 30) && 
-          targetPassedHoles == passedHoles)
-    ) {   
+  //Stop requested by user
+  if (isStepperStopped == true) {
     isStepperRunning = false;
     isStepperStopped = false;
   }
 
-  if (isStepperRunning == true) {   
-    switch (direction)
-    {
-    case UP:
-      stepper.setSpeed(-1 * stepperSpeed);
-      break;
-    
-    case DOWN:
-      stepper.setSpeed(stepperSpeed);
-      break;
+  //Moves to target are driven by position controller, it decelerates
+  //early and stops right on the target hole. Axis group drives them
+  //when all axes are selected
+  if (stepperStopMode == STOP_ON_TARGET || axis->controller.isActive() == true || axisGroup.isActive() == true) {
+    bool isReached = false;
+
+    if (isStepperRunning == true && stepperStopMode == STOP_ON_TARGET) {
+      long target = targetPassedHoles * umPerHole + targetRemainder;
+
+      if (isGroup == true) {
+        axisGroup.moveTo(target);
+        isReached = axisGroup.service();
+      } else {
+        axis->controller.moveTo(target);
+        isReached = axis->controller.service();
+      }
+      if (isReached == true) {
+        isStepperRunning = false;
+        isTargetReached = true;
+      }
+    } else {
+      axis->controller.cancel();
+      axisGroup.cancel();
+      //ramps down if still moving, does nothing at rest
+      timeBase.stop();
+    }
+    return isReached;
+  }
+
+  //Edge reached, stop right on the hole
+  if (stepperStopMode == STOP_ON_ZERO &&
+      isAtZero(isGroup) == true && direction == DOWN) {   
+    if (isStepperRunning == true) {
+      timeBase.halt();
+    }
+    isStepperRunning = false;
+  }
+
+  //UP means negative speed (DIR low), DOWN - positive (DIR high)
+  if (isStepperRunning == true) {
+    if (isGroup == true) {
+      timeBase.runTogether(direction == UP ? LOW : HIGH);
+    } else {
+      axis->stepper.run(direction == UP ? LOW : HIGH);
     }
+  } else {
+    //ramps down if still moving, does nothing at rest
+    timeBase.stop();
+  }
+  return false;
+}
+
+ISR(TIMER2_A)
+{
+  PROFILE_START(controlTick);
+  //next job segment starts on the tick previous one ends
+  jobQueue.tick(superviseStepper());
+  //next tick is already pending, this one took longer than tick period
+  PROFILE_OVERRUN(controlTick, TIFR2 & _BV(OCF2A));
+  PROFILE_STOP(controlTick);
+}
+
+/**
+ * @brief Get the stepper stop mode of window
+ *
+ * @param window window which became current
+ * @return uint8_t STOP_ON_USER, STOP_ON_TARGET or STOP_ON_ZERO
+ */
+uint8_t getStepperStopMode(MenuWindow* window)
+{
+  switch (window->kind)
+  {
+  //Semi-auto stepper controlling window, templates and job
+  case WINDOW_SEMI_AUTO:
+  case WINDOW_TEMPLATE:
+  case WINDOW_JOB:
+    return STOP_ON_TARGET;
+
+  //Manual stepper controlling window
+  case WINDOW_MANUAL:
+    return STOP_ON_ZERO;
+
+  default:
+    return STOP_ON_USER;
+  }
+}
+
+/**
+ * @brief needs to be fired once when current window changes
+ */
+void initCurrentWindow()
+{
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    currentWindow->init(isRenderAllowed);
+    stepperStopMode = getStepperStopMode(currentWindow);
+  }
+  currentWindow->markDirty();
+  //change is handled, init only once
+  previousWindowId = currentWindowId;
+}
 
-    stepper.runSpeed();
+/**
+ * @brief switches to window right away, as if user navigated to it
+ *
+ * @param id window id from MenuGraph.h
+ */
+void showWindow(uint8_t id)
+{
+  currentWindowId = id;
+  currentWindow = getWindow(id);
+  if (previousWindowId != currentWindowId) {
+    initCurrentWindow();
   }
+}
+
+#if PROFILING_ENABLED
+/**
+ * @brief puts min, avg, max (us) and overruns of counter, 16 bit each
+ */
+void putProfileCounter(ProtocolFrame &frame, ProfileCounter counter)
+{
+  frame.putInt(min(counter.getMinimal(), 0xFFFFUL));
+  frame.putInt(min(counter.getAverage(), 0xFFFFUL));
+  frame.putInt(min(counter.getMaximal(), 0xFFFFUL));
+  frame.putInt(counter.overruns);
+}
+#endif
+
+/**
+ * @brief executes commands received by serial protocol, every command
+ * is answered by ACK frame or by requested data
+ */
+void handleSerialCommands()
+{
+  ProtocolFrame command;
+  ProtocolFrame reply;
 
-  // Reader
-  currentReaderValue = digitalRead(M_DIGITAL_READER);
-  if (currentReaderValue == 1 && previousReaderValue == 0)
+  //next command waits in serial RX buffer until reply is sent
+  while (protocol.isReplyPending == false && protocol.receive(command) == true)
   {
-    if (direction == DOWN)
+    uint8_t status = STATUS_OK;
+    bool isStepperBusy = isMotionBusy();
+
+    switch (command.type)
     {
-      passedHoles -= 1;
-      EEPROM.put(eepromAddress, passedHoles);
+    case CMD_GO_TO: {
+      long target = command.getLong(0);
+
+      //same limit as heights set by keyboard, holes of target fit int
+      if (command.length != 4 || target < 0 || target > TEMPLATE_MAX_HEIGHT) {
+        status = STATUS_BAD_ARGUMENT;
+        break;
+      }
+      if (isStepperBusy == true && (stepperStopMode != STOP_ON_TARGET || jobQueue.isRunning() == true)) {
+        status = STATUS_BUSY;
+        break;
+      }
+      //semi-auto window shows the move, running move is retargeted
+      if (currentWindow->kind != WINDOW_SEMI_AUTO) {
+        showWindow(W_SEMI_AUTO);
+      }
+      ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        targetPassedHoles = target / umPerHole;
+        targetRemainder = target % umPerHole;
+        isStepperRunning = true;
+      }
+      break;
     }
-    else
-    {
-      passedHoles += 1;
-      EEPROM.put(eepromAddress, passedHoles);
+
+    case CMD_RUN_TEMPLATE:
+      if (command.length != 1 || command.getByte(0) >= templateTable.amount) {
+        status = STATUS_BAD_ARGUMENT;
+        break;
+      }
+      if (isStepperBusy == true) {
+        status = STATUS_BUSY;
+        break;
+      }
+      //template is read from EEPROM with interrupts enabled, onSelect sets target atomically
+      showWindow(W_TEMPLATE);
+      templateWindow.select(command.getByte(0));
+      currentWindow->onSelect(direction, axis->passedHoles, isStepperRunning, isStepperStopped, CLICK);
+      break;
+
+    case CMD_STOP:
+      ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        jobQueue.cancel();
+        isStepperStopped = true;
+      }
+      currentWindow->markDirty();
+      break;
+
+    case CMD_RUN_JOB:
+      if (isStepperBusy == true) {
+        status = STATUS_BUSY;
+        break;
+      }
+      showWindow(W_JOB);
+      ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        if (jobQueue.start() == false) {
+          status = STATUS_BAD_ARGUMENT;
+        }
+      }
+      break;
+
+    case CMD_HOME:
+      if (isStepperBusy == true) {
+        status = STATUS_BUSY;
+        break;
+      }
+      showWindow(W_HOMING);
+      ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        homing.start();
+      }
+      break;
+
+    case CMD_READ_HOMING:
+      reply.begin(FRAME_HOMING);
+      ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        reply.putByte(homing.state);
+        reply.putByte(homing.runs);
+        reply.putLong(homing.lastTime);
+        reply.putLong(homing.lastDeviation);
+        reply.putLong(homing.deviationSpread);
+      }
+      protocol.sendReply(reply);
+      continue;
+
+    case CMD_TUNE:
+      if (isStepperBusy == true) {
+        status = STATUS_BUSY;
+        break;
+      }
+      showWindow(W_TUNING);
+      ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        if (motionTuner.start() == false) {
+          status = STATUS_BAD_ARGUMENT;
+        }
+      }
+      break;
+
+    case CMD_READ_TUNING:
+      reply.begin(FRAME_TUNING);
+      ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        reply.putByte(motionTuner.state);
+        reply.putInt(motionTuner.speed);
+        reply.putInt(motionTuner.acceleration);
+        reply.putInt(stepperSpeed);
+        reply.putInt(stepperAcceleration);
+        reply.putInt(axis->slipMonitor.slips);
+        reply.putByte(axis->slipMonitor.peakLoad);
+      }
+      protocol.sendReply(reply);
+      continue;
+
+    case CMD_SET_ZERO:
+      if (isStepperBusy == true) {
+        status = STATUS_BUSY;
+        break;
+      }
+      //new zero is saved to EEPROM by position journal, reader ISR
+      //writes the same counter
+      ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        axis->passedHoles = 0;
+      }
+      currentWindow->markDirty();
+      break;
+
+    case CMD_SELECT_AXIS:
+      if (command.length != 1 || (command.getByte(0) >= AXES_AMOUNT && command.getByte(0) != AXIS_ALL)) {
+        status = STATUS_BAD_ARGUMENT;
+        break;
+      }
+      if (isStepperBusy == true) {
+        status = STATUS_BUSY;
+        break;
+      }
+      selectedAxis = command.getByte(0);
+      applyAxisSelection();
+      break;
+
+    case CMD_READ_CONFIG:
+      reply.begin(FRAME_CONFIG);
+      reply.putLong(umPerHole);
+      reply.putInt(stepperSpeed);
+      reply.putInt(stepperAcceleration);
+      reply.putInt(stepperApproachSpeed);
+      reply.putInt(stepperBacklash);
+      reply.putLong(axis->estimator.stepsPerHole);
+      reply.putByte(templateTable.amount);
+      protocol.sendReply(reply);
+      continue;
+
+    case CMD_READ_TEMPLATE: {
+      TemplateRecord record;
+
+      if (command.length != 1 || command.getByte(0) >= templateTable.amount) {
+        status = STATUS_BAD_ARGUMENT;
+        break;
+      }
+      reply.begin(FRAME_TEMPLATE);
+      reply.putByte(command.getByte(0));
+      reply.putByte(templateTable.read(command.getByte(0), record) == true ? STATUS_OK : STATUS_DAMAGED);
+      reply.putLong(record.height);
+      for (uint8_t i = 0; record.name[i] != '\0'; i++) {
+        reply.putByte(record.name[i]);
+      }
+      protocol.sendReply(reply);
+      continue;
     }
+
+    case CMD_WRITE_TEMPLATE: {
+      TemplateRecord record;
+      uint8_t nameLength = command.length - 5;
+
+      //index equal to amount of templates adds new one
+      if (command.length < 6 || nameLength >= TEMPLATE_NAME_LENGTH ||
+          command.getByte(0) > templateTable.amount || (templateTable.isFull() == true && command.getByte(0) == templateTable.amount) ||
+          (long)command.getLong(1) < 0 || (long)command.getLong(1) > TEMPLATE_MAX_HEIGHT) {
+        status = STATUS_BAD_ARGUMENT;
+        break;
+      }
+      //shown template is not overwritten while operator edits it
+      if (currentWindow == &templateWindow && templateWindow.isEditing == true) {
+        status = STATUS_BUSY;
+        break;
+      }
+      record.height = command.getLong(1);
+      memcpy(record.name, &command.payload[5], nameLength);
+      record.name[nameLength] = '\0';
+      if (templateTable.save(command.getByte(0), record) == false) {
+        status = STATUS_BUSY;
+        break;
+      }
+      if (currentWindow == &templateWindow) {
+        templateWindow.select(templateWindow.index);
+      }
+      break;
+    }
+
+    case CMD_READ_TASKS:
+      reply.begin(FRAME_TASKS);
+      for (uint8_t i = TASK_RENDER; i <= TASK_TELEMETRY; i++) {
+        reply.putInt(scheduler.tasks[i].latencyBound / 1000);
+        reply.putInt(min(scheduler.tasks[i].maxLatency, 0xFFFFUL));
+        reply.putInt(scheduler.tasks[i].overruns);
+      }
+      protocol.sendReply(reply);
+      continue;
+
+    case CMD_READ_DISPLAY:
+      reply.begin(FRAME_DISPLAY);
+      reply.putByte(currentWindowId);
+      reply.putByte(displayDevice.validPages);
+      for (uint8_t i = 0; i < DISPLAY_PAGES; i++) {
+        reply.putInt(displayDevice.pageChecksums[i]);
+      }
+      reply.putInt(displayDevice.frameCost.pixelWrites);
+      reply.putByte(displayDevice.frameCost.renderedPages);
+      reply.putByte(displayDevice.frameCost.sentPages);
+      reply.putInt(displayDevice.frameCost.sentBytes);
+      protocol.sendReply(reply);
+      continue;
+
+#if PROFILING_ENABLED
+    case CMD_READ_PROFILE:
+      reply.begin(FRAME_PROFILE);
+      putProfileCounter(reply, profiler.read(profiler.controlTick));
+      putProfileCounter(reply, profiler.read(profiler.loopPass));
+      putProfileCounter(reply, profiler.read(profiler.draw));
+      putProfileCounter(reply, profiler.read(profiler.eepromWrite));
+      protocol.sendReply(reply);
+      continue;
+#endif
+
+    default:
+      status = STATUS_UNKNOWN_COMMAND;
+      break;
+    }
+
+    reply.begin(FRAME_ACK);
+    reply.putByte(command.type);
+    reply.putByte(status);
+    protocol.sendReply(reply);
   }
-  previousReaderValue = digitalRead(M_DIGITAL_READER);
+}
 
-  //Keyboard
-  if ((millis() - time) > 50)
-  {
-    pressedButtonCode = getPressedButtonCode(analogRead(B_ANALOG_READER));
 
+/**
+ * @brief sends position and state, skipped if serial port is busy
+ */
+void sendTelemetry()
+{
+  ProtocolFrame frame;
+  uint8_t flags = 0;
+  int passedHoles = readPassedHoles();
+
+  if (isStepperRunning == true) {
+    flags |= 0x01;
+  }
+  if (timeBase.isRunning() == true) {
+    flags |= 0x02;
+  }
+  if (axis->controller.isActive() == true || axisGroup.isActive() == true) {
+    flags |= 0x04;
+  }
+  if (jobQueue.isRunning() == true) {
+    flags |= 0x08;
+  }
+  if (homing.isActive() == true) {
+    flags |= 0x10;
+  }
+  if (motionTuner.isActive() == true) {
+    flags |= 0x20;
+  }
+
+  frame.begin(FRAME_TELEMETRY);
+  frame.putLong(axis->estimator.getPosition());
+  frame.putInt(passedHoles);
+  frame.putLong(targetPassedHoles * umPerHole + targetRemainder);
+  frame.putByte(flags);
+  frame.putByte(currentWindowId);
+  frame.putByte(appliedAxis);
+  protocol.sendNow(frame);
+}
+
+/**
+ * @brief runs menu state machine on key events queued by ISR(ADC_vect).
+ * Handlers run with interrupts enabled, they read EEPROM and format
+ * strings. Each of them writes state shared with control ISR (target,
+ * passed holes, job queue, homing) in its own short atomic block, one
+ * byte stepper flags are set last
+ */
+void handleKeyEvents()
+{
+  KeyEvent keyEvent;
+
+  while (keyboard.popEvent(keyEvent) == true)
+  {
     // on click
-    // pressedButtonCode
-    if (previouslyPressedButtonCode == -1 && pressedButtonCode != -1)
+    if (keyEvent.type == KEY_PRESS)
     {
-      buttonPressedAt = millis();
+      pressedButtonCode = keyEvent.code;
+      scheduler.stop(TASK_SCREEN_SAVER);
 
-      switch (pressedButtonCode)
+      switch (keyEvent.code)
       {
       case BUTTON_BACK_C:
-        previousWindow = currentWindow;
-        currentWindow = currentWindow->onBack(isStepperStopped);
+        currentWindowId = currentWindow->onBack(isStepperStopped);
         break;
 
       case BUTTON_SELECT_C:
-        previousWindow = currentWindow;
-        currentWindow = currentWindow->onSelect(direction, passedHoles, isStepperRunning, isStepperStopped, CLICK);
+        currentWindowId = currentWindow->onSelect(direction, axis->passedHoles, isStepperRunning, isStepperStopped, CLICK);
         break;
 
       case BUTTON_LEFT_C:
-        previousWindow = currentWindow;
-        currentWindow = currentWindow->onLeft(direction, isStepperRunning, isStepperStopped, isSpeakerTimerSetAllowed, CLICK);
+        currentWindowId = currentWindow->onLeft(direction, isStepperRunning, isStepperStopped, isSpeakerTimerSetAllowed, CLICK);
         break;
 
       case BUTTON_RIGHT_C:
-        previousWindow = currentWindow;
-        currentWindow = currentWindow->onRight(direction, isStepperRunning, isStepperStopped, isSpeakerTimerSetAllowed, CLICK);
+        currentWindowId = currentWindow->onRight(direction, isStepperRunning, isStepperStopped, isSpeakerTimerSetAllowed, CLICK);
         break;
       
       default:
         break;
       }
+      currentWindow = getWindow(currentWindowId);
     } 
 
+    // on holding, repeated clicks are made by hold repeat task
+    if (keyEvent.type == KEY_HOLD)
+    {
+      holdRepeater.start();
+      scheduler.startOnce(TASK_HOLD_REPEAT, holdRepeater.getPeriod());
+    }
+
     // on release
-    // buttonPressingTime, previouslyPressedButtonCode
-    if (previouslyPressedButtonCode != -1 && pressedButtonCode == -1)
+    if (keyEvent.type == KEY_RELEASE)
     {
-      buttonReleasedAt = millis();
-      buttonPressingTime = buttonReleasedAt - buttonPressedAt;
-      //makes those variables = 0, becouse we need to reset their values for proper
-      //tracking of button holding
-      // buttonPressedAt = 0;
-      // buttonReleasedAt = 0;
-      // buttonPressingTime = 0;
-
-      switch (previouslyPressedButtonCode)
+      pressedButtonCode = -1;
+      scheduler.stop(TASK_HOLD_REPEAT);
+      scheduler.startOnce(TASK_SCREEN_SAVER, 60000UL * screenFadingTime);
+
+      switch (keyEvent.code)
       {
       case BUTTON_BACK_C:
-        // previousWindow = currentWindow;
-        // currentWindow = currentWindow->onBack(isStepperStopped);
+        // currentWindowId = currentWindow->onBack(isStepperStopped);
         break;
 
       case BUTTON_SELECT_C:
-        previousWindow = currentWindow;
-        currentWindow = currentWindow->onSelect(direction, passedHoles, isStepperRunning, isStepperStopped, RELEASE);
+        currentWindowId = currentWindow->onSelect(direction, axis->passedHoles, isStepperRunning, isStepperStopped, RELEASE);
         break;
 
       case BUTTON_LEFT_C:
-        previousWindow = currentWindow;
-        currentWindow = currentWindow->onLeft(direction, isStepperRunning, isStepperStopped, isSpeakerTimerSetAllowed, RELEASE);
+        currentWindowId = currentWindow->onLeft(direction, isStepperRunning, isStepperStopped, isSpeakerTimerSetAllowed, RELEASE);
         break;
 
       case BUTTON_RIGHT_C:
-        previousWindow = currentWindow;
-        currentWindow = currentWindow->onRight(direction, isStepperRunning, isStepperStopped, isSpeakerTimerSetAllowed, RELEASE);
+        currentWindowId = currentWindow->onRight(direction, isStepperRunning, isStepperStopped, isSpeakerTimerSetAllowed, RELEASE);
         break;
 
       default:
         break;
       }
+      currentWindow = getWindow(currentWindowId);
+    }
+  }
+}
+
+/**
+ * @brief renders current window if its content changed, frame is sent to
+ * display page by page, only changed pages (see DisplayDevice).
+ * Position is interpolated between reader holes (see PositionEstimator)
+ */
+void renderFrame()
+{
+  if (isRenderAllowed == false) {
+    return;
+  }
+
+  long position = axis->estimator.getPosition();
+
+  //page which display did not acknowledge is sent again even if
+  //nothing on window changed
+  if (displayDevice.dropFailedPages() == true) {
+    currentWindow->markDirty();
+  }
+
+  if (currentWindow->isDirty(position) == false) {
+    return;
+  }
+
+  PROFILE_START(draw);
+  //shared state is read and strings are formatted once per frame, not per page
+  currentWindow->prepare(position, umPerHole);
+  u8g.firstPage();
+  do
+  {
+    currentWindow->draw();
+  } while (u8g.nextPage());
+  PROFILE_STOP(draw);
+
+  currentWindow->markRendered(position);
+}
+
+/**
+ * @brief repeats held LEFT/RIGHT, started by hold event and restarted
+ * by itself with period of current hold stage (see HoldRepeater)
+ */
+void repeatHeldButton()
+{
+  int8_t stepDirection = 0;
+
+  if (pressedButtonCode == BUTTON_LEFT_C) {
+    stepDirection = -1;
+  }
+  if (pressedButtonCode == BUTTON_RIGHT_C) {
+    stepDirection = 1;
+  }
+
+  if (stepDirection == 0 || currentWindow->isRepeatable() == false) {
+    return;
+  }
+
+  long step = holdRepeater.getStep();
+
+  //handlers write shared state atomically themselves, see handleKeyEvents
+  if (step == 0 || currentWindow->onHoldStep(stepDirection, step) == false) {
+    if (stepDirection < 0) {
+      currentWindow->onLeft(direction, isStepperRunning, isStepperStopped, isSpeakerTimerSetAllowed, CLICK);
+    } else {
+      currentWindow->onRight(direction, isStepperRunning, isStepperStopped, isSpeakerTimerSetAllowed, CLICK);
     }
+  }
 
-    previouslyPressedButtonCode = getPressedButtonCode(analogRead(B_ANALOG_READER));
-    time = millis();
+  holdRepeater.advance();
+  scheduler.startOnce(TASK_HOLD_REPEAT, holdRepeater.getPeriod());
+}
+
+/**
+ * @brief shows screen saver, started when button is released
+ */
+void fadeScreen()
+{
+  //screen does not fade while platform moves
+  if (isStepperRunning == true || jobQueue.isRunning() == true) {
+    scheduler.startOnce(TASK_SCREEN_SAVER, SCREEN_SAVER_RETRY_TIME);
+    return;
   }
+
+  screenSaver.returnId = currentWindowId;
+  showWindow(W_SCREEN_SAVER);
+  clearDisplay();
 }
 
 void loop()
 {  
+  PROFILE_START(loopPass);
+
   // Keyboard
   if (isKeyboardDebugEnabled != true)
   {
@@ -436,101 +1150,107 @@ void loop()
   else
   {
     // Put some debug here
-    keyboardDebugging(B_ANALOG_READER, false);
-  }
-
-  // Show screen saver trigger
-  if (millis() - buttonReleasedAt > 60000 * screenFadingTime && 
-      showScreenSaver == false && 
-      buttonReleasedAt > buttonPressedAt &&
-      isStepperRunning == false) {
-    showScreenSaver = true;
+    keyboardDebugging(false);
   }
 
-  //buttonReleasedAt < buttonPressedAt means what button has been pressed
-  //millis() - buttonPressedAt > 1000 pressed more than 1000 in this case
-  if (millis() - buttonPressedAt > 1000 && buttonReleasedAt <= buttonPressedAt) {
-    if (millis() - buttonHoldingTriggeredAt > 50) {
-      //Semi auto window button holding
-      if (currentWindow->index == 121) {
-        if (pressedButtonCode == BUTTON_LEFT_C) {
-          currentWindow->onLeft(direction, isStepperRunning, isStepperStopped, isSpeakerTimerSetAllowed, CLICK);
-        }
-        if (pressedButtonCode == BUTTON_RIGHT_C) {
-          currentWindow->onRight(direction, isStepperRunning, isStepperStopped, isSpeakerTimerSetAllowed, CLICK);
-        }
-      }
-      buttonHoldingTriggeredAt = millis();
-    }
-  }
-
-  // Shows screen saver
-  if (showScreenSaver == true && isRenderAllowed == true) {
-    screenSaver->setPullOfWindows(currentWindow, currentWindow, currentWindow, currentWindow);
-    currentWindow = screenSaver;
-    u8g.firstPage();
-    do
-    {
-      currentWindow->draw(passedHoles, mmPerHole);
-    } while (u8g.nextPage());
-    previouslyPressedButtonCode = -1;
-    pressedButtonCode = 0;
-  }
+  handleKeyEvents();
 
   //Track window changing 
-  if (previousWindow->index != currentWindow->index) {
-    if (currentWindow->index != -1) {
-      showScreenSaver = false;
-    }
-    currentWindow->init(isRenderAllowed);
+  if (previousWindowId != currentWindowId) {
+    initCurrentWindow();
   }
 
-  //Allow render with 10 fps and when current screen is not a screenSaver
-  if (isRenderAllowed == true) {
-    if ((millis() - displayTime) > 1000 / 10) {
-      u8g.firstPage();
-      do
-      {
-        currentWindow->draw(passedHoles, mmPerHole);
-      } while (u8g.nextPage());
-
-      displayTime = millis();
-    }
-  }
+  //Render, hold repeat, sound, screen saver and telemetry
+  scheduler.run();
 
   //Speaker
   //Play sound on manual window stepper controller
   //when user trying to rise platform more then calibrated
   //zero level (Manual mode window)
-  if (currentWindow->index == 111 &&
+  int passedHoles = readPassedHoles();
+
+  if (currentWindow->kind == WINDOW_MANUAL &&
       passedHoles <= 0 && direction == DOWN && 
       pressedButtonCode == BUTTON_LEFT_C &&
       isSpeakerTimerSetAllowed == false &&
-      playSound == false) {
+      speaker.isPlaying() == false) {
     isSpeakerTimerSetAllowed = true;
   }
 
   //(Semi-auto mode window)
-  if (currentWindow->index == 121 &&
+  if (currentWindow->kind == WINDOW_SEMI_AUTO &&
       targetPassedHoles - 1 < 0 &&
       pressedButtonCode == BUTTON_LEFT_C &&
       isSpeakerTimerSetAllowed == false &&
-      playSound == false) {
+      speaker.isPlaying() == false) {
     isSpeakerTimerSetAllowed = true;
   }
 
   //Sound playing
   //If we need to play "stop" or "edge" sound, we need to set
-  //"isSpeakerTimerSetAllowed" variable to true. To stop playing this sound
-  //we need to set "playSound" variable to false
-  if (isSpeakerTimerSetAllowed == true && playSound == false) {
-    Serial.println("sound played");
-    speakerTime = millis();
+  //"isSpeakerTimerSetAllowed" variable to true, it is queued to speaker
+  if (isSpeakerTimerSetAllowed == true) {
     isSpeakerTimerSetAllowed = false;
-    playSound = true;
+    speaker.play(SOUND_EDGE);
+  }
+
+  if (isTargetReached == true) {
+    isTargetReached = false;
+    speaker.play(SOUND_TARGET);
   }
 
-  if (playSound == true) {
-    playEdgeSound(SPEAKER, speakerTime, playSound);
+  if (isSlipDetected == true) {
+    isSlipDetected = false;
+    speaker.play(SOUND_ERROR);
   }
+
+  //Autotune
+  //Test moves are configured here, c0 of acceleration is not calculated in ISR
+  motionTuner.service();
+  //Tuned values are used and saved, test levels are dropped in any case
+  if (isTuningFinished == true) {
+    isTuningFinished = false;
+    if (motionTuner.state == TUNING_DONE) {
+      stepperSpeed = motionTuner.tunedSpeed;
+      stepperAcceleration = motionTuner.tunedAcceleration;
+      motionStore.save(stepperSpeed, stepperAcceleration);
+      speaker.play(SOUND_TARGET);
+    } else if (motionTuner.state == TUNING_FAILED) {
+      speaker.play(SOUND_ERROR);
+    }
+    applyMotionSettings();
+  }
+
+  //Axis selection
+  //Windows, homing and autotune are pointed to new axis once everything is at rest
+  if (selectedAxis != appliedAxis && isMotionBusy() == false) {
+    applyAxisSelection();
+  }
+
+  //Position saving
+  //Record is scheduled once stepper is at rest and written byte by byte
+  if (isStepperRunning == false && timeBase.isRunning() == false) {
+    int holes[AXES_AMOUNT];
+
+    //one snapshot of all axes, reader ISR may still count a hole
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+      for (uint8_t i = 0; i < AXES_AMOUNT; i++) {
+        holes[i] = axes[i].passedHoles;
+      }
+    }
+    positionJournal.commit(holes);
+  }
+  positionJournal.service();
+  templateTable.service();
+  jobStore.service();
+  motionStore.service();
+
+  //Remote control
+  handleSerialCommands();
+  protocol.service();
+
+  PROFILE_STOP(loopPass);
+
+  //Sleep until the next interrupt, if no task is due
+  scheduler.idle();
 }
\ No newline at end of file
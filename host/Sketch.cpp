@@ -0,0 +1,5 @@
+// helper.ino as Arduino builder compiles it: core header first, the
+// sketch is C++ source then
+#include <Arduino.h>
+
+#include "helper.ino"
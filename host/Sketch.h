@@ -0,0 +1,38 @@
+#ifndef HOST_SKETCH_H
+#define HOST_SKETCH_H
+
+// Globals and functions of helper.ino which tests and benchmark drive
+
+#include <U8glib.h>
+
+#include "AnalogKeyboard.h"
+#include "StepGenerator.h"
+#include "MotionTuner.h"
+
+extern U8GLIB_SH1106_128X64 u8g;
+extern StepTimeBase timeBase;
+extern Axis axes[AXES_AMOUNT];
+extern volatile int targetPassedHoles;
+extern volatile long targetRemainder;
+extern long umPerHole;
+extern bool direction;
+extern volatile bool isStepperRunning;
+extern volatile bool isStepperStopped;
+extern bool isSpeakerTimerSetAllowed;
+extern TemplateTable templateTable;
+extern TemplateWindow templateWindow;
+extern MotionTuner motionTuner;
+extern int stepperSpeed;
+extern int stepperAcceleration;
+extern MenuWindow* currentWindow;
+extern uint8_t currentWindowId;
+
+void setup();
+void loop();
+void showWindow(uint8_t id);
+void renderFrame();
+bool superviseStepper();
+
+extern "C" void TIMER2_COMPA_vect(void);
+
+#endif
@@ -0,0 +1,188 @@
+// Timing of the sketch on host: control ISR, prepare() and draw() of
+// every window, onSelect/onLeft/onRight of every window. Host CPU is
+// not ATmega328, numbers are for comparing builds with each other,
+// call counts and render work (ops, pixels, bus bytes) are exact.
+//
+// usage: helper_bench [iterations]
+
+#include <chrono>
+
+#include <HostBoard.h>
+#include <GyverTimers.h>
+
+#include "Sketch.h"
+
+// reader wheel of the bench: steps of axis 1 per hole, half of it is the hole
+#define BENCH_STEPS_PER_HOLE 40
+
+/**
+ * @brief per-call time of one function, ns
+ */
+class Timing {
+  public:
+    unsigned long calls = 0;
+    unsigned long long total = 0;
+    unsigned long long worst = 0;
+
+    template<typename Call> void measure(Call call) {
+      std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+      call();
+      unsigned long long spent = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count();
+
+      this->calls += 1;
+      this->total += spent;
+      if (spent > this->worst) {
+        this->worst = spent;
+      }
+    }
+
+    unsigned long long getAverage() {
+      return this->calls == 0 ? 0 : this->total / this->calls;
+    }
+};
+
+static void printTiming(const char* name, Timing& timing) {
+  printf("  %-22s %8lu calls %8llu ns avg %8llu ns worst\n", name, timing.calls, timing.getAverage(), timing.worst);
+}
+
+/**
+ * @brief turns reader wheel of axis 1 by its stepper, rising edge on every hole
+ */
+static void turnWheel() {
+  long phase = axes[0].stepper.position % BENCH_STEPS_PER_HOLE;
+
+  if (phase < 0) {
+    phase += BENCH_STEPS_PER_HOLE;
+  }
+  hostBoard.setPin(M_DIGITAL_READER, phase < BENCH_STEPS_PER_HOLE / 2 ? HIGH : LOW);
+}
+
+/**
+ * @brief runs control ticks, every one is 1 ms of board time with
+ * step pulses of Timer1 and reader edges between ticks
+ */
+static void benchControlTicks(const char* name, unsigned long ticks) {
+  Timing timing;
+
+  for (unsigned long i = 0; i < ticks; i++) {
+    hostBoard.advance(1000);
+    turnWheel();
+    timing.measure([] { TIMER2_COMPA_vect(); });
+  }
+  printTiming(name, timing);
+  printf("  %-22s %8ld steps %8d holes\n", "", (long)axes[0].stepper.position, (int)axes[0].passedHoles);
+}
+
+static void benchControlIsr(unsigned long ticks) {
+  printf("control ISR (superviseStepper + job queue), per 1 ms tick\n");
+
+  showWindow(W_MAIN);
+  benchControlTicks("idle", ticks);
+
+  //jog up from zero, position is counted by the wheel
+  showWindow(W_MANUAL);
+  direction = UP;
+  isStepperRunning = true;
+  benchControlTicks("manual jog", ticks);
+  isStepperStopped = true;
+  benchControlTicks("manual stop", ticks / 4 + 1);
+
+  //move to target of semi-auto window
+  showWindow(W_SEMI_AUTO);
+  targetPassedHoles = axes[0].passedHoles + 20;
+  targetRemainder = 0;
+  isStepperRunning = true;
+  benchControlTicks("target move", ticks);
+
+  isStepperStopped = true;
+  benchControlTicks("target stop", ticks / 4 + 1);
+}
+
+static void benchWindows(unsigned long frames) {
+  printf("windows, prepare() once per frame, draw() once per page, work of one frame\n");
+  printf("  %-3s %-10s %-10s %-10s %-10s %5s %6s %5s %6s\n",
+    "id", "prep avg", "prep worst", "draw avg", "draw worst", "ops", "pixels", "ink", "bus");
+
+  for (uint8_t id = 0; id < MENU_WINDOWS_AMOUNT; id++) {
+    Timing prepare;
+    Timing draw;
+    unsigned int ops = 0;
+    unsigned int pixels = 0;
+    unsigned int ink = 0;
+    unsigned long busBytes = 0;
+
+    showWindow(id);
+    for (unsigned long i = 0; i < frames; i++) {
+      long position = axes[0].estimator.getPosition();
+      unsigned long busStart = hostBoard.displayBusBytes;
+
+      prepare.measure([position] { currentWindow->prepare(position, umPerHole); });
+      u8g.firstPage();
+      do {
+        draw.measure([] { currentWindow->draw(); });
+      } while (u8g.nextPage());
+      //frames after the first one repeat it, their pages are not sent
+      if (i == 0) {
+        busBytes = hostBoard.displayBusBytes - busStart;
+      }
+    }
+
+    for (uint8_t page = 0; page < HOST_DISPLAY_PAGES; page++) {
+      ops += u8g.pageCosts[page].drawOps;
+      pixels += u8g.pageCosts[page].pixelWrites;
+      ink += u8g.pageCosts[page].inkBytes;
+    }
+
+    printf("  %-3u %-10llu %-10llu %-10llu %-10llu %5u %6u %5u %6lu\n",
+      id, prepare.getAverage(), prepare.worst, draw.getAverage(), draw.worst, ops, pixels, ink, busBytes);
+  }
+}
+
+static void benchHandlers(unsigned long presses) {
+  printf("handlers, click and release of every window, ns avg/worst\n");
+  printf("  %-3s %-17s %-17s %-17s\n", "id", "onSelect", "onLeft", "onRight");
+
+  for (uint8_t id = 0; id < MENU_WINDOWS_AMOUNT; id++) {
+    Timing select;
+    Timing left;
+    Timing right;
+
+    showWindow(id);
+    for (unsigned long i = 0; i < presses; i++) {
+      for (int mode = CLICK; mode <= RELEASE; mode++) {
+        select.measure([mode] {
+          currentWindow->onSelect(direction, axes[0].passedHoles, isStepperRunning, isStepperStopped, mode);
+        });
+        left.measure([mode] {
+          currentWindow->onLeft(direction, isStepperRunning, isStepperStopped, isSpeakerTimerSetAllowed, mode);
+        });
+        right.measure([mode] {
+          currentWindow->onRight(direction, isStepperRunning, isStepperStopped, isSpeakerTimerSetAllowed, mode);
+        });
+      }
+      //whatever handlers started is stopped, window stays the same
+      isStepperStopped = true;
+      hostBoard.advance(1000);
+      TIMER2_COMPA_vect();
+    }
+
+    printf("  %-3u %7llu/%-9llu %7llu/%-9llu %7llu/%-9llu\n", id,
+      select.getAverage(), select.worst, left.getAverage(), left.worst, right.getAverage(), right.worst);
+  }
+}
+
+int main(int argc, char** argv) {
+  unsigned long iterations = argc > 1 ? strtoul(argv[1], NULL, 10) : 1000;
+
+  setup();
+  //control ticks are called by the bench itself, between them time runs
+  Timer2.disableISR(CHANNEL_A);
+  turnWheel();
+
+  benchControlIsr(iterations);
+  benchWindows(iterations / 10 + 1);
+  benchHandlers(iterations / 10 + 1);
+
+  return 0;
+}
@@ -0,0 +1,84 @@
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+// Arduino core of host build, only what the sketch uses.
+// Registers are plain variables (see avr/io.h), time and interrupts are
+// driven by HostBoard.h
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <math.h>
+
+#include <avr/io.h>
+#include <avr/pgmspace.h>
+#include <avr/interrupt.h>
+
+#include "Print.h"
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define F_CPU 16000000UL
+
+#define HIGH 1
+#define LOW 0
+
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+
+#define CHANGE 1
+#define FALLING 2
+#define RISING 3
+
+// analog pins of Nano, digital numbers
+#define A0 14
+#define A1 15
+#define A2 16
+#define A3 17
+#define A4 18
+#define A5 19
+#define A6 20
+#define A7 21
+
+#define digitalPinToInterrupt(p) ((p) == 2 ? 0 : ((p) == 3 ? 1 : -1))
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+#ifndef min
+#define min(a, b) ((a) < (b) ? (a) : (b))
+#define max(a, b) ((a) > (b) ? (a) : (b))
+#endif
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t level);
+int digitalRead(uint8_t pin);
+int analogRead(uint8_t pin);
+
+unsigned long millis();
+unsigned long micros();
+
+long map(long value, long fromLow, long fromHigh, long toLow, long toHigh);
+
+char* itoa(int value, char* string, int radix);
+char* ltoa(long value, char* string, int radix);
+
+/**
+ * @brief Serial port of host, written bytes are kept for the test or
+ * CLI which reads them, received bytes are queued by HostBoard
+ */
+class HardwareSerial : public Print {
+  public:
+    void begin(unsigned long baud);
+    int available();
+    int read();
+    int availableForWrite();
+    size_t write(uint8_t value);
+    using Print::write;
+};
+
+extern HardwareSerial Serial;
+
+#endif
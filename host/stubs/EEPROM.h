@@ -0,0 +1,57 @@
+#ifndef HOST_EEPROM_H
+#define HOST_EEPROM_H
+
+#include <stdint.h>
+
+// 1 KB of ATmega328
+#define E2END 0x3FF
+
+/**
+ * @brief EEPROM of host build, kept in RAM. Erased cells read 0xFF.
+ * Writes are counted, so tests can cut power after any of them
+ */
+class EEPROMClass {
+  public:
+    uint8_t cells[E2END + 1];
+    // bytes really written (update() skips equal ones)
+    unsigned long writes = 0;
+    // update() is ignored once writes reach it, power cut emulation
+    unsigned long writeLimit = 0xFFFFFFFFUL;
+
+    EEPROMClass() {
+      this->erase();
+    }
+
+    void erase();
+
+    uint8_t read(int address);
+    void write(int address, uint8_t value);
+    void update(int address, uint8_t value);
+
+    uint16_t length() {
+      return E2END + 1;
+    }
+
+    template<typename T> T& get(int address, T& value) {
+      for (unsigned int i = 0; i < sizeof(T); i++) {
+        ((uint8_t*)&value)[i] = this->read(address + i);
+      }
+      return value;
+    }
+
+    template<typename T> const T& put(int address, const T& value) {
+      for (unsigned int i = 0; i < sizeof(T); i++) {
+        this->update(address + i, ((const uint8_t*)&value)[i]);
+      }
+      return value;
+    }
+};
+
+extern EEPROMClass EEPROM;
+
+// avr-libc, write of previous byte is finished at once on host
+inline bool eeprom_is_ready() {
+  return true;
+}
+
+#endif
@@ -0,0 +1,43 @@
+#ifndef HOST_GYVER_TIMERS_H
+#define HOST_GYVER_TIMERS_H
+
+#include <stdint.h>
+
+#define CHANNEL_A 0x00
+#define CHANNEL_B 0x01
+
+#define TIMER2_A TIMER2_COMPA_vect
+#define TIMER1_A TIMER1_COMPA_vect
+#define TIMER1_B TIMER1_COMPB_vect
+
+/**
+ * @brief GyverTimers of host build, compare A interrupt of timer is
+ * called by HostBoard::advance() every period once enabled
+ */
+class Timer_x {
+  public:
+    uint32_t period = 0;
+    bool isEnabled = false;
+
+    uint32_t setFrequency(uint32_t frequency) {
+      this->period = 1000000UL / frequency;
+      return frequency;
+    }
+
+    uint32_t setPeriod(uint32_t period) {
+      this->period = period;
+      return period;
+    }
+
+    void enableISR(uint8_t channel = CHANNEL_A) {
+      this->isEnabled = true;
+    }
+
+    void disableISR(uint8_t channel = CHANNEL_A) {
+      this->isEnabled = false;
+    }
+};
+
+extern Timer_x Timer2;
+
+#endif
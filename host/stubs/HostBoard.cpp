@@ -0,0 +1,369 @@
+#include <EEPROM.h>
+#include <GyverTimers.h>
+
+#include "HostBoard.h"
+
+// TWI status codes of master transmitter
+#define TWI_START 0x08
+#define TWI_REPEATED_START 0x10
+#define TWI_SLA_ACK 0x18
+#define TWI_SLA_NACK 0x20
+#define TWI_DATA_ACK 0x28
+
+// Timer0 overflows every 1024 us (prescaler 64), it triggers ADC
+#define HOST_ADC_PERIOD 1024
+
+// interrupt vectors, defined by the sketch if it uses them
+extern "C" {
+  void TIMER1_COMPA_vect(void) __attribute__((weak));
+  void TIMER1_COMPB_vect(void) __attribute__((weak));
+  void TIMER2_COMPA_vect(void) __attribute__((weak));
+  void ADC_vect(void) __attribute__((weak));
+  void TWI_vect(void) __attribute__((weak));
+  void INT0_vect(void) __attribute__((weak));
+  void INT1_vect(void) __attribute__((weak));
+  void PCINT0_vect(void) __attribute__((weak));
+  void PCINT1_vect(void) __attribute__((weak));
+  void PCINT2_vect(void) __attribute__((weak));
+}
+
+volatile uint8_t TCCR1A, TCCR1B, TIMSK1, TIFR1;
+volatile uint16_t TCNT1, OCR1A, OCR1B;
+volatile uint8_t TCCR2A, TCCR2B, TCNT2, OCR2A, TIMSK2, TIFR2;
+volatile uint8_t ADMUX, ADCSRA, ADCSRB;
+volatile uint16_t ADC;
+volatile uint8_t EICRA, EIMSK, EIFR, PCICR, PCMSK0, PCMSK1, PCMSK2;
+volatile uint8_t PORTB, PORTC, PORTD, PINB, PINC, PIND, DDRB, DDRC, DDRD;
+volatile uint8_t TWBR, TWSR, TWDR;
+HostTwiControl TWCR;
+
+HostBoard hostBoard;
+HardwareSerial Serial;
+EEPROMClass EEPROM;
+Timer_x Timer2;
+
+static void callVector(void (*vector)(void)) {
+    if (vector != NULL) {
+        vector();
+    }
+}
+
+HostBoard::HostBoard() {
+    memset(this->displayRam, 0, sizeof(this->displayRam));
+}
+
+unsigned long long HostBoard::getCompareDeadline(uint16_t compare) {
+    uint16_t distance = compare - TCNT1;
+
+    //compare value equal to counter matches after full turn only
+    return this->ticks + (distance == 0 ? 0x10000UL : distance);
+}
+
+void HostBoard::advance(unsigned long us) {
+    unsigned long long end = this->ticks + 2ULL * us;
+
+    while (true) {
+        unsigned long long deadline = end + 1;
+        void (*vector)(void) = NULL;
+        bool isTimer2 = false;
+        bool isAdc = false;
+
+        if (TIMSK1 & _BV(OCIE1A)) {
+            deadline = this->getCompareDeadline(OCR1A);
+            vector = TIMER1_COMPA_vect;
+        }
+        if ((TIMSK1 & _BV(OCIE1B)) && this->getCompareDeadline(OCR1B) < deadline) {
+            deadline = this->getCompareDeadline(OCR1B);
+            vector = TIMER1_COMPB_vect;
+        }
+
+        if (Timer2.isEnabled == true && Timer2.period != 0) {
+            if (this->timer2Deadline <= this->ticks) {
+                this->timer2Deadline = this->ticks + 2ULL * Timer2.period;
+            }
+            if (this->timer2Deadline < deadline) {
+                deadline = this->timer2Deadline;
+                vector = TIMER2_COMPA_vect;
+                isTimer2 = true;
+            }
+        }
+
+        if ((ADCSRA & _BV(ADEN)) && (ADCSRA & _BV(ADIE))) {
+            if (this->adcDeadline <= this->ticks) {
+                this->adcDeadline = this->ticks + 2ULL * HOST_ADC_PERIOD;
+            }
+            if (this->adcDeadline < deadline) {
+                deadline = this->adcDeadline;
+                vector = ADC_vect;
+                isTimer2 = false;
+                isAdc = true;
+            }
+        }
+
+        if (deadline > end) {
+            break;
+        }
+
+        TCNT1 += deadline - this->ticks;
+        this->ticks = deadline;
+
+        if (isTimer2 == true) {
+            this->timer2Deadline += 2ULL * Timer2.period;
+        }
+        if (isAdc == true) {
+            this->adcDeadline += 2ULL * HOST_ADC_PERIOD;
+            ADC = this->analogValue;
+        }
+        callVector(vector);
+    }
+
+    TCNT1 += end - this->ticks;
+    this->ticks = end;
+}
+
+void HostBoard::setPin(uint8_t pin, uint8_t level) {
+    volatile uint8_t& input = pin < 8 ? PIND : (pin < 14 ? PINB : PINC);
+    uint8_t mask = 1 << (pin < 8 ? pin : (pin < 14 ? pin - 8 : pin - 14));
+    uint8_t previous = (input & mask) != 0 ? HIGH : LOW;
+
+    if (level == HIGH) {
+        input |= mask;
+    } else {
+        input &= ~mask;
+    }
+
+    if (previous == level) {
+        return;
+    }
+
+    //INT0 (pin 2) and INT1 (pin 3), sense mode: 1 - any change, 2 - falling, 3 - rising
+    if (pin == 2 || pin == 3) {
+        uint8_t interrupt = pin - 2;
+        uint8_t sense = (EICRA >> (2 * interrupt)) & 0x03;
+
+        if ((EIMSK & _BV(interrupt)) &&
+            (sense == CHANGE || (sense == FALLING && level == LOW) || (sense == RISING && level == HIGH))) {
+            callVector(interrupt == 0 ? INT0_vect : INT1_vect);
+        }
+    }
+
+    if (pin < 8 && (PCICR & _BV(PCIE2)) && (PCMSK2 & mask)) {
+        callVector(PCINT2_vect);
+    } else if (pin >= 8 && pin < 14 && (PCICR & _BV(PCIE0)) && (PCMSK0 & mask)) {
+        callVector(PCINT0_vect);
+    } else if (pin >= 14 && (PCICR & _BV(PCIE1)) && (PCMSK1 & mask)) {
+        callVector(PCINT1_vect);
+    }
+}
+
+HostTwiControl& HostTwiControl::operator=(uint8_t value) {
+    this->value = value;
+    hostBoard.onTwiControl(value);
+    return *this;
+}
+
+void HostBoard::onTwiControl(uint8_t value) {
+    //writing one to TWINT starts the next action
+    if ((value & _BV(TWEN)) == 0 || (value & _BV(TWINT)) == 0) {
+        return;
+    }
+
+    if (value & _BV(TWSTO)) {
+        this->isTwiStarted = false;
+    }
+
+    if (value & _BV(TWSTA)) {
+        uint8_t status = this->isTwiStarted ? TWI_REPEATED_START : TWI_START;
+
+        this->isTwiStarted = true;
+        this->isAddressNext = true;
+        this->raiseTwiInterrupt(status);
+        return;
+    }
+
+    //stop alone does not interrupt
+    if (this->isTwiStarted == false) {
+        return;
+    }
+
+    this->displayBusBytes += 1;
+
+    if (this->isAddressNext == true) {
+        this->isAddressNext = false;
+        this->isControlNext = true;
+        bool isAcknowledged = TWDR == HOST_SH1106_ADDRESS && this->isDisplayNacking == false;
+
+        this->raiseTwiInterrupt(isAcknowledged ? TWI_SLA_ACK : TWI_SLA_NACK);
+        return;
+    }
+
+    this->receiveDisplayByte(TWDR);
+    this->raiseTwiInterrupt(TWI_DATA_ACK);
+}
+
+void HostBoard::receiveDisplayByte(uint8_t value) {
+    //control byte: D/C# bit tells if the rest is data or commands
+    if (this->isControlNext == true) {
+        this->isControlNext = false;
+        this->isDisplayData = (value & 0x40) != 0;
+        return;
+    }
+
+    if (this->isDisplayData == true) {
+        if (this->displayColumn < HOST_SH1106_COLUMNS) {
+            this->displayRam[this->displayPage][this->displayColumn] = value;
+            this->displayColumn += 1;
+        }
+        return;
+    }
+
+    //addressing commands only, the rest does not change RAM
+    if ((value & 0xF8) == 0xB0) {
+        this->displayPage = value & 0x07;
+    } else if ((value & 0xF0) == 0x10) {
+        this->displayColumn = (this->displayColumn & 0x0F) | ((value & 0x0F) << 4);
+    } else if ((value & 0xF0) == 0x00) {
+        this->displayColumn = (this->displayColumn & 0xF0) | (value & 0x0F);
+    }
+}
+
+void HostBoard::raiseTwiInterrupt(uint8_t status) {
+    TWSR = status;
+
+    if ((TWCR & _BV(TWIE)) == 0) {
+        return;
+    }
+
+    //TWCR written by TWI_vect itself interrupts after it returns
+    this->isTwiPending = true;
+    if (this->isInTwiInterrupt == true) {
+        return;
+    }
+
+    this->isInTwiInterrupt = true;
+    while (this->isTwiPending == true) {
+        this->isTwiPending = false;
+        callVector(TWI_vect);
+    }
+    this->isInTwiInterrupt = false;
+}
+
+void pinMode(uint8_t pin, uint8_t mode) {
+    volatile uint8_t& direction = pin < 8 ? DDRD : (pin < 14 ? DDRB : DDRC);
+    uint8_t mask = 1 << (pin < 8 ? pin : (pin < 14 ? pin - 8 : pin - 14));
+
+    if (mode == OUTPUT) {
+        direction |= mask;
+    } else {
+        direction &= ~mask;
+    }
+}
+
+void digitalWrite(uint8_t pin, uint8_t level) {
+    volatile uint8_t& port = pin < 8 ? PORTD : (pin < 14 ? PORTB : PORTC);
+    uint8_t mask = 1 << (pin < 8 ? pin : (pin < 14 ? pin - 8 : pin - 14));
+
+    if (level == LOW) {
+        port &= ~mask;
+    } else {
+        port |= mask;
+    }
+}
+
+int digitalRead(uint8_t pin) {
+    volatile uint8_t& input = pin < 8 ? PIND : (pin < 14 ? PINB : PINC);
+    uint8_t mask = 1 << (pin < 8 ? pin : (pin < 14 ? pin - 8 : pin - 14));
+
+    return (input & mask) != 0 ? HIGH : LOW;
+}
+
+int analogRead(uint8_t pin) {
+    return hostBoard.analogValue;
+}
+
+unsigned long millis() {
+    return hostBoard.getMicros() / 1000;
+}
+
+unsigned long micros() {
+    return hostBoard.getMicros();
+}
+
+long map(long value, long fromLow, long fromHigh, long toLow, long toHigh) {
+    return (value - fromLow) * (toHigh - toLow) / (fromHigh - fromLow) + toLow;
+}
+
+char* itoa(int value, char* string, int radix) {
+    return ltoa(value, string, radix);
+}
+
+char* ltoa(long value, char* string, int radix) {
+    char digits[8 * sizeof(long) + 1];
+    unsigned long rest = value < 0 && radix == 10 ? 0UL - (unsigned long)value : (unsigned long)value;
+    uint8_t length = 0;
+    char* output = string;
+
+    do {
+        uint8_t digit = rest % radix;
+        digits[length++] = digit < 10 ? '0' + digit : 'a' + digit - 10;
+        rest /= radix;
+    } while (rest != 0);
+
+    if (value < 0 && radix == 10) {
+        *output++ = '-';
+    }
+    while (length > 0) {
+        *output++ = digits[--length];
+    }
+    *output = '\0';
+
+    return string;
+}
+
+void HardwareSerial::begin(unsigned long baud) {}
+
+int HardwareSerial::available() {
+    return hostBoard.serialInput.size();
+}
+
+int HardwareSerial::read() {
+    if (hostBoard.serialInput.empty()) {
+        return -1;
+    }
+
+    uint8_t value = hostBoard.serialInput.front();
+    hostBoard.serialInput.pop_front();
+    return value;
+}
+
+int HardwareSerial::availableForWrite() {
+    //TX buffer of Arduino core, bytes leave it at once on host
+    return 63;
+}
+
+size_t HardwareSerial::write(uint8_t value) {
+    hostBoard.serialOutput.push_back(value);
+    return 1;
+}
+
+void EEPROMClass::erase() {
+    memset(this->cells, 0xFF, sizeof(this->cells));
+}
+
+uint8_t EEPROMClass::read(int address) {
+    return this->cells[address & E2END];
+}
+
+void EEPROMClass::write(int address, uint8_t value) {
+    if (this->writes >= this->writeLimit) {
+        return;
+    }
+    this->writes += 1;
+    this->cells[address & E2END] = value;
+}
+
+void EEPROMClass::update(int address, uint8_t value) {
+    if (this->read(address) != value) {
+        this->write(address, value);
+    }
+}
@@ -0,0 +1,93 @@
+#ifndef HOST_BOARD_H
+#define HOST_BOARD_H
+
+#include <deque>
+#include <vector>
+
+#include <Arduino.h>
+
+// SH1106 RAM is 132 columns wide, the visible 128 start from column 2
+#define HOST_SH1106_COLUMNS 132
+#define HOST_SH1106_PAGES 8
+// SH1106 I2C address, write mode
+#define HOST_SH1106_ADDRESS (0x3C << 1)
+
+/**
+ * @brief Nano around the sketch in host build. Time runs only by
+ * advance(), interrupts the firmware enabled are called on the way in
+ * order of their deadlines: Timer1 compare A and B (2 MHz counter),
+ * GyverTimers Timer2, ADC auto trigger of Timer0 overflow (every 1024 us),
+ * external and pin change interrupts of pins set by setPin().
+ *
+ * TWI is a bus with SH1106 on it: bytes written by TWCR/TWDR are decoded
+ * into displayRam, each one ends with TWI interrupt right away
+ */
+class HostBoard {
+  public:
+    // Timer1 ticks since reset, 0.5 us each
+    unsigned long long ticks = 0;
+    // converted by ADC, pin of keyboard (see KeyboardSampler), 0 - no button
+    // is pressed, full scale would be BUTTON_BACK held
+    uint16_t analogValue = 0;
+
+    // bytes written to Serial, not read yet by test
+    std::vector<uint8_t> serialOutput;
+    // bytes Serial.read() returns
+    std::deque<uint8_t> serialInput;
+
+    // SH1106 display RAM, written only by TWI bus
+    uint8_t displayRam[HOST_SH1106_PAGES][HOST_SH1106_COLUMNS];
+    // bytes on TWI bus, addresses included
+    unsigned long displayBusBytes = 0;
+    // display does not acknowledge its address, as if it was disconnected
+    bool isDisplayNacking = false;
+
+    HostBoard();
+
+    unsigned long getMicros() {
+      return this->ticks / 2;
+    }
+
+    /**
+     * @brief runs time forward, interrupts are called when they are due
+     *
+     * @param us time, us
+     */
+    void advance(unsigned long us);
+
+    /**
+     * @brief changes level of input pin, edge fires INT0/INT1 and pin
+     * change interrupts which are enabled for the pin
+     *
+     * @param pin digital pin 0-19
+     * @param level HIGH or LOW
+     */
+    void setPin(uint8_t pin, uint8_t level);
+
+    /**
+     * @brief carries out TWCR write, see HostTwiControl
+     */
+    void onTwiControl(uint8_t value);
+
+  private:
+    unsigned long long timer2Deadline = 0;
+    unsigned long long adcDeadline = 0;
+
+    // TWI bus: transaction is open, the next byte is address or control byte
+    bool isTwiStarted = false;
+    bool isAddressNext = false;
+    bool isControlNext = false;
+    bool isDisplayData = false;
+    bool isTwiPending = false;
+    bool isInTwiInterrupt = false;
+    uint8_t displayPage = 0;
+    uint8_t displayColumn = 0;
+
+    unsigned long long getCompareDeadline(uint16_t compare);
+    void receiveDisplayByte(uint8_t value);
+    void raiseTwiInterrupt(uint8_t status);
+};
+
+extern HostBoard hostBoard;
+
+#endif
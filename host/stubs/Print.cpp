@@ -0,0 +1,91 @@
+#include <string.h>
+
+#include "Print.h"
+
+size_t Print::write(const uint8_t* buffer, size_t size) {
+    for (size_t i = 0; i < size; i++) {
+        this->write(buffer[i]);
+    }
+    return size;
+}
+
+size_t Print::write(const char* string) {
+    return this->write((const uint8_t*)string, strlen(string));
+}
+
+size_t Print::print(const char* string) {
+    return this->write(string);
+}
+
+size_t Print::print(const __FlashStringHelper* string) {
+    //flash and RAM are the same memory on host
+    return this->write((const char*)string);
+}
+
+size_t Print::print(char value) {
+    return this->write((uint8_t)value);
+}
+
+size_t Print::print(int value, int base) {
+    return this->print((long)value, base);
+}
+
+size_t Print::print(unsigned int value, int base) {
+    return this->print((unsigned long)value, base);
+}
+
+size_t Print::print(long value, int base) {
+    if (value < 0 && base == DEC) {
+        return this->printNumber(0UL - (unsigned long)value, base, true);
+    }
+    return this->printNumber((unsigned long)value, base, false);
+}
+
+size_t Print::print(unsigned long value, int base) {
+    return this->printNumber(value, base, false);
+}
+
+size_t Print::println() {
+    return this->write("\r\n");
+}
+
+size_t Print::println(const char* string) {
+    return this->print(string) + this->println();
+}
+
+size_t Print::println(const __FlashStringHelper* string) {
+    return this->print(string) + this->println();
+}
+
+size_t Print::println(int value, int base) {
+    return this->print(value, base) + this->println();
+}
+
+size_t Print::println(unsigned int value, int base) {
+    return this->print(value, base) + this->println();
+}
+
+size_t Print::println(long value, int base) {
+    return this->print(value, base) + this->println();
+}
+
+size_t Print::println(unsigned long value, int base) {
+    return this->print(value, base) + this->println();
+}
+
+size_t Print::printNumber(unsigned long value, int base, bool isNegative) {
+    char digits[8 * sizeof(long) + 2];
+    char* digit = &digits[sizeof(digits) - 1];
+
+    *digit = '\0';
+    do {
+        unsigned long rest = value % base;
+        value /= base;
+        *--digit = rest < 10 ? '0' + rest : 'A' + rest - 10;
+    } while (value != 0);
+
+    if (isNegative == true) {
+        *--digit = '-';
+    }
+    return this->write(digit);
+}
@@ -0,0 +1,45 @@
+#ifndef HOST_PRINT_H
+#define HOST_PRINT_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+class __FlashStringHelper;
+#define F(string) (reinterpret_cast<const __FlashStringHelper*>(string))
+
+#define DEC 10
+#define HEX 16
+
+/**
+ * @brief Text output of Arduino core, numbers are printed by write()
+ * of derived class char by char
+ */
+class Print {
+  public:
+    virtual ~Print() {}
+
+    virtual size_t write(uint8_t value) = 0;
+    size_t write(const uint8_t* buffer, size_t size);
+    size_t write(const char* string);
+
+    size_t print(const char* string);
+    size_t print(const __FlashStringHelper* string);
+    size_t print(char value);
+    size_t print(int value, int base = DEC);
+    size_t print(unsigned int value, int base = DEC);
+    size_t print(long value, int base = DEC);
+    size_t print(unsigned long value, int base = DEC);
+
+    size_t println();
+    size_t println(const char* string);
+    size_t println(const __FlashStringHelper* string);
+    size_t println(int value, int base = DEC);
+    size_t println(unsigned int value, int base = DEC);
+    size_t println(long value, int base = DEC);
+    size_t println(unsigned long value, int base = DEC);
+
+  private:
+    size_t printNumber(unsigned long value, int base, bool isNegative);
+};
+
+#endif
@@ -0,0 +1,187 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "U8glib.h"
+
+#define HOST_PNG_ROW_LENGTH (1 + HOST_DISPLAY_WIDTH / 8)
+
+U8GLIB::U8GLIB() {
+    memset(this->frame, 0, sizeof(this->frame));
+    memset(this->pageCosts, 0, sizeof(this->pageCosts));
+
+    //page buffer of 128x8 pixels, same as U8G_PB_DEV of sh1106 does
+    this->pageBuffer.p.page_height = 8;
+    this->pageBuffer.p.total_height = HOST_DISPLAY_HEIGHT;
+    this->pageBuffer.p.page_y0 = 0;
+    this->pageBuffer.p.page_y1 = 0;
+    this->pageBuffer.p.page = 0;
+    this->pageBuffer.width = HOST_DISPLAY_WIDTH;
+    this->pageBuffer.buf = this->buffer;
+
+    this->device.dev.dev_fn = onDeviceMessage;
+    this->device.dev.dev_mem = &this->pageBuffer;
+    this->device.dev.com_fn = u8g_com_null_fn;
+    this->device.display = this;
+
+    u8g_Init(&this->u8g, &this->device.dev);
+}
+
+uint8_t U8GLIB::onDeviceMessage(u8g_t* u8g, u8g_dev_t* dev, uint8_t msg, void* arg) {
+    U8GLIB* display = ((Device*)dev)->display;
+
+    if (msg == U8G_DEV_MSG_SET_PIXEL || msg == U8G_DEV_MSG_SET_8PIXEL) {
+        display->getPageCost().pixelWrites += 1;
+    }
+
+    return u8g_dev_pb8v1_base_fn(u8g, dev, msg, arg);
+}
+
+size_t U8GLIB::write(uint8_t value) {
+    this->getPageCost().drawOps += 1;
+    this->printX += u8g_DrawGlyph(&this->u8g, this->printX, this->printY, value);
+    return 1;
+}
+
+u8g_uint_t U8GLIB::drawStr(u8g_uint_t x, u8g_uint_t y, const char* string) {
+    this->getPageCost().drawOps += 1;
+    return u8g_DrawStr(&this->u8g, x, y, string);
+}
+
+void U8GLIB::drawBitmapP(u8g_uint_t x, u8g_uint_t y, u8g_uint_t bytesPerRow, u8g_uint_t height, const u8g_pgm_uint8_t* bitmap) {
+    this->getPageCost().drawOps += 1;
+    u8g_DrawBitmapP(&this->u8g, x, y, bytesPerRow, height, bitmap);
+}
+
+void U8GLIB::firstPage() {
+    if (this->isBegun == false) {
+        this->isBegun = true;
+        u8g_Begin(&this->u8g);
+    }
+
+    memset(this->pageCosts, 0, sizeof(this->pageCosts));
+    this->renderedPages = 0;
+    u8g_FirstPage(&this->u8g);
+}
+
+uint8_t U8GLIB::nextPage() {
+    uint8_t page = this->pageBuffer.p.page;
+
+    //page is finished, u8glib clears buffer for the next one
+    if (page < HOST_DISPLAY_PAGES) {
+        HostPageCost& cost = this->pageCosts[page];
+
+        memcpy(this->frame[page], this->buffer, HOST_DISPLAY_WIDTH);
+        cost.inkBytes = 0;
+        for (uint8_t i = 0; i < HOST_DISPLAY_WIDTH; i++) {
+            if (this->buffer[i] != 0) {
+                cost.inkBytes += 1;
+            }
+        }
+        this->renderedPages += 1;
+    }
+
+    return u8g_NextPage(&this->u8g);
+}
+
+bool U8GLIB::dumpPbm(const char* path) {
+    FILE* file = fopen(path, "w");
+
+    if (file == NULL) {
+        return false;
+    }
+
+    fprintf(file, "P1\n%d %d\n", HOST_DISPLAY_WIDTH, HOST_DISPLAY_HEIGHT);
+    for (u8g_uint_t y = 0; y < HOST_DISPLAY_HEIGHT; y++) {
+        for (u8g_uint_t x = 0; x < HOST_DISPLAY_WIDTH; x++) {
+            fputc(this->isPixelSet(x, y) ? '1' : '0', file);
+        }
+        fputc('\n', file);
+    }
+
+    return fclose(file) == 0;
+}
+
+static uint32_t updatePngCrc(uint32_t crc, const uint8_t* data, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+        crc ^= data[i];
+        for (uint8_t bit = 0; bit < 8; bit++) {
+            crc = (crc & 1) ? (crc >> 1) ^ 0xEDB88320UL : crc >> 1;
+        }
+    }
+    return crc;
+}
+
+static void putBigEndian(uint8_t* data, uint32_t value) {
+    data[0] = value >> 24;
+    data[1] = value >> 16;
+    data[2] = value >> 8;
+    data[3] = value;
+}
+
+static void writePngChunk(FILE* file, const char* type, const uint8_t* data, uint32_t length) {
+    uint8_t field[4];
+    uint32_t crc = updatePngCrc(0xFFFFFFFFUL, (const uint8_t*)type, 4);
+
+    crc = updatePngCrc(crc, data, length) ^ 0xFFFFFFFFUL;
+
+    putBigEndian(field, length);
+    fwrite(field, 1, 4, file);
+    fwrite(type, 1, 4, file);
+    fwrite(data, 1, length, file);
+    putBigEndian(field, crc);
+    fwrite(field, 1, 4, file);
+}
+
+bool U8GLIB::dumpPng(const char* path) {
+    static const uint8_t signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    // width, height, 1 bit grayscale, no interlace
+    uint8_t header[13] = {0};
+    // zlib header, one stored (not compressed) deflate block, adler32
+    uint8_t data[2 + 5 + HOST_DISPLAY_HEIGHT * HOST_PNG_ROW_LENGTH + 4];
+    uint16_t rawLength = HOST_DISPLAY_HEIGHT * HOST_PNG_ROW_LENGTH;
+    uint8_t* raw = &data[7];
+    uint32_t sumA = 1;
+    uint32_t sumB = 0;
+    FILE* file = fopen(path, "wb");
+
+    if (file == NULL) {
+        return false;
+    }
+
+    putBigEndian(&header[0], HOST_DISPLAY_WIDTH);
+    putBigEndian(&header[4], HOST_DISPLAY_HEIGHT);
+    header[8] = 1;
+
+    data[0] = 0x78;
+    data[1] = 0x01;
+    data[2] = 0x01;
+    data[3] = rawLength & 0xFF;
+    data[4] = rawLength >> 8;
+    data[5] = ~rawLength & 0xFF;
+    data[6] = (~rawLength >> 8) & 0xFF;
+
+    memset(raw, 0, rawLength);
+    for (u8g_uint_t y = 0; y < HOST_DISPLAY_HEIGHT; y++) {
+        uint8_t* row = &raw[y * HOST_PNG_ROW_LENGTH];
+
+        //filter type 0, pixels follow, the leftmost one in the highest bit
+        for (u8g_uint_t x = 0; x < HOST_DISPLAY_WIDTH; x++) {
+            if (this->isPixelSet(x, y)) {
+                row[1 + x / 8] |= 0x80 >> (x % 8);
+            }
+        }
+    }
+
+    for (uint16_t i = 0; i < rawLength; i++) {
+        sumA = (sumA + raw[i]) % 65521;
+        sumB = (sumB + sumA) % 65521;
+    }
+    putBigEndian(&raw[rawLength], (sumB << 16) | sumA);
+
+    fwrite(signature, 1, sizeof(signature), file);
+    writePngChunk(file, "IHDR", header, sizeof(header));
+    writePngChunk(file, "IDAT", data, sizeof(data));
+    writePngChunk(file, "IEND", NULL, 0);
+
+    return fclose(file) == 0;
+}
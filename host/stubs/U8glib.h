@@ -0,0 +1,122 @@
+#ifndef HOST_U8GLIB_H
+#define HOST_U8GLIB_H
+
+#include <Print.h>
+#include <u8g.h>
+
+#define HOST_DISPLAY_WIDTH 128
+#define HOST_DISPLAY_HEIGHT 64
+#define HOST_DISPLAY_PAGES 8
+
+/**
+ * @brief Work of one page of the last frame
+ */
+struct HostPageCost {
+  // drawing operations: strings, printed glyphs and bitmaps
+  uint16_t drawOps;
+  // SET_PIXEL and SET_8PIXEL messages of u8glib to the device
+  uint16_t pixelWrites;
+  // bytes of page which have at least one pixel set
+  uint8_t inkBytes;
+};
+
+/**
+ * @brief U8glib of host build. Fonts, glyphs and bitmaps are rasterized
+ * by the real u8glib core (libs/u8glib_arduino_v1.18.1.zip) into the
+ * page buffer of 128x8 pixels, same as on board. Every finished page is
+ * copied into frame, the 128x64 picture of display, and its work is
+ * counted in pageCosts. Only the calls the sketch makes are here.
+ *
+ * Device procedure can be hooked as on board (see DisplayDevice),
+ * pages are taken from page buffer by nextPage(), not by the device.
+ */
+class U8GLIB : public Print {
+  public:
+    // picture of the last frame, SH1106 layout: byte per 8 vertical pixels, bit 0 on top
+    uint8_t frame[HOST_DISPLAY_PAGES][HOST_DISPLAY_WIDTH];
+    HostPageCost pageCosts[HOST_DISPLAY_PAGES];
+    // pages of the last frame, firstPage() starts counting
+    uint8_t renderedPages = 0;
+
+    U8GLIB();
+
+    u8g_t* getU8g() {
+      return &this->u8g;
+    }
+
+    void setFont(const u8g_fntpgm_uint8_t* font) {
+      u8g_SetFont(&this->u8g, font);
+    }
+
+    void setPrintPos(u8g_uint_t x, u8g_uint_t y) {
+      this->printX = x;
+      this->printY = y;
+    }
+
+    size_t write(uint8_t value);
+    using Print::write;
+
+    u8g_uint_t drawStr(u8g_uint_t x, u8g_uint_t y, const char* string);
+
+    u8g_uint_t getStrWidth(const char* string) {
+      return u8g_GetStrWidth(&this->u8g, string);
+    }
+
+    void drawBitmapP(u8g_uint_t x, u8g_uint_t y, u8g_uint_t bytesPerRow, u8g_uint_t height, const u8g_pgm_uint8_t* bitmap);
+
+    void firstPage();
+    uint8_t nextPage();
+
+    bool isPixelSet(u8g_uint_t x, u8g_uint_t y) {
+      return (this->frame[y / 8][x] >> (y % 8)) & 1;
+    }
+
+    /**
+     * @brief writes frame as plain (ASCII) PBM, row of pixels per line
+     *
+     * @return false if file can not be written
+     */
+    bool dumpPbm(const char* path);
+
+    /**
+     * @brief writes frame as 1 bit grayscale PNG, set pixels are white
+     * as on OLED
+     *
+     * @return false if file can not be written
+     */
+    bool dumpPng(const char* path);
+
+  private:
+    /**
+     * @brief device of u8glib, dev is the first member, so device
+     * procedure finds its display by the pointer it gets
+     */
+    struct Device {
+      u8g_dev_t dev;
+      U8GLIB* display;
+    };
+
+    u8g_t u8g;
+    Device device;
+    u8g_pb_t pageBuffer;
+    uint8_t buffer[HOST_DISPLAY_WIDTH];
+    u8g_uint_t printX = 0;
+    u8g_uint_t printY = 0;
+    bool isBegun = false;
+
+    static uint8_t onDeviceMessage(u8g_t* u8g, u8g_dev_t* dev, uint8_t msg, void* arg);
+
+    HostPageCost& getPageCost() {
+      return this->pageCosts[this->pageBuffer.p.page % HOST_DISPLAY_PAGES];
+    }
+};
+
+/**
+ * @brief SH1106 128x64 on I2C, bus options are ignored on host
+ */
+class U8GLIB_SH1106_128X64 : public U8GLIB {
+  public:
+    U8GLIB_SH1106_128X64(uint8_t options = U8G_I2C_OPT_NONE) {}
+};
+
+#endif
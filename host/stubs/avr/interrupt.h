@@ -0,0 +1,11 @@
+#ifndef HOST_AVR_INTERRUPT_H
+#define HOST_AVR_INTERRUPT_H
+
+// Interrupt vectors are plain functions on host, HostBoard calls the
+// ones the sketch defines (see HostBoard.cpp)
+#define ISR(vector, ...) extern "C" void vector(void); extern "C" void vector(void)
+
+#define cli()
+#define sei()
+
+#endif
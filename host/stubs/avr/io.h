@@ -0,0 +1,63 @@
+#ifndef HOST_AVR_IO_H
+#define HOST_AVR_IO_H
+
+#include <stdint.h>
+
+// ATmega328 registers of host build. Every register is a plain variable
+// (see HostBoard.cpp), peripherals which react to them are modelled by
+// HostBoard::advance()
+
+#define _BV(bit) (1U << (bit))
+
+// Timer1, step time base and speaker
+extern volatile uint8_t TCCR1A, TCCR1B, TIMSK1, TIFR1;
+extern volatile uint16_t TCNT1, OCR1A, OCR1B;
+// Timer2, control tick (see GyverTimers.h)
+extern volatile uint8_t TCCR2A, TCCR2B, TCNT2, OCR2A, TIMSK2, TIFR2;
+// ADC, keyboard
+extern volatile uint8_t ADMUX, ADCSRA, ADCSRB;
+extern volatile uint16_t ADC;
+// external and pin change interrupts, readers
+extern volatile uint8_t EICRA, EIMSK, EIFR, PCICR, PCMSK0, PCMSK1, PCMSK2;
+// ports
+extern volatile uint8_t PORTB, PORTC, PORTD, PINB, PINC, PIND, DDRB, DDRC, DDRD;
+// TWI, display
+extern volatile uint8_t TWBR, TWSR, TWDR;
+
+/**
+ * @brief TWI control register. Writing it starts bus action (start,
+ * byte, stop), which is carried out by TWI model of HostBoard
+ */
+class HostTwiControl {
+  public:
+    uint8_t value = 0;
+
+    HostTwiControl& operator=(uint8_t value);
+
+    operator uint8_t() const {
+      return this->value;
+    }
+};
+
+extern HostTwiControl TWCR;
+
+enum {
+  // Timer1
+  CS10 = 0, CS11 = 1, CS12 = 2,
+  TOIE1 = 0, OCIE1A = 1, OCIE1B = 2,
+  TOV1 = 0, OCF1A = 1, OCF1B = 2,
+  // Timer2
+  OCIE2A = 1, OCF2A = 1,
+  // ADC
+  REFS0 = 6, REFS1 = 7, ADLAR = 5,
+  ADEN = 7, ADSC = 6, ADATE = 5, ADIF = 4, ADIE = 3, ADPS2 = 2, ADPS1 = 1, ADPS0 = 0,
+  ADTS2 = 2, ADTS1 = 1, ADTS0 = 0,
+  // external and pin change interrupts
+  ISC00 = 0, ISC01 = 1, ISC10 = 2, ISC11 = 3,
+  INT0 = 0, INT1 = 1, INTF0 = 0, INTF1 = 1,
+  PCIE0 = 0, PCIE1 = 1, PCIE2 = 2,
+  // TWI
+  TWINT = 7, TWEA = 6, TWSTA = 5, TWSTO = 4, TWWC = 3, TWEN = 2, TWIE = 0
+};
+
+#endif
@@ -0,0 +1,11 @@
+#ifndef HOST_AVR_SLEEP_H
+#define HOST_AVR_SLEEP_H
+
+// Host does not sleep, time runs by HostBoard::advance() only
+
+#define SLEEP_MODE_IDLE 0
+
+#define set_sleep_mode(mode)
+#define sleep_mode()
+
+#endif
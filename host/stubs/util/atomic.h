@@ -0,0 +1,14 @@
+#ifndef HOST_UTIL_ATOMIC_H
+#define HOST_UTIL_ATOMIC_H
+
+#include <stdint.h>
+
+// Interrupts of host build run only from HostBoard::advance() and
+// register writes, never in the middle of a block
+
+#define ATOMIC_RESTORESTATE 0
+#define ATOMIC_FORCEON 1
+
+#define ATOMIC_BLOCK(type) for (uint8_t atomicPass = 1; atomicPass != 0; atomicPass = 0)
+
+#endif
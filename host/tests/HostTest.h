@@ -0,0 +1,33 @@
+#ifndef HOST_TEST_H
+#define HOST_TEST_H
+
+// Checks of host tests: failed check is printed and counted, the test
+// goes on, finishTest() gives exit status for ctest
+
+#include <stdio.h>
+
+static int hostTestFailures = 0;
+
+#define CHECK(condition) do { \
+    if (!(condition)) { \
+      hostTestFailures += 1; \
+      printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+    } \
+  } while (0)
+
+#define CHECK_EQUAL(expected, actual) do { \
+    long long expectedValue = (expected); \
+    long long actualValue = (actual); \
+    if (expectedValue != actualValue) { \
+      hostTestFailures += 1; \
+      printf("%s:%d: %s is %lld, expected %s (%lld)\n", __FILE__, __LINE__, \
+        #actual, actualValue, #expected, expectedValue); \
+    } \
+  } while (0)
+
+static int finishTest(const char* name) {
+  printf("%s: %s\n", name, hostTestFailures == 0 ? "ok" : "FAILED");
+  return hostTestFailures == 0 ? 0 : 1;
+}
+
+#endif
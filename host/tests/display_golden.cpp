@@ -0,0 +1,205 @@
+// Frame of every window and of every template, rendered by draw() of
+// the sketch into U8glib stub and sent to SH1106 model over TWI, is
+// compared with golden PBM of host/golden. Render cost of each frame is
+// printed.
+//
+// usage: display_golden [--update] [--png DIRECTORY]
+//   --update rewrites golden PBMs by frames of this build
+//   --png writes PNGs of all frames for viewing
+
+#include <string.h>
+#include <string>
+
+#include <HostBoard.h>
+#include <GyverTimers.h>
+
+#include "Sketch.h"
+#include "HostTest.h"
+
+struct GoldenWindow {
+  uint8_t id;
+  const char* name;
+};
+
+static const GoldenWindow goldenWindows[] = {
+  {W_MAIN, "main"},
+  {W_SCREEN_SAVER, "screen_saver"},
+  {W_ENGINE_CONTROL, "engine_control"},
+  {W_MANUAL_MENU, "manual_menu"},
+  {W_MANUAL, "manual"},
+  {W_SEMI_AUTO_MENU, "semi_auto_menu"},
+  {W_SEMI_AUTO, "semi_auto"},
+  {W_TEMPLATES, "templates"},
+  {W_TEMPLATE, "template"},
+  {W_TEMPLATE_EDITOR_MENU, "template_editor_menu"},
+  {W_TEMPLATE_EDITOR, "template_editor"},
+  {W_JOB_MENU, "job_menu"},
+  {W_JOB, "job"},
+  {W_JOB_EDITOR_MENU, "job_editor_menu"},
+  {W_JOB_EDITOR, "job_editor"},
+  {W_CALIBRATION_MENU, "calibration_menu"},
+  {W_ZERO_MENU, "zero_menu"},
+  {W_CALIBRATION, "calibration"},
+  {W_HOMING_MENU, "homing_menu"},
+  {W_HOMING, "homing"},
+  {W_TUNING_MENU, "tuning_menu"},
+  {W_TUNING, "tuning"},
+  {W_AXIS_MENU, "axis_menu"},
+  {W_AXIS, "axis"},
+  {W_DIAGNOSTICS, "diagnostics"},
+};
+
+static bool isUpdate = false;
+static const char* pngDirectory = NULL;
+
+/**
+ * @brief renders current window as renderFrame() does, screen saver
+ * included, which renderFrame() skips
+ */
+static void renderWindow() {
+  currentWindow->prepare(axes[0].estimator.getPosition(), umPerHole);
+  u8g.firstPage();
+  do {
+    currentWindow->draw();
+  } while (u8g.nextPage());
+}
+
+static bool readPbm(const std::string& path, uint8_t frame[HOST_DISPLAY_PAGES][HOST_DISPLAY_WIDTH]) {
+  FILE* file = fopen(path.c_str(), "r");
+  int width = 0;
+  int height = 0;
+
+  if (file == NULL) {
+    return false;
+  }
+
+  memset(frame, 0, HOST_DISPLAY_PAGES * HOST_DISPLAY_WIDTH);
+  if (fscanf(file, "P1 %d %d", &width, &height) != 2 ||
+      width != HOST_DISPLAY_WIDTH || height != HOST_DISPLAY_HEIGHT) {
+    fclose(file);
+    return false;
+  }
+
+  for (int y = 0; y < HOST_DISPLAY_HEIGHT; y++) {
+    for (int x = 0; x < HOST_DISPLAY_WIDTH; x++) {
+      int pixel = 0;
+
+      if (fscanf(file, " %1d", &pixel) != 1) {
+        fclose(file);
+        return false;
+      }
+      frame[y / 8][x] |= pixel << (y % 8);
+    }
+  }
+
+  fclose(file);
+  return true;
+}
+
+static void checkFrame(const char* name) {
+  std::string path = std::string(HOST_GOLDEN_DIR) + "/" + name + ".pbm";
+  uint8_t golden[HOST_DISPLAY_PAGES][HOST_DISPLAY_WIDTH];
+  unsigned int ops = 0;
+  unsigned int pixels = 0;
+  unsigned int ink = 0;
+
+  for (uint8_t page = 0; page < HOST_DISPLAY_PAGES; page++) {
+    ops += u8g.pageCosts[page].drawOps;
+    pixels += u8g.pageCosts[page].pixelWrites;
+    ink += u8g.pageCosts[page].inkBytes;
+  }
+  printf("  %-22s %4u ops %6u pixels %5u ink bytes %2u pages\n", name, ops, pixels, ink, u8g.renderedPages);
+
+  CHECK_EQUAL(HOST_DISPLAY_PAGES, u8g.renderedPages);
+
+  //changed pages are sent over TWI, display shows the whole frame
+  for (uint8_t page = 0; page < HOST_DISPLAY_PAGES; page++) {
+    CHECK(memcmp(&hostBoard.displayRam[page][2], u8g.frame[page], HOST_DISPLAY_WIDTH) == 0);
+  }
+
+  if (pngDirectory != NULL) {
+    u8g.dumpPng((std::string(pngDirectory) + "/" + name + ".png").c_str());
+  }
+
+  if (isUpdate == true) {
+    CHECK(u8g.dumpPbm(path.c_str()));
+    return;
+  }
+
+  if (readPbm(path, golden) == false) {
+    printf("  %s: no golden frame, run with --update\n", path.c_str());
+    hostTestFailures += 1;
+    return;
+  }
+
+  for (uint8_t page = 0; page < HOST_DISPLAY_PAGES; page++) {
+    if (memcmp(golden[page], u8g.frame[page], HOST_DISPLAY_WIDTH) != 0) {
+      printf("  %s: page %u differs from golden one\n", name, page);
+      hostTestFailures += 1;
+    }
+  }
+}
+
+static bool isFrameOnDisplay() {
+  for (uint8_t page = 0; page < HOST_DISPLAY_PAGES; page++) {
+    if (memcmp(&hostBoard.displayRam[page][2], u8g.frame[page], HOST_DISPLAY_WIDTH) != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * @brief pages which display did not acknowledge are sent by the next
+ * renderFrame(), though window did not change
+ */
+static void testFailedPagesSentAgain() {
+  showWindow(W_MAIN);
+  renderFrame();
+  CHECK(isFrameOnDisplay());
+
+  hostBoard.isDisplayNacking = true;
+  showWindow(W_MANUAL_MENU);
+  renderFrame();
+  CHECK(isFrameOnDisplay() == false);
+
+  hostBoard.isDisplayNacking = false;
+  renderFrame();
+  CHECK(isFrameOnDisplay());
+}
+
+int main(int argc, char** argv) {
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--update") == 0) {
+      isUpdate = true;
+    } else if (strcmp(argv[i], "--png") == 0 && i + 1 < argc) {
+      pngDirectory = argv[++i];
+    }
+  }
+
+  setup();
+  //nothing moves, frames depend on windows only
+  Timer2.disableISR(CHANNEL_A);
+
+  printf("render cost of frames\n");
+  for (uint8_t i = 0; i < sizeof(goldenWindows) / sizeof(GoldenWindow); i++) {
+    showWindow(goldenWindows[i].id);
+    renderWindow();
+    checkFrame(goldenWindows[i].name);
+  }
+
+  //run mode pages of the templates, the last page adds new one
+  showWindow(W_TEMPLATE);
+  for (uint8_t index = 0; index < templateTable.amount; index++) {
+    char name[16];
+
+    snprintf(name, sizeof(name), "template_%u", index);
+    templateWindow.select(index);
+    renderWindow();
+    checkFrame(name);
+  }
+
+  testFailedPagesSentAgain();
+
+  return finishTest("display_golden");
+}
@@ -0,0 +1,78 @@
+// Integer micrometres: rounding division, snapping of held buttons and
+// millimetres text of the windows, negative values included
+
+#include <stdint.h>
+#include <string.h>
+
+#include "FixedPoint.h"
+#include "HostTest.h"
+
+static void checkFormat(long micrometres, const char* expected) {
+  char buffer[MM_STRING_LENGTH];
+  uint8_t length = formatMillimetres(buffer, micrometres);
+
+  if (strcmp(buffer, expected) != 0) {
+    printf("formatMillimetres(%ld) is \"%s\", expected \"%s\"\n", micrometres, buffer, expected);
+  }
+  CHECK(strcmp(buffer, expected) == 0);
+  CHECK_EQUAL(strlen(expected), length);
+}
+
+static void testRoundDivide() {
+  CHECK_EQUAL(0, roundDivide(0, 10));
+  CHECK_EQUAL(1, roundDivide(14, 10));
+  CHECK_EQUAL(2, roundDivide(15, 10));
+  CHECK_EQUAL(-1, roundDivide(-14, 10));
+  CHECK_EQUAL(-2, roundDivide(-15, 10));
+  //odd divider has no half
+  CHECK_EQUAL(2, roundDivide(7, 3));
+  CHECK_EQUAL(-2, roundDivide(-7, 3));
+  CHECK_EQUAL(1234, roundDivide(1234, 1));
+  //limits of long on board, value plus half of divider would overflow
+  CHECK_EQUAL(214748365, roundDivide(INT32_MAX, 10));
+  CHECK_EQUAL(-214748365, roundDivide(INT32_MIN, 10));
+  CHECK_EQUAL(1073741824, roundDivide(INT32_MAX, 2));
+  CHECK_EQUAL(-1073741824, roundDivide(INT32_MIN, 2));
+  CHECK_EQUAL(INT32_MAX, roundDivide(INT32_MAX, 1));
+}
+
+static void testStepSnapped() {
+  //12.34 held up goes 13, 14, held down 12, 11
+  CHECK_EQUAL(13000, stepSnapped(12340, 1000, 1));
+  CHECK_EQUAL(14000, stepSnapped(13000, 1000, 1));
+  CHECK_EQUAL(12000, stepSnapped(12340, 1000, -1));
+  CHECK_EQUAL(11000, stepSnapped(12000, 1000, -1));
+
+  //negative values snap to floor as well
+  CHECK_EQUAL(-12000, stepSnapped(-12340, 1000, 1));
+  CHECK_EQUAL(-13000, stepSnapped(-12340, 1000, -1));
+  CHECK_EQUAL(-14000, stepSnapped(-13000, 1000, -1));
+  CHECK_EQUAL(0, stepSnapped(-1000, 1000, 1));
+  CHECK_EQUAL(-1000, stepSnapped(0, 1000, -1));
+  CHECK_EQUAL(-10, stepSnapped(-1, 10, -1));
+}
+
+static void testFormatMillimetres() {
+  checkFormat(0, "0.00");
+  checkFormat(5, "0.01");
+  checkFormat(4, "0.00");
+  checkFormat(10, "0.01");
+  checkFormat(1000, "1.00");
+  checkFormat(12345, "12.35");
+  checkFormat(999995, "1000.00");
+  checkFormat(-10, "-0.01");
+  checkFormat(-12344, "-12.34");
+  //rounds to zero, no sign
+  checkFormat(-4, "0.00");
+  //limits of long on board
+  checkFormat(INT32_MAX, "2147483.65");
+  checkFormat(INT32_MIN, "-2147483.65");
+}
+
+int main() {
+  testRoundDivide();
+  testStepSnapped();
+  testFormatMillimetres();
+
+  return finishTest("fixed_point");
+}
@@ -0,0 +1,106 @@
+// HoldRepeater: periods and steps of every stage of held LEFT/RIGHT,
+// and value of a window held up through all of them
+
+#include "HoldRepeater.h"
+#include "FixedPoint.h"
+#include "HostTest.h"
+
+// the smallest step of the window, what a click makes
+#define TEST_CLICK_STEP 10 //um
+
+/**
+ * @brief one repeat as repeatHeldButton() makes it, value is changed the
+ * way TemplateWindow::onHoldStep() and onRight() do
+ */
+static long repeat(HoldRepeater& repeater, long value, int8_t direction) {
+  long step = repeater.getStep();
+
+  if (step == 0) {
+    value += direction * TEST_CLICK_STEP;
+  } else {
+    value = stepSnapped(value, step, direction);
+  }
+  repeater.advance();
+  return value;
+}
+
+static void testStages() {
+  HoldRepeater repeater;
+  unsigned long time = 0;
+
+  repeater.start();
+  //1 s of click steps
+  for (uint8_t i = 0; i < 10; i++) {
+    CHECK_EQUAL(0, repeater.getStep());
+    CHECK_EQUAL(100, repeater.getPeriod());
+    time += repeater.getPeriod();
+    repeater.advance();
+  }
+  CHECK_EQUAL(1000, time);
+
+  //2 s of millimetres
+  for (uint8_t i = 0; i < 25; i++) {
+    CHECK_EQUAL(1, repeater.stage);
+    CHECK_EQUAL(1000, repeater.getStep());
+    time += repeater.getPeriod();
+    repeater.advance();
+  }
+  CHECK_EQUAL(3000, time);
+
+  //5 mm until release, the last stage never ends
+  for (uint16_t i = 0; i < 1000; i++) {
+    CHECK_EQUAL(2, repeater.stage);
+    CHECK_EQUAL(5000, repeater.getStep());
+    CHECK_EQUAL(80, repeater.getPeriod());
+    repeater.advance();
+  }
+
+  //hold event starts from the first stage again
+  repeater.start();
+  CHECK_EQUAL(0, repeater.stage);
+  CHECK_EQUAL(0, repeater.repeats);
+  CHECK_EQUAL(0, repeater.getStep());
+}
+
+static void testHeldValue() {
+  HoldRepeater repeater;
+  long value = 3270;
+
+  repeater.start();
+  for (uint8_t i = 0; i < 10; i++) {
+    value = repeat(repeater, value, 1);
+  }
+  CHECK_EQUAL(3370, value);
+
+  //millimetres continue from round numbers
+  value = repeat(repeater, value, 1);
+  CHECK_EQUAL(4000, value);
+  for (uint8_t i = 1; i < 25; i++) {
+    value = repeat(repeater, value, 1);
+  }
+  CHECK_EQUAL(28000, value);
+
+  value = repeat(repeater, value, 1);
+  CHECK_EQUAL(30000, value);
+  value = repeat(repeater, value, 1);
+  CHECK_EQUAL(35000, value);
+
+  //held down the same way
+  repeater.start();
+  value = 3270;
+  for (uint8_t i = 0; i < 10; i++) {
+    value = repeat(repeater, value, -1);
+  }
+  CHECK_EQUAL(3170, value);
+  value = repeat(repeater, value, -1);
+  CHECK_EQUAL(3000, value);
+  value = repeat(repeater, value, -1);
+  CHECK_EQUAL(2000, value);
+}
+
+int main() {
+  testStages();
+  testHeldValue();
+
+  return finishTest("hold_repeater");
+}
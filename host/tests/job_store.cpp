@@ -0,0 +1,190 @@
+// JobStore copies and JobQueue segments: the newer copy wins, torn save
+// keeps the previous job, moves end only on target reached
+
+#include <string.h>
+
+#include <EEPROM.h>
+
+#include "JobStore.h"
+#include "JobQueue.h"
+#include "HostTest.h"
+
+#define TEST_UM_PER_HOLE 500
+#define TEST_TICKS_PER_SECOND 1000
+
+volatile int targetPassedHoles = 0;
+volatile long targetRemainder = 0;
+volatile bool isStepperRunning = false;
+
+static void writeAll(JobStore& store) {
+  while (store.isBusy() == true) {
+    store.service();
+  }
+}
+
+static JobRecord makeJob(long height) {
+  JobRecord record;
+
+  memset(&record, 0, sizeof(record));
+  record.amount = 2;
+  record.segments[0].type = JOB_MOVE;
+  record.segments[0].value = height;
+  record.segments[1].type = JOB_DWELL;
+  record.segments[1].value = 0;
+  return record;
+}
+
+static long restoreHeight() {
+  JobStore store;
+  JobRecord record = makeJob(-1);
+
+  store.begin(record);
+  return record.segments[0].value;
+}
+
+static void testEmptyStore() {
+  JobStore store;
+  JobRecord record = makeJob(1234);
+
+  EEPROM.erase();
+  CHECK(store.begin(record) == false);
+  CHECK_EQUAL(1234, record.segments[0].value);
+}
+
+static void testCopies() {
+  JobStore store;
+  JobRecord record = makeJob(1000);
+
+  EEPROM.erase();
+  store.begin(record);
+  CHECK(store.save(record) == true);
+  CHECK_EQUAL(0, store.lastSlot);
+  //record is written from itself, the next save waits
+  CHECK(store.save(record) == false);
+  writeAll(store);
+  CHECK_EQUAL(1000, restoreHeight());
+
+  //every save goes to the other copy
+  record.segments[0].value = 2000;
+  store.save(record);
+  writeAll(store);
+  CHECK_EQUAL(1, store.lastSlot);
+  CHECK_EQUAL(2000, restoreHeight());
+
+  record.segments[0].value = 3000;
+  store.save(record);
+  writeAll(store);
+  CHECK_EQUAL(0, store.lastSlot);
+  CHECK_EQUAL(3000, restoreHeight());
+}
+
+static void testSequenceWrap() {
+  JobStore store;
+  JobRecord record = makeJob(1000);
+
+  EEPROM.erase();
+  store.begin(record);
+  record.sequence = 254;
+  store.save(record);
+  writeAll(store);
+
+  //sequence 255 -> 0, copy of 0 is the newer one
+  record.segments[0].value = 2000;
+  store.save(record);
+  writeAll(store);
+  CHECK_EQUAL(0, record.sequence);
+  CHECK_EQUAL(2000, restoreHeight());
+}
+
+static void testTornSave() {
+  JobStore store;
+  JobRecord record = makeJob(1000);
+
+  EEPROM.erase();
+  store.begin(record);
+  store.save(record);
+  writeAll(store);
+
+  record.segments[0].value = 2000;
+  EEPROM.writeLimit = EEPROM.writes + sizeof(JobRecord) / 2;
+  store.save(record);
+  writeAll(store);
+  EEPROM.writeLimit = 0xFFFFFFFFUL;
+  CHECK_EQUAL(1000, restoreHeight());
+
+  //store which restored the previous copy writes over the torn one
+  JobStore restored;
+  JobRecord restoredRecord;
+  restored.begin(restoredRecord);
+  CHECK_EQUAL(0, restored.lastSlot);
+  restoredRecord.segments[0].value = 3000;
+  restored.save(restoredRecord);
+  writeAll(restored);
+  CHECK_EQUAL(1, restored.lastSlot);
+  CHECK_EQUAL(3000, restoreHeight());
+}
+
+static void testQueue() {
+  JobQueue queue(&targetPassedHoles, &targetRemainder, &isStepperRunning, TEST_TICKS_PER_SECOND);
+
+  queue.setUMPerHole(TEST_UM_PER_HOLE);
+  queue.loadDefault();
+  CHECK(queue.start() == true);
+  CHECK(queue.start() == false);
+  CHECK_EQUAL(JOB_MOVING, queue.state);
+  CHECK_EQUAL(0, targetPassedHoles);
+  CHECK(isStepperRunning == true);
+  //target of the next move is split while this one runs
+  CHECK_EQUAL(4200 / TEST_UM_PER_HOLE, queue.nextHoles);
+  CHECK_EQUAL(4200 % TEST_UM_PER_HOLE, queue.nextRemainder);
+
+  //move goes on until target is reached
+  queue.tick(false);
+  CHECK_EQUAL(JOB_MOVING, queue.state);
+  queue.tick(true);
+  CHECK_EQUAL(JOB_PAUSED, queue.state);
+
+  queue.resume();
+  CHECK_EQUAL(JOB_MOVING, queue.state);
+  CHECK_EQUAL(4200 / TEST_UM_PER_HOLE, targetPassedHoles);
+  CHECK_EQUAL(4200 % TEST_UM_PER_HOLE, targetRemainder);
+
+  //dwell of 10 s is 10000 control ticks
+  queue.tick(true);
+  CHECK_EQUAL(JOB_DWELLING, queue.state);
+  for (long i = 0; i < 10000; i++) {
+    queue.tick(false);
+  }
+  CHECK_EQUAL(JOB_DWELLING, queue.state);
+  queue.tick(false);
+  CHECK_EQUAL(JOB_MOVING, queue.state);
+  CHECK_EQUAL(0, targetPassedHoles);
+
+  //stepper stopped short of target cancels the job
+  isStepperRunning = false;
+  queue.tick(false);
+  CHECK_EQUAL(JOB_IDLE, queue.state);
+  CHECK(queue.isRunning() == false);
+
+  //the last move reached ends the job
+  isStepperRunning = true;
+  CHECK(queue.start() == true);
+  queue.tick(true);
+  queue.resume();
+  queue.tick(true);
+  while (queue.state == JOB_DWELLING) {
+    queue.tick(false);
+  }
+  queue.tick(true);
+  CHECK_EQUAL(JOB_IDLE, queue.state);
+}
+
+int main() {
+  testEmptyStore();
+  testCopies();
+  testSequenceWrap();
+  testTornSave();
+  testQueue();
+
+  return finishTest("job_store");
+}
@@ -0,0 +1,173 @@
+// MotionTuner on the whole sketch: platform model loses steps above its
+// speed and acceleration, sweep has to find both, keep its margin and
+// bring platform back to origin
+
+#include <math.h>
+
+#include <HostBoard.h>
+
+#include "Sketch.h"
+#include "HostTest.h"
+
+// reader wheel of the test: steps of axis 1 per hole, half of it is the hole
+#define TEST_STEPS_PER_HOLE 40
+// wheel follows stepper this often, us
+#define TEST_WHEEL_PERIOD 50
+// board time limit of one tuning, ms
+#define TEST_TUNING_TIME 3600000UL
+
+/**
+ * @brief platform driven by stepper of axis 1, it follows steps while
+ * the motor keeps up and stands still while it does not
+ */
+class Platform {
+  public:
+    // limits of the motor, steps per second and steps per second^2
+    double maxSpeed;
+    double maxAcceleration;
+
+    long steps = 0;
+    long stepperPosition = 0;
+    unsigned long lostSteps = 0;
+
+    /**
+     * @brief follows steps made since the previous call, turns the wheel
+     */
+    void follow() {
+      long made = axes[0].stepper.position - this->stepperPosition;
+
+      this->stepperPosition = axes[0].stepper.position;
+      if (this->isOverloaded() == true) {
+        this->lostSteps += labs(made);
+      } else {
+        this->steps += made;
+      }
+
+      long phase = this->steps % TEST_STEPS_PER_HOLE;
+      if (phase < 0) {
+        phase += TEST_STEPS_PER_HOLE;
+      }
+      hostBoard.setPin(M_DIGITAL_READER, phase < TEST_STEPS_PER_HOLE / 2 ? HIGH : LOW);
+    }
+
+  private:
+    bool isOverloaded() {
+      if (timeBase.isRunning() == false) {
+        return false;
+      }
+
+      double speed = (double)STEP_TIMER_FREQUENCY * 256 / timeBase.stepDelay;
+      if (speed > this->maxSpeed) {
+        return true;
+      }
+
+      //c0 = 0.676 * f * sqrt(2 / a), see StepTimeBase::setAcceleration()
+      double firstDelay = (double)timeBase.initialDelay / 256;
+      double acceleration = 2 * pow(0.676 * STEP_TIMER_FREQUENCY / firstDelay, 2);
+      return timeBase.state != STEPPER_CRUISE && acceleration > this->maxAcceleration;
+    }
+};
+
+static Platform platform;
+
+/**
+ * @brief 1 ms of board time: control tick, one loop() pass, wheel turns
+ * in parts shorter than a step, so reader edge comes with DIR of its step
+ */
+static void runMillisecond() {
+  for (uint8_t i = 0; i < 1000 / TEST_WHEEL_PERIOD; i++) {
+    hostBoard.advance(TEST_WHEEL_PERIOD);
+    platform.follow();
+  }
+  loop();
+}
+
+/**
+ * @brief jogs up, so estimator learns steps per hole ratio
+ */
+static void learnRatio() {
+  showWindow(W_MANUAL);
+  direction = UP;
+  isStepperRunning = true;
+  for (int i = 0; i < 3000; i++) {
+    runMillisecond();
+  }
+  isStepperStopped = true;
+  while (timeBase.isRunning() == true) {
+    runMillisecond();
+  }
+  showWindow(W_MAIN);
+
+  CHECK(axes[0].estimator.stepsPerHole != 0);
+}
+
+static unsigned long runTuning() {
+  unsigned long time = 0;
+
+  CHECK(motionTuner.start() == true);
+  while (time < TEST_TUNING_TIME && (motionTuner.isActive() == true || timeBase.isRunning() == true)) {
+    runMillisecond();
+    time += 1;
+  }
+  //tuned values are applied by loop() once tuning ends
+  runMillisecond();
+
+  return time;
+}
+
+static void testSweep() {
+  platform.maxSpeed = 1500;
+  platform.maxAcceleration = 1000;
+
+  unsigned long time = runTuning();
+  printf("tuned %u steps/s, %u steps/s^2 in %lu s, %lu steps lost\n",
+    motionTuner.tunedSpeed, motionTuner.tunedAcceleration, time / 1000, platform.lostSteps);
+
+  CHECK_EQUAL(TUNING_DONE, motionTuner.state);
+  //levels are 1/8 apart, the highest passed one is within a level of the limit
+  CHECK(motionTuner.passedSpeed <= platform.maxSpeed);
+  CHECK(motionTuner.passedSpeed > platform.maxSpeed * 8 / 9);
+  CHECK(motionTuner.passedAcceleration <= platform.maxAcceleration);
+  CHECK(motionTuner.passedAcceleration > platform.maxAcceleration * 8 / 9);
+  CHECK_EQUAL(motionTuner.passedSpeed * TUNING_MARGIN / 100, motionTuner.tunedSpeed);
+  CHECK_EQUAL(motionTuner.passedAcceleration * TUNING_MARGIN / 100, motionTuner.tunedAcceleration);
+
+  //sweep ended by slips, platform is back at origin, counted by the wheel.
+  //UP is driven by LOW level of DIR, steps go down while holes go up
+  long originSteps = motionTuner.origin * TEST_STEPS_PER_HOLE / umPerHole;
+  CHECK(platform.lostSteps > 0);
+  CHECK_EQUAL(motionTuner.origin / umPerHole, axes[0].passedHoles);
+  CHECK(labs(platform.steps + originSteps) < TEST_STEPS_PER_HOLE);
+
+  //tuned values are used from now on
+  CHECK_EQUAL(motionTuner.tunedSpeed, stepperSpeed);
+  CHECK_EQUAL(motionTuner.tunedAcceleration, stepperAcceleration);
+}
+
+static void testFailure() {
+  int speed = stepperSpeed;
+  int acceleration = stepperAcceleration;
+
+  //even the starting level loses steps
+  platform.maxSpeed = stepperSpeed / 2;
+  platform.maxAcceleration = 100000;
+  runTuning();
+
+  CHECK_EQUAL(TUNING_FAILED, motionTuner.state);
+  CHECK_EQUAL(speed, stepperSpeed);
+  CHECK_EQUAL(acceleration, stepperAcceleration);
+}
+
+int main() {
+  setup();
+  //control ticks run by hostBoard.advance(), wheel is turned between them
+  platform.maxSpeed = 100000;
+  platform.maxAcceleration = 100000;
+  platform.follow();
+
+  learnRatio();
+  testSweep();
+  testFailure();
+
+  return finishTest("motion_tuner");
+}
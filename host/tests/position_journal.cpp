@@ -0,0 +1,122 @@
+// Crc8 and PositionJournal: restore of the newest record, wear-levelling
+// ring and record torn by power loss
+
+#include <EEPROM.h>
+
+#include "Crc8.h"
+#include "PositionJournal.h"
+#include "HostTest.h"
+
+static void writeAll(PositionJournal& journal) {
+  while (journal.isBusy() == true) {
+    journal.service();
+  }
+}
+
+static void testCrc8() {
+  const uint8_t check[] = {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+
+  //CRC-8 of "123456789", polynomial 0x07, initial 0
+  CHECK_EQUAL(0xF4, crc8(check, sizeof(check)));
+  //calculation goes on over several blocks
+  CHECK_EQUAL(crc8(check, sizeof(check)), crc8(check + 4, 5, crc8(check, 4)));
+  CHECK_EQUAL(0, crc8(check, 0));
+}
+
+static void testEmptyJournal() {
+  int passedHoles[AXES_AMOUNT] = {42};
+  PositionJournal journal;
+
+  EEPROM.erase();
+  CHECK(journal.begin(passedHoles) == false);
+  CHECK_EQUAL(42, passedHoles[0]);
+  CHECK(journal.isBusy() == false);
+}
+
+static void testRestore() {
+  int passedHoles[AXES_AMOUNT] = {0};
+  PositionJournal journal;
+
+  EEPROM.erase();
+  journal.begin(passedHoles);
+
+  //unchanged position is not written
+  journal.commit(passedHoles);
+  CHECK(journal.isBusy() == false);
+
+  passedHoles[0] = 17;
+  journal.commit(passedHoles);
+  CHECK(journal.isBusy() == true);
+  writeAll(journal);
+
+  PositionJournal restored;
+  int restoredHoles[AXES_AMOUNT] = {0};
+  CHECK(restored.begin(restoredHoles) == true);
+  CHECK_EQUAL(17, restoredHoles[0]);
+}
+
+static void testWearLevelling() {
+  int passedHoles[AXES_AMOUNT] = {0};
+  PositionJournal journal;
+
+  EEPROM.erase();
+  journal.begin(passedHoles);
+
+  //every commit takes the next slot, ring goes round one and a half times
+  for (int i = 1; i <= journal.slotsAmount * 3 / 2; i++) {
+    unsigned long writes = EEPROM.writes;
+
+    passedHoles[0] = i;
+    journal.commit(passedHoles);
+    writeAll(journal);
+    CHECK_EQUAL((i - 1) % journal.slotsAmount, journal.lastSlot);
+    CHECK(EEPROM.writes - writes <= sizeof(PositionRecord));
+  }
+
+  PositionJournal restored;
+  int restoredHoles[AXES_AMOUNT] = {0};
+  CHECK(restored.begin(restoredHoles) == true);
+  CHECK_EQUAL(journal.slotsAmount * 3 / 2, restoredHoles[0]);
+  CHECK_EQUAL(journal.lastSlot, restored.lastSlot);
+}
+
+static void testTornRecord() {
+  int passedHoles[AXES_AMOUNT] = {5};
+  PositionJournal journal;
+
+  EEPROM.erase();
+  journal.begin(passedHoles);
+  passedHoles[0] = 6;
+  journal.commit(passedHoles);
+  writeAll(journal);
+
+  //power is cut before crc of the next record is written
+  passedHoles[0] = 300;
+  journal.commit(passedHoles);
+  EEPROM.writeLimit = EEPROM.writes + sizeof(PositionRecord) - 1;
+  writeAll(journal);
+  EEPROM.writeLimit = 0xFFFFFFFFUL;
+
+  PositionJournal restored;
+  int restoredHoles[AXES_AMOUNT] = {0};
+  CHECK(restored.begin(restoredHoles) == true);
+  CHECK_EQUAL(6, restoredHoles[0]);
+
+  //journal goes on after the torn slot
+  restoredHoles[0] = 7;
+  restored.commit(restoredHoles);
+  writeAll(restored);
+  PositionJournal next;
+  CHECK(next.begin(restoredHoles) == true);
+  CHECK_EQUAL(7, restoredHoles[0]);
+}
+
+int main() {
+  testCrc8();
+  testEmptyJournal();
+  testRestore();
+  testWearLevelling();
+  testTornRecord();
+
+  return finishTest("position_journal");
+}
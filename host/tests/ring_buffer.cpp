@@ -0,0 +1,111 @@
+// RingBuffer of ISR to loop events: capacity, order across wrap of
+// indexes, and producer and consumer running at the same time
+
+#include <thread>
+
+#include <Arduino.h>
+
+#include "RingBuffer.h"
+#include "HostTest.h"
+
+#define TEST_QUEUE_SIZE 8
+// items passed between threads
+#define TEST_STREAM_LENGTH 200000L
+
+static void testCapacity() {
+  RingBuffer<int, TEST_QUEUE_SIZE> queue;
+  int item = -1;
+
+  CHECK(queue.isEmpty() == true);
+  CHECK(queue.pop(item) == false);
+  CHECK_EQUAL(-1, item);
+
+  //one slot is left free to tell full queue from empty one
+  for (int i = 0; i < TEST_QUEUE_SIZE - 1; i++) {
+    CHECK(queue.push(i) == true);
+  }
+  CHECK(queue.push(100) == false);
+  CHECK(queue.isEmpty() == false);
+
+  for (int i = 0; i < TEST_QUEUE_SIZE - 1; i++) {
+    CHECK(queue.pop(item) == true);
+    CHECK_EQUAL(i, item);
+  }
+  CHECK(queue.isEmpty() == true);
+}
+
+static void testWrap() {
+  RingBuffer<int, TEST_QUEUE_SIZE> queue;
+  int pushed = 0;
+  int popped = 0;
+  int item;
+
+  //uneven push and pop turn indexes around many times
+  for (int round = 0; round < 100; round++) {
+    for (int i = 0; i < round % TEST_QUEUE_SIZE; i++) {
+      if (queue.push(pushed) == true) {
+        pushed += 1;
+      }
+    }
+    for (int i = 0; i < round % 3 + 1; i++) {
+      if (queue.pop(item) == true) {
+        CHECK_EQUAL(popped, item);
+        popped += 1;
+      }
+    }
+  }
+  while (queue.pop(item) == true) {
+    CHECK_EQUAL(popped, item);
+    popped += 1;
+  }
+
+  CHECK_EQUAL(pushed, popped);
+  //indexes went around at least 10 times
+  CHECK(pushed > 10 * TEST_QUEUE_SIZE);
+}
+
+/**
+ * @brief producer thread stands for ISR, consumer for loop(): every item
+ * has to come out once and in order, nothing is lost but pushes refused
+ * by full queue. Side which waits yields, host may have one CPU only
+ */
+static void testProducerAndConsumer() {
+  static RingBuffer<long, TEST_QUEUE_SIZE> queue;
+  long refused = 0;
+  long expected = 0;
+  long item;
+
+  std::thread producer([&refused] {
+    for (long i = 0; i < TEST_STREAM_LENGTH; i++) {
+      while (queue.push(i) == false) {
+        refused += 1;
+        std::this_thread::yield();
+      }
+    }
+  });
+
+  while (expected < TEST_STREAM_LENGTH) {
+    if (queue.pop(item) == true) {
+      if (item != expected) {
+        CHECK_EQUAL(expected, item);
+        break;
+      }
+      expected += 1;
+    } else {
+      std::this_thread::yield();
+    }
+  }
+  producer.join();
+
+  CHECK_EQUAL(TEST_STREAM_LENGTH, expected);
+  CHECK(queue.isEmpty() == true);
+  printf("%ld items, %ld pushes to full queue\n", expected, refused);
+}
+
+int main() {
+  testCapacity();
+  testWrap();
+  testProducerAndConsumer();
+
+  return finishTest("ring_buffer");
+}
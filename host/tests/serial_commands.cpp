@@ -0,0 +1,93 @@
+// Commands of serial protocol on the whole sketch: GO_TO target range,
+// SET_ZERO of the shown axis
+
+#include <HostBoard.h>
+
+#include "Sketch.h"
+#include "SerialProtocol.h"
+#include "TemplateTable.h"
+#include "Crc8.h"
+#include "HostTest.h"
+
+static void sendCommand(uint8_t type, const uint8_t* payload, uint8_t length) {
+  uint8_t crc = crc8(&length, 1);
+
+  crc = crc8(&type, 1, crc);
+  crc = crc8(payload, length, crc);
+
+  hostBoard.serialInput.push_back(PROTOCOL_START);
+  hostBoard.serialInput.push_back(length);
+  hostBoard.serialInput.push_back(type);
+  for (uint8_t i = 0; i < length; i++) {
+    hostBoard.serialInput.push_back(payload[i]);
+  }
+  hostBoard.serialInput.push_back(crc);
+}
+
+/**
+ * @brief runs loop() until the board acknowledges command
+ *
+ * @return status of ACK frame, -1 if there is none
+ */
+static int readAck(uint8_t command) {
+  for (int pass = 0; pass < 100; pass++) {
+    hostBoard.serialOutput.clear();
+    hostBoard.advance(1000);
+    loop();
+
+    //telemetry frames may come before ACK
+    std::vector<uint8_t>& output = hostBoard.serialOutput;
+    for (size_t i = 0; i + 5 < output.size() + 1; i++) {
+      if (output[i] == PROTOCOL_START && output[i + 1] == 2 && output[i + 2] == FRAME_ACK &&
+          output[i + 3] == command) {
+        return output[i + 4];
+      }
+    }
+  }
+  return -1;
+}
+
+static int goTo(long target) {
+  int32_t value = target;
+  uint8_t payload[4] = {
+    (uint8_t)value, (uint8_t)(value >> 8), (uint8_t)(value >> 16), (uint8_t)(value >> 24)
+  };
+
+  sendCommand(CMD_GO_TO, payload, sizeof(payload));
+  return readAck(CMD_GO_TO);
+}
+
+static void testGoToRange() {
+  CHECK_EQUAL(STATUS_OK, goTo(TEMPLATE_MAX_HEIGHT));
+  CHECK_EQUAL(TEMPLATE_MAX_HEIGHT / umPerHole, targetPassedHoles);
+  CHECK_EQUAL(TEMPLATE_MAX_HEIGHT % umPerHole, targetRemainder);
+
+  //holes of farther target do not fit int of board, target is left as it is
+  CHECK_EQUAL(STATUS_BAD_ARGUMENT, goTo(TEMPLATE_MAX_HEIGHT + 1));
+  CHECK_EQUAL(STATUS_BAD_ARGUMENT, goTo(5000000L));
+  CHECK_EQUAL(STATUS_BAD_ARGUMENT, goTo(-1));
+  CHECK_EQUAL(TEMPLATE_MAX_HEIGHT / umPerHole, targetPassedHoles);
+
+  sendCommand(CMD_STOP, NULL, 0);
+  CHECK_EQUAL(STATUS_OK, readAck(CMD_STOP));
+  while (isStepperRunning == true || timeBase.isRunning() == true) {
+    hostBoard.advance(1000);
+    loop();
+  }
+}
+
+static void testSetZero() {
+  axes[0].passedHoles = 25;
+  sendCommand(CMD_SET_ZERO, NULL, 0);
+  CHECK_EQUAL(STATUS_OK, readAck(CMD_SET_ZERO));
+  CHECK_EQUAL(0, axes[0].passedHoles);
+}
+
+int main() {
+  setup();
+
+  testGoToRange();
+  testSetZero();
+
+  return finishTest("serial_commands");
+}
@@ -0,0 +1,177 @@
+// StepTimeBase of one axis on Timer1 model: trapezoid of move(), ramp
+// which meets its mirror on short moves, stop() and reversal of run()
+
+#include <vector>
+
+#include <HostBoard.h>
+
+#include "StepGenerator.h"
+#include "HostTest.h"
+
+#define TEST_SPEED 1000 //steps per second
+#define TEST_ACCELERATION 1000 //steps per second^2
+// Timer1 ticks between steps at TEST_SPEED
+#define TEST_CRUISE_DELAY (STEP_TIMER_FREQUENCY / TEST_SPEED)
+
+StepTimeBase timeBase;
+StepGenerator stepper(&timeBase, 0);
+
+// Timer1 tick of every step, position after it
+static std::vector<unsigned long long> stepTicks;
+static std::vector<long> stepPositions;
+
+ISR(TIMER1_COMPA_vect)
+{
+  long position = stepper.position;
+
+  timeBase.onTimerCompare();
+  if (stepper.position != position) {
+    stepTicks.push_back(hostBoard.ticks);
+    stepPositions.push_back((long)stepper.position);
+  }
+}
+
+static void restart() {
+  timeBase.halt();
+  stepper.position = 0;
+  stepTicks.clear();
+  stepPositions.clear();
+}
+
+static void runUntilIdle(unsigned long maxUs) {
+  for (unsigned long us = 0; us < maxUs && timeBase.isRunning() == true; us += 1000) {
+    hostBoard.advance(1000);
+  }
+}
+
+static unsigned long getInterval(size_t step) {
+  return stepTicks[step] - stepTicks[step - 1];
+}
+
+/**
+ * @brief steps whose interval is within 1% of cruise one
+ */
+static size_t countCruiseSteps(size_t& firstCruise, size_t& lastCruise) {
+  size_t amount = 0;
+
+  firstCruise = 0;
+  lastCruise = 0;
+  for (size_t i = 1; i < stepTicks.size(); i++) {
+    if (getInterval(i) <= TEST_CRUISE_DELAY + TEST_CRUISE_DELAY / 100) {
+      if (amount == 0) {
+        firstCruise = i;
+      }
+      lastCruise = i;
+      amount += 1;
+    }
+  }
+  return amount;
+}
+
+static void testTrapezoid() {
+  size_t firstCruise;
+  size_t lastCruise;
+
+  restart();
+  stepper.move(2000);
+  runUntilIdle(10000000);
+
+  CHECK(timeBase.isRunning() == false);
+  CHECK_EQUAL(2000, stepper.position);
+  CHECK_EQUAL(2000, stepTicks.size());
+
+  //v^2 / 2a = 500 steps of each ramp
+  countCruiseSteps(firstCruise, lastCruise);
+  CHECK(firstCruise > 450 && firstCruise < 550);
+  CHECK(stepTicks.size() - lastCruise > 450 && stepTicks.size() - lastCruise < 550);
+
+  //never faster than cruise, ramps are monotonic
+  for (size_t i = 2; i < stepTicks.size(); i++) {
+    CHECK(getInterval(i) >= TEST_CRUISE_DELAY - 1);
+    if (i < firstCruise) {
+      CHECK(getInterval(i) <= getInterval(i - 1));
+    }
+    if (i > lastCruise + 1) {
+      CHECK(getInterval(i) >= getInterval(i - 1));
+    }
+  }
+
+  //deceleration mirrors acceleration
+  CHECK(getInterval(stepTicks.size() - 1) > getInterval(2) / 2);
+}
+
+static void testTriangle() {
+  size_t firstCruise;
+  size_t lastCruise;
+  size_t fastest = 1;
+
+  restart();
+  stepper.move(-200);
+  runUntilIdle(10000000);
+
+  CHECK_EQUAL(-200, stepper.position);
+  CHECK_EQUAL(0, countCruiseSteps(firstCruise, lastCruise));
+
+  //ramp turns around in the middle of the move
+  for (size_t i = 1; i < stepTicks.size(); i++) {
+    if (getInterval(i) < getInterval(fastest)) {
+      fastest = i;
+    }
+  }
+  CHECK(fastest > 90 && fastest < 110);
+}
+
+static void testStop() {
+  restart();
+  stepper.run(HIGH);
+  hostBoard.advance(2000000);
+  CHECK(timeBase.state == STEPPER_CRUISE);
+
+  long position = stepper.position;
+  timeBase.stop();
+  runUntilIdle(10000000);
+
+  //stopping distance is the acceleration ramp
+  CHECK(timeBase.isRunning() == false);
+  CHECK(stepper.position - position > 450 && stepper.position - position < 550);
+}
+
+static void testReversal() {
+  restart();
+  stepper.run(HIGH);
+  hostBoard.advance(2000000);
+  stepper.run(LOW);
+  CHECK(timeBase.state == STEPPER_DECEL);
+  hostBoard.advance(4000000);
+
+  //turned back after deceleration, no step in the old direction after the turn
+  long highest = 0;
+  size_t turn = 0;
+  for (size_t i = 0; i < stepPositions.size(); i++) {
+    if (stepPositions[i] > highest) {
+      highest = stepPositions[i];
+      turn = i;
+    }
+  }
+  CHECK(timeBase.state == STEPPER_CRUISE);
+  CHECK(stepper.direction == LOW);
+  CHECK(stepPositions.back() < highest);
+  for (size_t i = turn + 1; i < stepPositions.size(); i++) {
+    CHECK(stepPositions[i] < stepPositions[i - 1]);
+  }
+  //starts again from rest
+  CHECK(getInterval(turn + 1) > 10 * TEST_CRUISE_DELAY);
+}
+
+int main() {
+  timeBase.begin();
+  timeBase.setMaxSpeed(TEST_SPEED);
+  timeBase.setAcceleration(TEST_ACCELERATION);
+
+  testTrapezoid();
+  testTriangle();
+  testStop();
+  testReversal();
+
+  return finishTest("step_generator");
+}
@@ -0,0 +1,160 @@
+// StepTimeBase of 4 axes (built with AXES_AMOUNT 4): Bresenham shares of
+// moveTogether(), lead which is not axis 1, lockstep of runTogether()
+
+#include <vector>
+
+#include <HostBoard.h>
+
+#include "StepGenerator.h"
+#include "HostTest.h"
+
+#define TEST_SPEED 2000 //steps per second
+#define TEST_ACCELERATION 4000 //steps per second^2
+
+StepTimeBase timeBase;
+StepGenerator steppers[AXES_AMOUNT] = {
+  StepGenerator(&timeBase, 0),
+  StepGenerator(&timeBase, 1),
+  StepGenerator(&timeBase, 2),
+  StepGenerator(&timeBase, 3)
+};
+
+/**
+ * @brief positions of all axes after one step ISR
+ */
+struct GroupStep {
+  long positions[AXES_AMOUNT];
+};
+
+static std::vector<GroupStep> groupSteps;
+
+ISR(TIMER1_COMPA_vect)
+{
+  GroupStep step;
+  bool isStepped = false;
+
+  for (uint8_t i = 0; i < AXES_AMOUNT; i++) {
+    step.positions[i] = steppers[i].position;
+  }
+  timeBase.onTimerCompare();
+  for (uint8_t i = 0; i < AXES_AMOUNT; i++) {
+    isStepped = isStepped || step.positions[i] != steppers[i].position;
+    step.positions[i] = steppers[i].position;
+  }
+
+  if (isStepped == true) {
+    groupSteps.push_back(step);
+  }
+}
+
+static void restart() {
+  timeBase.halt();
+  for (uint8_t i = 0; i < AXES_AMOUNT; i++) {
+    steppers[i].position = 0;
+  }
+  groupSteps.clear();
+}
+
+static void runUntilIdle() {
+  for (unsigned long us = 0; us < 10000000 && timeBase.isRunning() == true; us += 1000) {
+    hostBoard.advance(1000);
+  }
+}
+
+/**
+ * @brief checks that every lead step moves lead by one and every axis
+ * stays within a step of the straight line to its target
+ */
+static void checkLine(const long* steps, uint8_t leadIndex) {
+  long leadSteps = labs(steps[leadIndex]);
+
+  CHECK_EQUAL(leadSteps, groupSteps.size());
+  for (size_t k = 0; k < groupSteps.size(); k++) {
+    CHECK_EQUAL((long)(k + 1), labs(groupSteps[k].positions[leadIndex]));
+
+    for (uint8_t i = 0; i < AXES_AMOUNT; i++) {
+      //position * lead against ideal (k + 1) * steps, both scaled by lead steps
+      long deviation = groupSteps[k].positions[i] * leadSteps - (long)(k + 1) * steps[i];
+
+      CHECK(labs(deviation) <= leadSteps);
+      //one step of follower per lead step at most
+      if (k > 0) {
+        CHECK(labs(groupSteps[k].positions[i] - groupSteps[k - 1].positions[i]) <= 1);
+      }
+    }
+  }
+}
+
+static void checkFinished(const long* steps) {
+  CHECK(timeBase.isRunning() == false);
+  for (uint8_t i = 0; i < AXES_AMOUNT; i++) {
+    CHECK_EQUAL(steps[i], steppers[i].position);
+    CHECK(steppers[i].isRunning() == false);
+  }
+}
+
+static void testMoveTogether() {
+  const long steps[AXES_AMOUNT] = {1000, 600, -250, 0};
+
+  restart();
+  CHECK(timeBase.moveTogether(steps) == true);
+  CHECK(timeBase.lead == &steppers[0]);
+  //time base is busy, the next group move waits
+  CHECK(timeBase.moveTogether(steps) == false);
+  runUntilIdle();
+
+  checkFinished(steps);
+  checkLine(steps, 0);
+}
+
+static void testLeadOfLongestAxis() {
+  const long steps[AXES_AMOUNT] = {100, -400, 0, 399};
+
+  restart();
+  CHECK(timeBase.moveTogether(steps) == true);
+  CHECK(timeBase.lead == &steppers[1]);
+  runUntilIdle();
+
+  checkFinished(steps);
+  checkLine(steps, 1);
+}
+
+static void testNothingToMove() {
+  const long steps[AXES_AMOUNT] = {0, 0, 0, 0};
+
+  restart();
+  CHECK(timeBase.moveTogether(steps) == false);
+  CHECK(timeBase.isRunning() == false);
+}
+
+static void testRunTogether() {
+  restart();
+  timeBase.runTogether(LOW);
+  hostBoard.advance(500000);
+  timeBase.stop();
+  runUntilIdle();
+
+  CHECK(timeBase.isRunning() == false);
+  CHECK(steppers[0].position < 0);
+  for (size_t k = 0; k < groupSteps.size(); k++) {
+    for (uint8_t i = 1; i < AXES_AMOUNT; i++) {
+      CHECK_EQUAL(groupSteps[k].positions[0], groupSteps[k].positions[i]);
+    }
+  }
+  for (uint8_t i = 0; i < AXES_AMOUNT; i++) {
+    CHECK(steppers[i].isRunning() == false);
+  }
+}
+
+int main() {
+  timeBase.begin();
+  timeBase.setMaxSpeed(TEST_SPEED);
+  timeBase.setAcceleration(TEST_ACCELERATION);
+
+  testMoveTogether();
+  testLeadOfLongestAxis();
+  testNothingToMove();
+  testRunTogether();
+
+  return finishTest("step_group");
+}
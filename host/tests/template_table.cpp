@@ -0,0 +1,176 @@
+// TemplateTable: defaults of the first start, save and append in
+// background, end mark written before appended record, records torn by
+// power loss
+
+#include <string.h>
+
+#include <EEPROM.h>
+
+#include "TemplateTable.h"
+#include "HostTest.h"
+
+#define TEST_DEFAULTS_AMOUNT 3
+
+static int getSlotAddress(uint8_t index) {
+  return TEMPLATE_TABLE_START + 1 + index * sizeof(TemplateRecord);
+}
+
+static void writeAll(TemplateTable& table) {
+  while (table.isBusy() == true) {
+    table.service();
+  }
+}
+
+static TemplateRecord makeRecord(const char* name, long height) {
+  TemplateRecord record;
+
+  memset(&record, 0, sizeof(record));
+  strncpy(record.name, name, TEMPLATE_NAME_LENGTH - 1);
+  record.height = height;
+  return record;
+}
+
+static void checkRecord(TemplateTable& table, uint8_t index, const char* name, long height) {
+  TemplateRecord record;
+
+  CHECK(table.read(index, record) == true);
+  CHECK(strcmp(record.name, name) == 0);
+  CHECK_EQUAL(height, record.height);
+}
+
+static void formatTable(TemplateTable& table) {
+  EEPROM.erase();
+  EEPROM.writeLimit = 0xFFFFFFFFUL;
+  table.begin();
+}
+
+static void testFormat() {
+  TemplateTable table;
+
+  EEPROM.erase();
+  CHECK(table.begin() == false);
+  CHECK_EQUAL(TEST_DEFAULTS_AMOUNT, table.amount);
+  CHECK_EQUAL(TEMPLATE_TABLE_VERSION, EEPROM.read(TEMPLATE_TABLE_START));
+  checkRecord(table, 0, "T - shirt", 3000);
+  checkRecord(table, 2, "Hoody", 5500);
+
+  //formatted table is only counted
+  TemplateTable restored;
+  unsigned long writes = EEPROM.writes;
+  CHECK(restored.begin() == true);
+  CHECK_EQUAL(TEST_DEFAULTS_AMOUNT, restored.amount);
+  CHECK_EQUAL(writes, EEPROM.writes);
+}
+
+static void testSave() {
+  TemplateTable table;
+  TemplateRecord record = makeRecord("Jacket", 6100);
+
+  formatTable(table);
+  CHECK(table.save(1, record) == true);
+  CHECK(table.isBusy() == true);
+  //record is shown while it is written, the next save waits
+  checkRecord(table, 1, "Jacket", 6100);
+  CHECK(table.save(0, record) == false);
+
+  writeAll(table);
+  CHECK_EQUAL(TEST_DEFAULTS_AMOUNT, table.amount);
+
+  TemplateTable restored;
+  restored.begin();
+  checkRecord(restored, 1, "Jacket", 6100);
+  checkRecord(restored, 2, "Hoody", 5500);
+
+  //gap after the last template is not allowed
+  CHECK(table.save(TEST_DEFAULTS_AMOUNT + 1, record) == false);
+}
+
+static void testAppend() {
+  TemplateTable table;
+  TemplateRecord record = makeRecord("Polo", 3800);
+  int markAddress = getSlotAddress(TEST_DEFAULTS_AMOUNT + 1);
+
+  formatTable(table);
+  //data of a template which was there once
+  EEPROM.cells[markAddress] = 'S';
+
+  CHECK(table.save(TEST_DEFAULTS_AMOUNT, record) == true);
+  CHECK_EQUAL(TEST_DEFAULTS_AMOUNT + 1, table.amount);
+  table.service();
+  CHECK_EQUAL(TEMPLATE_TABLE_END_MARK, EEPROM.read(markAddress));
+  //record itself is not started yet
+  CHECK_EQUAL(TEMPLATE_TABLE_END_MARK, EEPROM.read(getSlotAddress(TEST_DEFAULTS_AMOUNT)));
+
+  writeAll(table);
+  TemplateTable restored;
+  restored.begin();
+  CHECK_EQUAL(TEST_DEFAULTS_AMOUNT + 1, restored.amount);
+  checkRecord(restored, TEST_DEFAULTS_AMOUNT, "Polo", 3800);
+}
+
+static void testTornAppend() {
+  TemplateTable table;
+  TemplateRecord record = makeRecord("Polo", 3800);
+  int markAddress = getSlotAddress(TEST_DEFAULTS_AMOUNT + 1);
+
+  //power is cut right after the end mark, old slot after it stays hidden
+  formatTable(table);
+  EEPROM.cells[markAddress] = 'S';
+  EEPROM.writeLimit = EEPROM.writes + 1;
+  table.save(TEST_DEFAULTS_AMOUNT, record);
+  writeAll(table);
+
+  TemplateTable restored;
+  restored.begin();
+  CHECK_EQUAL(TEST_DEFAULTS_AMOUNT, restored.amount);
+
+  //power is cut in the middle of record, it is damaged but can be saved again
+  formatTable(table);
+  EEPROM.writeLimit = EEPROM.writes + 1 + sizeof(TemplateRecord) / 2;
+  table.save(TEST_DEFAULTS_AMOUNT, record);
+  writeAll(table);
+
+  TemplateTable damaged;
+  TemplateRecord read;
+  damaged.begin();
+  CHECK_EQUAL(TEST_DEFAULTS_AMOUNT + 1, damaged.amount);
+  CHECK(damaged.read(TEST_DEFAULTS_AMOUNT, read) == false);
+  CHECK(strcmp(read.name, "Damaged") == 0);
+  CHECK_EQUAL(0, read.height);
+  checkRecord(damaged, TEST_DEFAULTS_AMOUNT - 1, "Hoody", 5500);
+
+  EEPROM.writeLimit = 0xFFFFFFFFUL;
+  CHECK(damaged.save(TEST_DEFAULTS_AMOUNT, record) == true);
+  writeAll(damaged);
+  checkRecord(damaged, TEST_DEFAULTS_AMOUNT, "Polo", 3800);
+}
+
+static void testFull() {
+  TemplateTable table;
+  TemplateRecord record = makeRecord("Extra", 1000);
+
+  formatTable(table);
+  while (table.isFull() == false) {
+    CHECK(table.save(table.amount, record) == true);
+    writeAll(table);
+  }
+  CHECK_EQUAL(TEMPLATE_SLOTS_AMOUNT, table.amount);
+  CHECK(table.save(table.amount, record) == false);
+  //the last slot has no end mark after it, table still fits its area
+  CHECK(getSlotAddress(TEMPLATE_SLOTS_AMOUNT) <= TEMPLATE_TABLE_END);
+
+  TemplateTable restored;
+  restored.begin();
+  CHECK_EQUAL(TEMPLATE_SLOTS_AMOUNT, restored.amount);
+  checkRecord(restored, TEMPLATE_SLOTS_AMOUNT - 1, "Extra", 1000);
+}
+
+int main() {
+  testFormat();
+  testSave();
+  testAppend();
+  testTornAppend();
+  testFull();
+
+  return finishTest("template_table");
+}
@@ -0,0 +1,552 @@
+#!/usr/bin/env python3
+"""Host side of helper serial protocol (see helper/SerialProtocol.h).
+
+Frame: 0xA5, payload length, type, payload..., crc8 (poly 0x07) over
+length, type and payload. Numbers are little endian.
+
+usage:
+  helper_cli.py PORT goto MILLIMETRES
+  helper_cli.py PORT template INDEX
+  helper_cli.py PORT set-template INDEX MILLIMETRES NAME
+  helper_cli.py PORT display [--name NAME] [--save FILE | --check FILE]
+  helper_cli.py PORT axis NUMBER | all
+  helper_cli.py PORT job | stop | zero | home | homing | tune | tuning | config | profile | tasks | templates | watch
+  helper_cli.py --fake COMMAND ...
+
+--fake talks to a model of the board (FakeBoard) on a pseudo terminal
+instead of PORT, so the protocol can be tried without Nano (POSIX only).
+
+requires pyserial
+"""
+
+import argparse
+import json
+import os
+import select
+import struct
+import sys
+import threading
+import time
+
+import serial
+
+BAUD_RATE = 115200
+START = 0xA5
+
+CMD_GO_TO = 0x01
+CMD_RUN_TEMPLATE = 0x02
+CMD_STOP = 0x03
+CMD_SET_ZERO = 0x04
+CMD_READ_CONFIG = 0x05
+CMD_READ_PROFILE = 0x06
+CMD_READ_TEMPLATE = 0x07
+CMD_WRITE_TEMPLATE = 0x08
+CMD_RUN_JOB = 0x09
+CMD_READ_TASKS = 0x0A
+CMD_READ_DISPLAY = 0x0B
+CMD_HOME = 0x0C
+CMD_READ_HOMING = 0x0D
+CMD_TUNE = 0x0E
+CMD_READ_TUNING = 0x0F
+CMD_SELECT_AXIS = 0x10
+
+FRAME_ACK = 0x80
+FRAME_CONFIG = 0x81
+FRAME_PROFILE = 0x82
+FRAME_TEMPLATE = 0x83
+FRAME_TASKS = 0x84
+FRAME_DISPLAY = 0x85
+FRAME_HOMING = 0x86
+FRAME_TUNING = 0x87
+FRAME_KEYBOARD = 0x88
+FRAME_TELEMETRY = 0x90
+
+STATUS_OK = 0
+STATUS_BUSY = 1
+STATUS_BAD_ARGUMENT = 2
+STATUS_UNKNOWN_COMMAND = 3
+STATUSES = {0: "ok", 1: "busy", 2: "bad argument", 3: "unknown command", 4: "damaged"}
+TEMPLATE_NAME_LENGTH = 11
+# um, TEMPLATE_MAX_HEIGHT of helper/TemplateTable.h, limit of every height and target
+MAX_HEIGHT = 100000
+PROFILE_COUNTERS = ("tick", "loop", "draw", "eeprom")
+TASKS = ("render", "hold", "saver", "telemetry")
+DISPLAY_PAGES = 8
+HOMING_STATES = ("idle", "fast approach", "back off", "slow approach", "done", "failed")
+TUNING_STATES = ("idle", "speed sweep", "acceleration sweep", "done", "failed")
+AXIS_ALL = 0xFF
+MAX_PAYLOAD = 32
+TELEMETRY_PERIOD = 0.1
+
+
+def crc8(data, crc=0):
+    for value in data:
+        crc ^= value
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x07) & 0xFF if crc & 0x80 else (crc << 1) & 0xFF
+    return crc
+
+
+def encode(frame_type, payload=b""):
+    body = bytes([len(payload), frame_type]) + payload
+    return bytes([START]) + body + bytes([crc8(body)])
+
+
+def read_frame(port):
+    """Returns (type, payload) of next valid frame or None on timeout."""
+    while True:
+        value = port.read(1)
+        if not value:
+            return None
+        if value[0] != START:
+            continue
+        header = port.read(2)
+        if len(header) < 2:
+            return None
+        length, frame_type = header
+        rest = port.read(length + 1)
+        if len(rest) < length + 1:
+            return None
+        payload, crc = rest[:length], rest[length]
+        if crc8(header + payload) == crc:
+            return frame_type, payload
+
+
+def wait_for(port, frame_type, command=None):
+    """Skips telemetry and other frames until expected one arrives."""
+    while True:
+        frame = read_frame(port)
+        if frame is None:
+            sys.exit("no reply")
+        received_type, payload = frame
+        if received_type == FRAME_ACK and command is not None and payload[0] == command:
+            return received_type, payload
+        if received_type == frame_type:
+            return received_type, payload
+
+
+def run_command(port, command, payload=b""):
+    port.write(encode(command, payload))
+    _, reply = wait_for(port, FRAME_ACK, command)
+    status = STATUSES.get(reply[1], reply[1])
+    print(status)
+    return reply[1] == 0
+
+
+def read_data(port, command, frame_type, payload=b""):
+    port.write(encode(command, payload))
+    received_type, payload = wait_for(port, frame_type, command)
+    if received_type == FRAME_ACK:
+        sys.exit(STATUSES.get(payload[1], payload[1]))
+    return payload
+
+
+def print_config(payload):
+    um_per_hole, speed, acceleration, approach, backlash, steps_per_hole, templates = \
+        struct.unpack("<iHHHHIB", payload)
+    print("um per hole:     %d" % um_per_hole)
+    print("speed:           %d steps/s" % speed)
+    print("acceleration:    %d steps/s^2" % acceleration)
+    print("approach speed:  %d steps/s" % approach)
+    print("backlash:        %d steps" % backlash)
+    print("steps per hole:  %.2f" % (steps_per_hole / 256))
+    print("templates:       %d" % templates)
+
+
+def print_profile(payload):
+    print("%-8s %8s %8s %8s %8s" % ("", "min us", "avg us", "max us", "overruns"))
+    for index, name in enumerate(PROFILE_COUNTERS):
+        minimal, average, maximal, overruns = struct.unpack_from("<HHHH", payload, index * 8)
+        if minimal == 0xFFFF and maximal == 0:
+            print("%-8s %8s" % (name, "-"))
+            continue
+        print("%-8s %8d %8d %8d %8d" % (name, minimal, average, maximal, overruns))
+
+
+def print_tasks(payload):
+    print("%-10s %8s %8s %8s" % ("", "bound ms", "max us", "overruns"))
+    for index, name in enumerate(TASKS):
+        bound, latency, overruns = struct.unpack_from("<HHH", payload, index * 6)
+        print("%-10s %8d %8d %8d" % (name, bound, latency, overruns))
+
+
+def read_display(port):
+    """Returns window id, page checksums (None for pages not on display) and render cost."""
+    payload = read_data(port, CMD_READ_DISPLAY, FRAME_DISPLAY)
+    window, valid_pages = struct.unpack_from("<BB", payload)
+    checksums = struct.unpack_from("<%dH" % DISPLAY_PAGES, payload, 2)
+    checksums = ["%04x" % checksum if valid_pages & (1 << page) else None
+                 for page, checksum in enumerate(checksums)]
+    cost = struct.unpack_from("<HBBH", payload, 2 + 2 * DISPLAY_PAGES)
+    return window, checksums, cost
+
+
+def display(port, name, save_file, check_file):
+    """Prints frame on display and cost of its rendering.
+
+    Page checksums identify the frame, so frame of known state can be saved
+    as golden one and compared after firmware changes, no display needed.
+    """
+    window, checksums, cost = read_display(port)
+    pixel_writes, rendered_pages, sent_pages, sent_bytes = cost
+    name = name or "window %d" % window
+    print("%s: %s" % (name, " ".join(checksum or "----" for checksum in checksums)))
+    print("last frame: %d pixel writes, %d/%d pages sent, %d bytes" % (
+        pixel_writes, sent_pages, rendered_pages, sent_bytes))
+
+    if save_file is not None:
+        golden = {}
+        if os.path.exists(save_file):
+            with open(save_file) as file:
+                golden = json.load(file)
+        golden[name] = checksums
+        with open(save_file, "w") as file:
+            json.dump(golden, file, indent=2, sort_keys=True)
+        return True
+
+    if check_file is not None:
+        with open(check_file) as file:
+            expected = json.load(file).get(name)
+        if expected is None:
+            print("no golden frame for %s" % name)
+            return False
+        changed = [page for page in range(DISPLAY_PAGES) if checksums[page] != expected[page]]
+        print("same" if not changed else "changed pages: %s" % " ".join(map(str, changed)))
+        return not changed
+
+    return True
+
+
+def print_homing(payload):
+    state, runs, time, deviation, spread = struct.unpack("<BBIii", payload)
+    print("state %s, %d runs" % (HOMING_STATES[state], runs))
+    if runs > 0:
+        print("last homing %.1f s, old zero %.2f mm above reference" % (time / 1000, deviation / 1000))
+    if runs > 1:
+        print("repeatability %.2f mm" % (spread / 1000))
+
+
+def print_tuning(payload):
+    state, speed, acceleration, used_speed, used_acceleration, slips, load = struct.unpack("<BHHHHHB", payload)
+    print("state %s" % TUNING_STATES[state])
+    if state in (1, 2):
+        print("testing %d steps/s, %d steps/s^2" % (speed, acceleration))
+    print("in use %d steps/s, %d steps/s^2" % (used_speed, used_acceleration))
+    print("%d slips, peak load %d %% of steps per hole" % (slips, load))
+
+
+def print_templates(port):
+    amount = struct.unpack_from("<iHHHHIB", read_data(port, CMD_READ_CONFIG, FRAME_CONFIG))[6]
+    for index in range(amount):
+        payload = read_data(port, CMD_READ_TEMPLATE, FRAME_TEMPLATE, struct.pack("<B", index))
+        _, status, height = struct.unpack_from("<BBi", payload)
+        name = payload[6:].decode("ascii", "replace")
+        print("%3d  %-11s %8.2f mm%s" % (index, name, height / 1000,
+                                        "" if status == 0 else "  (damaged)"))
+
+
+def watch(port):
+    while True:
+        frame = read_frame(port)
+        if frame is not None and frame[0] == FRAME_KEYBOARD:
+            value, is_mapped = struct.unpack("<hB", frame[1])
+            print("keyboard %s %d" % ("signal" if is_mapped else "adc", value))
+            continue
+        if frame is None or frame[0] != FRAME_TELEMETRY:
+            continue
+        position, holes, target, flags, window, axis = struct.unpack("<ihiBBB", frame[1])
+        print("position %8.2f mm  holes %5d  target %8.2f mm  %s%s%s%s%s%s window %d  axis %s" % (
+            position / 1000, holes, target / 1000,
+            "R" if flags & 0x01 else "-",
+            "M" if flags & 0x02 else "-",
+            "C" if flags & 0x04 else "-",
+            "J" if flags & 0x08 else "-",
+            "H" if flags & 0x10 else "-",
+            "T" if flags & 0x20 else "-",
+            window,
+            "all" if axis == AXIS_ALL else axis + 1))
+
+
+class FakeBoard(threading.Thread):
+    """Model of the board side of the protocol on master end of a pseudo terminal.
+
+    Receiver is the state machine of SerialProtocol::receive, commands
+    are checked and answered as handleSerialCommands does, telemetry is
+    sent every TELEMETRY_PERIOD. Moves run at constant speed, homing and
+    autotune end at once, job is empty as on a new board.
+    """
+
+    WAIT_START, WAIT_LENGTH, WAIT_TYPE, WAIT_PAYLOAD, WAIT_CRC = range(5)
+    UM_PER_HOLE = 144
+    SPEED = 5000  # um/s
+    AXES = 1
+    TEMPLATE_SLOTS = 30
+    W_SEMI_AUTO, W_TEMPLATE, W_HOMING, W_TUNING = 6, 8, 19, 21
+
+    def __init__(self, master):
+        super().__init__(daemon=True)
+        self.master = master
+        self.state = self.WAIT_START
+        self.length = 0
+        self.frame_type = 0
+        self.payload = bytearray()
+        self.position = 0
+        self.target = 0
+        self.window = 0
+        self.axis = 0
+        self.homing_runs = 0
+        self.is_tuned = False
+        self.templates = [(0, b"zero")]
+
+    def run(self):
+        deadline = time.monotonic()
+        moved = deadline
+        while True:
+            ready, _, _ = select.select([self.master], [], [], max(0, deadline - time.monotonic()))
+            if ready:
+                try:
+                    data = os.read(self.master, 256)
+                except OSError:
+                    return
+                for value in data:
+                    self.receive(value)
+            now = time.monotonic()
+            self.move(now - moved)
+            moved = now
+            if now >= deadline:
+                self.send_telemetry()
+                deadline = now + TELEMETRY_PERIOD
+
+    def receive(self, value):
+        if self.state == self.WAIT_START:
+            if value == START:
+                self.state = self.WAIT_LENGTH
+        elif self.state == self.WAIT_LENGTH:
+            self.length = value
+            self.state = self.WAIT_TYPE if value <= MAX_PAYLOAD else self.WAIT_START
+        elif self.state == self.WAIT_TYPE:
+            self.frame_type = value
+            self.payload = bytearray()
+            self.state = self.WAIT_PAYLOAD if self.length > 0 else self.WAIT_CRC
+        elif self.state == self.WAIT_PAYLOAD:
+            self.payload.append(value)
+            if len(self.payload) >= self.length:
+                self.state = self.WAIT_CRC
+        else:
+            self.state = self.WAIT_START
+            if crc8(bytes([self.length, self.frame_type]) + self.payload) == value:
+                self.handle(self.frame_type, bytes(self.payload))
+
+    def send(self, frame_type, payload=b""):
+        os.write(self.master, encode(frame_type, payload))
+
+    def is_moving(self):
+        return self.position != self.target
+
+    def move(self, seconds):
+        step = round(self.SPEED * seconds)
+        if self.target > self.position:
+            self.position = min(self.target, self.position + step)
+        else:
+            self.position = max(self.target, self.position - step)
+
+    def send_telemetry(self):
+        flags = 0x05 if self.is_moving() else 0
+        self.send(FRAME_TELEMETRY, struct.pack("<ihiBBB", self.position, self.position // self.UM_PER_HOLE,
+                                               self.target, flags, self.window, self.axis))
+
+    def handle(self, command, payload):
+        status = STATUS_OK
+        busy = self.is_moving()
+        if command == CMD_GO_TO:
+            if len(payload) != 4 or not 0 <= struct.unpack("<i", payload)[0] <= MAX_HEIGHT:
+                status = STATUS_BAD_ARGUMENT
+            else:
+                self.window = self.W_SEMI_AUTO
+                self.target = struct.unpack("<i", payload)[0]
+        elif command == CMD_RUN_TEMPLATE:
+            if len(payload) != 1 or payload[0] >= len(self.templates):
+                status = STATUS_BAD_ARGUMENT
+            elif busy:
+                status = STATUS_BUSY
+            else:
+                self.window = self.W_TEMPLATE
+                self.target = self.templates[payload[0]][0]
+        elif command == CMD_STOP:
+            self.target = self.position
+        elif command == CMD_RUN_JOB:
+            status = STATUS_BUSY if busy else STATUS_BAD_ARGUMENT
+        elif command == CMD_HOME:
+            if busy:
+                status = STATUS_BUSY
+            else:
+                self.window = self.W_HOMING
+                self.position = self.target = 0
+                self.homing_runs = min(self.homing_runs + 1, 255)
+        elif command == CMD_READ_HOMING:
+            self.send(FRAME_HOMING, struct.pack("<BBIii", 4 if self.homing_runs else 0, self.homing_runs,
+                                                1000 if self.homing_runs else 0, 0, 0))
+            return
+        elif command == CMD_TUNE:
+            if busy:
+                status = STATUS_BUSY
+            else:
+                self.window = self.W_TUNING
+                self.is_tuned = True
+        elif command == CMD_READ_TUNING:
+            self.send(FRAME_TUNING, struct.pack("<BHHHHHB", 3 if self.is_tuned else 0, 0, 0, 200, 50, 0, 0))
+            return
+        elif command == CMD_SET_ZERO:
+            if busy:
+                status = STATUS_BUSY
+            else:
+                self.position = self.target = 0
+        elif command == CMD_SELECT_AXIS:
+            if len(payload) != 1 or (payload[0] >= self.AXES and payload[0] != AXIS_ALL):
+                status = STATUS_BAD_ARGUMENT
+            elif busy:
+                status = STATUS_BUSY
+            else:
+                self.axis = payload[0]
+        elif command == CMD_READ_CONFIG:
+            self.send(FRAME_CONFIG, struct.pack("<iHHHHIB", self.UM_PER_HOLE, 200, 50, 40, 0, 100 * 256,
+                                                len(self.templates)))
+            return
+        elif command == CMD_READ_TEMPLATE:
+            if len(payload) != 1 or payload[0] >= len(self.templates):
+                status = STATUS_BAD_ARGUMENT
+            else:
+                height, name = self.templates[payload[0]]
+                self.send(FRAME_TEMPLATE, struct.pack("<BBi", payload[0], STATUS_OK, height) + name)
+                return
+        elif command == CMD_WRITE_TEMPLATE:
+            index = payload[0] if payload else 0
+            height = struct.unpack_from("<i", payload, 1)[0] if len(payload) >= 5 else -1
+            if (len(payload) < 6 or len(payload) - 5 > TEMPLATE_NAME_LENGTH or index > len(self.templates) or
+                    (index == len(self.templates) == self.TEMPLATE_SLOTS) or not 0 <= height <= MAX_HEIGHT):
+                status = STATUS_BAD_ARGUMENT
+            elif index == len(self.templates):
+                self.templates.append((height, payload[5:]))
+            else:
+                self.templates[index] = (height, payload[5:])
+        elif command == CMD_READ_TASKS:
+            self.send(FRAME_TASKS, struct.pack("<12H", 40, 0, 0, 20, 0, 0, 1000, 0, 0, 100, 0, 0))
+            return
+        elif command == CMD_READ_DISPLAY:
+            self.send(FRAME_DISPLAY, struct.pack("<BB8HHBBH", self.window, 0xFF, *([0] * DISPLAY_PAGES), 0, 8, 0, 0))
+            return
+        elif command == CMD_READ_PROFILE:
+            self.send(FRAME_PROFILE, struct.pack("<16H", *([0xFFFF, 0, 0, 0] * len(PROFILE_COUNTERS))))
+            return
+        else:
+            status = STATUS_UNKNOWN_COMMAND
+        self.send(FRAME_ACK, bytes([command, status]))
+
+
+def open_fake_port():
+    """Starts FakeBoard on master end of new pseudo terminal, returns port of slave end."""
+    import pty
+    import tty
+
+    master, slave = pty.openpty()
+    tty.setraw(slave)
+    FakeBoard(master).start()
+    port = serial.Serial(os.ttyname(slave), BAUD_RATE, timeout=3)
+    # slave end stays open in this process, so master never reads end of file
+    port.fake_slave = slave
+    return port
+
+
+def main():
+    fake_parser = argparse.ArgumentParser(add_help=False)
+    fake_parser.add_argument("--fake", action="store_true", help="use model of the board instead of port")
+    is_fake = fake_parser.parse_known_args()[0].fake
+    parser = argparse.ArgumentParser(description="magenta printer helper control", parents=[fake_parser])
+    if not is_fake:
+        parser.add_argument("port", help="serial port, e.g. /dev/ttyUSB0 or COM3")
+    commands = parser.add_subparsers(dest="command", required=True)
+    goto = commands.add_parser("goto", help="move to height, mm")
+    goto.add_argument("millimetres", type=float)
+    template = commands.add_parser("template", help="run template by index")
+    template.add_argument("index", type=int)
+    set_template = commands.add_parser("set-template",
+                                       help="change template, index equal to amount adds new one")
+    set_template.add_argument("index", type=int)
+    set_template.add_argument("millimetres", type=float)
+    set_template.add_argument("name")
+    commands.add_parser("job", help="run job (print cycle)")
+    commands.add_parser("stop", help="stop movement and job")
+    commands.add_parser("zero", help="set current position as zero")
+    commands.add_parser("home", help="find zero automatically")
+    commands.add_parser("homing", help="print result of the last homing")
+    commands.add_parser("tune", help="find the highest safe speed and acceleration")
+    commands.add_parser("tuning", help="print autotune state and slips")
+    axis = commands.add_parser("axis", help="select axis other commands work with")
+    axis.add_argument("number", help="axis number from 1, or all")
+    commands.add_parser("config", help="print board configuration")
+    commands.add_parser("profile", help="print profiling counters")
+    commands.add_parser("tasks", help="print latency of loop tasks")
+    commands.add_parser("templates", help="print templates")
+    display_parser = commands.add_parser("display", help="print frame checksums and render cost")
+    display_parser.add_argument("--name", help="name of frame in golden file, window id by default")
+    golden = display_parser.add_mutually_exclusive_group()
+    golden.add_argument("--save", metavar="FILE", help="save frame as golden one")
+    golden.add_argument("--check", metavar="FILE", help="compare frame with golden one")
+    commands.add_parser("watch", help="print telemetry until Ctrl+C")
+    arguments = parser.parse_args()
+
+    # opening the port resets the board, first frames come after bootloader
+    port = open_fake_port() if is_fake else serial.Serial(arguments.port, BAUD_RATE, timeout=3)
+    with port:
+        if arguments.command == "goto":
+            ok = run_command(port, CMD_GO_TO, struct.pack("<i", round(arguments.millimetres * 1000)))
+        elif arguments.command == "template":
+            ok = run_command(port, CMD_RUN_TEMPLATE, struct.pack("<B", arguments.index))
+        elif arguments.command == "set-template":
+            name = arguments.name.encode("ascii")[:TEMPLATE_NAME_LENGTH]
+            ok = run_command(port, CMD_WRITE_TEMPLATE,
+                             struct.pack("<Bi", arguments.index, round(arguments.millimetres * 1000)) + name)
+        elif arguments.command == "job":
+            ok = run_command(port, CMD_RUN_JOB)
+        elif arguments.command == "stop":
+            ok = run_command(port, CMD_STOP)
+        elif arguments.command == "zero":
+            ok = run_command(port, CMD_SET_ZERO)
+        elif arguments.command == "home":
+            ok = run_command(port, CMD_HOME)
+        elif arguments.command == "homing":
+            print_homing(read_data(port, CMD_READ_HOMING, FRAME_HOMING))
+            ok = True
+        elif arguments.command == "tune":
+            ok = run_command(port, CMD_TUNE)
+        elif arguments.command == "tuning":
+            print_tuning(read_data(port, CMD_READ_TUNING, FRAME_TUNING))
+            ok = True
+        elif arguments.command == "axis":
+            index = AXIS_ALL if arguments.number == "all" else int(arguments.number) - 1
+            ok = run_command(port, CMD_SELECT_AXIS, struct.pack("<B", index))
+        elif arguments.command == "config":
+            print_config(read_data(port, CMD_READ_CONFIG, FRAME_CONFIG))
+            ok = True
+        elif arguments.command == "profile":
+            print_profile(read_data(port, CMD_READ_PROFILE, FRAME_PROFILE))
+            ok = True
+        elif arguments.command == "tasks":
+            print_tasks(read_data(port, CMD_READ_TASKS, FRAME_TASKS))
+            ok = True
+        elif arguments.command == "templates":
+            print_templates(port)
+            ok = True
+        elif arguments.command == "display":
+            ok = display(port, arguments.name, arguments.save, arguments.check)
+        else:
+            try:
+                watch(port)
+            except KeyboardInterrupt:
+                pass
+            ok = True
+    sys.exit(0 if ok else 1)
+
+
+if __name__ == "__main__":
+    main()